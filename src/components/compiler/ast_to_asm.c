@@ -47,7 +47,7 @@ extern char *get_token_string(int token);
 #define WALK_LEAF(leaf) __ast_walker(leaf, output, frame, state, append_return_statement)
 
 // state enums
-enum context { st_ctx_load, st_ctx_store };
+enum context { st_ctx_load, st_ctx_store, st_ctx_method };
 enum type { st_type_id, st_type_const };
 enum side { st_side_left, st_side_right, st_none };
 enum call_state { st_call_pop, st_call_stay };
@@ -107,7 +107,7 @@ static void _load_or_store(int lineno, t_asm_opr *opr, t_dll *frame, t_state *st
 
 
 static void __ast_walker(t_ast_element *leaf, t_hash_table *output, t_dll *frame, t_state *state, int append_return_statement);
-static void _ast_to_frame(t_ast_element *leaf, t_hash_table *output, const char *name, int append_return_statement);
+static void _ast_to_frame(t_ast_element *leaf, t_hash_table *output, const char *name, t_ast_element *arguments, int append_return_statement);
 
 
 
@@ -150,6 +150,10 @@ static void __ast_walker(t_ast_element *leaf, t_hash_table *output, t_dll *frame
             if (ctx == st_ctx_load) {
                 opr2 = asm_create_opr(ASM_LINE_TYPE_OP_REALNUM, NULL, scope);
                 dll_append(frame, asm_create_codeline(leaf->lineno, VM_LOAD_ATTRIB, 2, opr1, opr2));
+            } else if (ctx == st_ctx_method) {
+                // Method that will be called directly, so it does not need to be bound to the object
+                opr2 = asm_create_opr(ASM_LINE_TYPE_OP_REALNUM, NULL, scope);
+                dll_append(frame, asm_create_codeline(leaf->lineno, VM_LOAD_METHOD, 2, opr1, opr2));
             } else {
                 if (scope == OBJECT_SCOPE_PARENT) {
                     // We cannot do: parent.foo = 1
@@ -465,7 +469,7 @@ static void __ast_walker(t_ast_element *leaf, t_hash_table *output, t_dll *frame
                 dll_append(frame, asm_create_codeline(leaf->lineno, VM_LOAD_CONST, 1, opr1));
 
                 // Walk the body inside a new frame!
-                _ast_to_frame(leaf->attribute.value, output, label1, append_return_statement);
+                _ast_to_frame(leaf->attribute.value, output, label1, leaf->attribute.arguments, append_return_statement);
             }
 
             if (leaf->attribute.attrib_type == ATTRIB_TYPE_CONSTANT) {
@@ -846,7 +850,14 @@ static void __ast_walker(t_ast_element *leaf, t_hash_table *output, t_dll *frame
                     stack_pop(state->call_state);
                     stack_pop(state->context);
 
-                    stack_push(state->context, st_ctx_load);
+                    // Calls to obj.method() load the object and the method separately, other calls load the callable
+                    int is_method_call = (leaf->opr.ops[0]->type == typeAstProperty);
+
+                    if (is_method_call) {
+                        stack_push(state->context, (void *)st_ctx_method);
+                    } else {
+                        stack_push(state->context, (void *)st_ctx_load);
+                    }
                     WALK_LEAF(leaf->opr.ops[0]);       // Load callable
                     stack_pop(state->context);
 
@@ -855,7 +866,7 @@ static void __ast_walker(t_ast_element *leaf, t_hash_table *output, t_dll *frame
                     int arg_count = leaf->opr.ops[1]->group.len;
                     opr1 = asm_create_opr(ASM_LINE_TYPE_OP_REALNUM, NULL, arg_count-1);
 
-                    dll_append(frame, asm_create_codeline(leaf->lineno, VM_CALL, 1, opr1));
+                    dll_append(frame, asm_create_codeline(leaf->lineno, is_method_call ? VM_CALL_METHOD : VM_CALL, 1, opr1));
 
                     // Pop the item after the call, but only when we need so.
                     enum call_state cs = (enum call_state)stack_peek(state->call_state);
@@ -966,6 +977,8 @@ static void __ast_walker(t_ast_element *leaf, t_hash_table *output, t_dll *frame
                             case st_ctx_store :
                                 dll_append(frame, asm_create_codeline(leaf->lineno, VM_STORE_SUBSCRIPT, 1, opr1));
                                 break;
+                            default :
+                                break;
                         }
 
 
@@ -1497,9 +1510,58 @@ void _ast_state_fini(t_state *state) {
 }
 
 /**
- * Initialize a new frame and walk the leaf into this frame
+ * Converts the identifier loads and stores of all method locals into slot based loads and stores. Method locals are
+ * "self", the method arguments and every identifier that is stored inside the method. The actual slot number is the
+ * offset of the identifier in the identifier table, which is assigned by the assembler.
+ */
+static void _assign_local_slots(t_dll *frame, t_ast_element *arguments) {
+    t_hash_table *locals = ht_create();
+    t_dll_element *e;
+
+    ht_add_str(locals, "self", (void *)1);
+
+    // Add method arguments
+    if (arguments && arguments->type == typeAstOpr && arguments->opr.oper == T_ARGUMENT_LIST) {
+        for (int i=0; i!=arguments->opr.nops; i++) {
+            t_ast_element *arg = arguments->opr.ops[i];
+            char *name = arg->opr.ops[1]->string.value;
+            if (! ht_exists_str(locals, name)) {
+                ht_add_str(locals, name, (void *)1);
+            }
+        }
+    }
+
+    // Add all identifiers that are stored inside this frame
+    e = DLL_HEAD(frame);
+    while (e) {
+        t_asm_line *line = (t_asm_line *)e->data;
+        if (line->type == ASM_LINE_TYPE_CODE && line->opcode == VM_STORE_ID && ! ht_exists_str(locals, line->opr[0]->data.s)) {
+            ht_add_str(locals, line->opr[0]->data.s, (void *)1);
+        }
+        e = DLL_NEXT(e);
+    }
+
+    // Convert loads and stores of locals
+    e = DLL_HEAD(frame);
+    while (e) {
+        t_asm_line *line = (t_asm_line *)e->data;
+        if (line->type == ASM_LINE_TYPE_CODE && (line->opcode == VM_LOAD_ID || line->opcode == VM_STORE_ID)) {
+            if (ht_exists_str(locals, line->opr[0]->data.s)) {
+                line->opcode = (line->opcode == VM_LOAD_ID) ? VM_LOAD_FAST : VM_STORE_FAST;
+            }
+        }
+        e = DLL_NEXT(e);
+    }
+
+    ht_destroy(locals);
+}
+
+
+/**
+ * Initialize a new frame and walk the leaf into this frame. Arguments are the method arguments, or NULL for the
+ * main frame.
  */
-static void _ast_to_frame(t_ast_element *leaf, t_hash_table *output, const char *name, int append_return_statement) {
+static void _ast_to_frame(t_ast_element *leaf, t_hash_table *output, const char *name, t_ast_element *arguments, int append_return_statement) {
     // Initialize state structure
     t_state *state = _ast_state_init();
 
@@ -1523,6 +1585,11 @@ static void _ast_to_frame(t_ast_element *leaf, t_hash_table *output, const char
         dll_append(frame, asm_create_codeline(0, VM_RETURN, 0));
     }
 
+    // Locals inside methods are accessed through slots instead of by name
+    if (strcmp(name, "main") != 0) {
+        _assign_local_slots(frame, arguments);
+    }
+
     // Clean up state structure
     _ast_state_fini(state);
 }
@@ -1534,7 +1601,7 @@ static void _ast_to_frame(t_ast_element *leaf, t_hash_table *output, const char
 t_hash_table *ast_to_asm(t_ast_element *ast, int append_return_statement) {
     t_hash_table *output = ht_create();
 
-    _ast_to_frame(ast, output, "main", append_return_statement);
+    _ast_to_frame(ast, output, "main", NULL, append_return_statement);
 
     return output;
 }
@@ -33,6 +33,7 @@
 #include "general/output.h"
 #include "compiler/bytecode.h"
 #include "general/smm.h"
+#include "general/intern.h"
 #include "general/config.h"
 #include "general/hashtable.h"
 #include "compiler/output/asm.h"
@@ -44,6 +45,8 @@
 static void _free_constant(t_bytecode_constant *c) {
      switch (c->type) {
          case BYTECODE_CONST_STRING :
+            // String constants are interned
+            break;
          case BYTECODE_CONST_REGEX :
             smm_free(c->data.s);
             break;
@@ -77,8 +80,7 @@ static void _new_constant_string(t_bytecode *bc, char *s, int len) {
     t_bytecode_constant *c = (t_bytecode_constant *)smm_malloc(sizeof(t_bytecode_constant));
     c->type = BYTECODE_CONST_STRING;
     c->len = len;
-    c->data.s = smm_malloc(len);
-    memcpy(c->data.s, s, len);
+    c->data.s = string_intern_len(s, len);
 
     _add_constant(bc, c);
 }
@@ -133,7 +135,7 @@ static void _new_name(t_bytecode *bc, char *var) {
     // Setup identifier
     t_bytecode_identifier *c = smm_malloc(sizeof(t_bytecode_identifier));
     c->len = strlen(var);
-    c->s = string_strdup0(var);
+    c->s = string_intern(var);
 
     // Add identifier
     bc->identifiers = smm_realloc(bc->identifiers, sizeof(t_bytecode_identifier *) * (bc->identifiers_len + 1));
@@ -319,8 +321,7 @@ void bytecode_free(t_bytecode *bc) {
     smm_free(bc->constants);
 
     for (int i=0; i!=bc->identifiers_len; i++) {
-        t_bytecode_identifier *id = bc->identifiers[i];
-        smm_free(id->s);
+        // Identifier names are interned, so only the identifier itself is freed
         smm_free(bc->identifiers[i]);
     }
     smm_free(bc->identifiers);
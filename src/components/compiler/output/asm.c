@@ -33,6 +33,8 @@
 #include "general/smm.h"
 #include "general/dll.h"
 #include "vm/vm_opcodes.h"
+#include "vm/stackframe.h"
+#include "objects/attrib.h"
 #include "debug.h"
 
 /**
@@ -45,12 +47,335 @@ struct _backpatch {
     char *label;
 };
 
+/**
+ * Any frame that needs a deeper stack than this has an unbalanced stack somewhere in a loop.
+ */
+#define ASM_MAX_STACK_SIZE      0xFFFF
+
+/**
+ * Exception block as set up by SETUP_EXCEPT. Needed to follow the stack through finally blocks.
+ */
+struct _stack_exception_block {
+    int setup_offset;               // Offset of the SETUP_EXCEPT opcode
+    int finally_offset;             // Start of the finally block
+    int end_finally_offset;         // Offset of the END_FINALLY opcode
+    int depth;                      // Stack depth before the block was set up
+};
+
+struct _stack_state {
+    t_asm_frame *frame;
+
+    int *depth;                     // Maximum depth found at the start of each opcode (-1 when not reached yet)
+    char *queued;                   // 1 when the offset is on the worklist
+    int *worklist;                  // Offsets that need to be (re)visited
+    int worklist_len;
+
+    struct _stack_exception_block *blocks;
+    int block_cnt;
+
+    int max_depth;
+};
+
+
+/**
+ * Marks the opcode at offset as reachable with the given stack depth. The opcode only has to be (re)visited when
+ * this depth is larger than the depth we have seen before at this offset.
+ */
+static void _stack_visit(struct _stack_state *state, int offset, int depth) {
+    if (offset < 0 || offset >= state->frame->code_len) {
+        fatal_error(1, "Stack calculation: jump to offset %d is outside the code\n", offset);   /* LCOV_EXCL_LINE */
+    }
+    if (depth < 0) {
+        fatal_error(1, "Stack calculation: stack underflow at offset %d\n", offset);   /* LCOV_EXCL_LINE */
+    }
+    if (depth > ASM_MAX_STACK_SIZE) {
+        fatal_error(1, "Stack calculation: stack is not balanced at offset %d\n", offset);   /* LCOV_EXCL_LINE */
+    }
+
+    if (depth > state->max_depth) state->max_depth = depth;
+    if (depth <= state->depth[offset]) return;
+
+    state->depth[offset] = depth;
+    if (! state->queued[offset]) {
+        state->queued[offset] = 1;
+        state->worklist[state->worklist_len++] = offset;
+    }
+}
+
+
+/**
+ * Returns the numerical constant loaded by the LOAD_CONST at the given offset.
+ */
+static long _stack_numerical_constant(t_asm_frame *frame, int offset) {
+    if (offset < 0 || (unsigned char)frame->code[offset] != VM_LOAD_CONST) {
+        fatal_error(1, "Stack calculation: expected a LOAD_CONST at offset %d\n", offset);   /* LCOV_EXCL_LINE */
+    }
+
+    int idx = *(uint16_t *)(frame->code + offset + 1);
+    t_dll_element *e = dll_seek_offset(frame->constants, idx);
+    t_asm_constant *c = e ? (t_asm_constant *)e->data : NULL;
+    if (! c || c->type != const_long) {
+        fatal_error(1, "Stack calculation: expected a numerical constant at offset %d\n", offset);   /* LCOV_EXCL_LINE */
+    }
+
+    return c->data.l;
+}
+
+
+/**
+ * Returns the innermost exception block that is set up around the given offset, or NULL when there is none.
+ */
+static struct _stack_exception_block *_stack_find_exception_block(struct _stack_state *state, int offset) {
+    struct _stack_exception_block *found = NULL;
+
+    for (int i=0; i!=state->block_cnt; i++) {
+        struct _stack_exception_block *block = &state->blocks[i];
+        if (offset <= block->setup_offset || offset > block->end_finally_offset) continue;
+
+        if (! found || block->setup_offset > found->setup_offset) found = block;
+    }
+
+    return found;
+}
+
+
 /**
  * Calculate the maximum stack size needed for this frame (run all available paths)
+ *
+ * Every opcode is visited with the deepest stack that can reach it, and the stack effect of the opcode is passed on
+ * to all its successors. Since the stack depth at an offset only increases, this will end as long as the stack
+ * is balanced.
  */
 static int _calculate_maximum_stack_size(t_asm_frame *frame) {
-    // @TODO: Fixed now, must be calculated!
-    return 42;
+    struct _stack_state state;
+    struct _stack_exception_block *block;
+    int ip, next_ip, depth, oparg1, oparg2, oparg3;
+    unsigned char opcode;
+
+    state.frame = frame;
+    state.depth = smm_malloc(frame->code_len * sizeof(int));
+    state.queued = smm_malloc(frame->code_len * sizeof(char));
+    state.worklist = smm_malloc(frame->code_len * sizeof(int));
+    state.worklist_len = 0;
+    state.blocks = NULL;
+    state.block_cnt = 0;
+    state.max_depth = 0;
+
+    for (int i=0; i!=frame->code_len; i++) {
+        state.depth[i] = -1;
+        state.queued[i] = 0;
+    }
+
+    if (frame->code_len > 0) {
+        _stack_visit(&state, 0, 0);
+    }
+
+    while (state.worklist_len > 0) {
+        ip = state.worklist[--state.worklist_len];
+        state.queued[ip] = 0;
+        depth = state.depth[ip];
+
+        // Decode opcode and operands
+        opcode = (unsigned char)frame->code[ip];
+        next_ip = ip + 1;
+        oparg1 = oparg2 = oparg3 = 0;
+        if ((opcode & 0x80) == 0x80) { oparg1 = *(uint16_t *)(frame->code + next_ip); next_ip += 2; }
+        if ((opcode & 0xC0) == 0xC0) { oparg2 = *(uint16_t *)(frame->code + next_ip); next_ip += 2; }
+        if ((opcode & 0xE0) == 0xE0) { oparg3 = *(uint16_t *)(frame->code + next_ip); next_ip += 2; }
+        if (next_ip > frame->code_len) {
+            fatal_error(1, "Stack calculation: truncated opcode at offset %d\n", ip);   /* LCOV_EXCL_LINE */
+        }
+
+        switch (opcode) {
+            // Opcodes that end the current path
+            case VM_STOP :
+            case VM_BREAK_LOOP :
+            case VM_BREAKELSE_LOOP :
+            case VM_THROW :
+                break;
+
+            // Break and continue targets are taken care of by the loop block
+            case VM_CONTINUE_LOOP :
+                _stack_visit(&state, oparg1, depth);
+                break;
+
+            case VM_RETURN :
+                if (depth < 1) {
+                    fatal_error(1, "Stack calculation: stack underflow at offset %d\n", ip);   /* LCOV_EXCL_LINE */
+                }
+
+                // A return inside an exception block pushes the return value and reason, and continues with the
+                // finally block (or the end of it).
+                block = _stack_find_exception_block(&state, ip);
+                if (block && next_ip <= block->finally_offset) {
+                    _stack_visit(&state, block->finally_offset, depth + 1);
+                } else if (block && next_ip <= block->end_finally_offset) {
+                    _stack_visit(&state, block->end_finally_offset, depth + 1);
+                }
+                break;
+
+            case VM_JUMP_FORWARD :
+                _stack_visit(&state, next_ip + oparg1, depth);
+                break;
+            case VM_JUMP_ABSOLUTE :
+                _stack_visit(&state, oparg1, depth);
+                break;
+            case VM_JUMP_IF_TRUE :
+            case VM_JUMP_IF_FALSE :
+            case VM_JUMP_IF_FIRST_TRUE :
+            case VM_JUMP_IF_FIRST_FALSE :
+                _stack_visit(&state, next_ip + oparg1, depth);
+                _stack_visit(&state, next_ip, depth);
+                break;
+
+            // A break will unwind the stack to the depth at which the loop was set up
+            case VM_SETUP_LOOP :
+                _stack_visit(&state, next_ip + oparg1, depth);
+                _stack_visit(&state, next_ip, depth);
+                break;
+            case VM_SETUP_ELSE_LOOP :
+                _stack_visit(&state, next_ip + oparg1, depth);
+                _stack_visit(&state, next_ip + oparg2, depth);
+                _stack_visit(&state, next_ip, depth);
+                break;
+
+            case VM_SETUP_EXCEPT :
+                // Record the block only once, even when we revisit with a larger depth
+                block = NULL;
+                for (int i=0; i!=state.block_cnt; i++) {
+                    if (state.blocks[i].setup_offset == ip) block = &state.blocks[i];
+                }
+                if (! block) {
+                    state.blocks = smm_realloc(state.blocks, (state.block_cnt + 1) * sizeof(struct _stack_exception_block));
+                    block = &state.blocks[state.block_cnt++];
+                    block->setup_offset = ip;
+                    block->finally_offset = next_ip + oparg2;
+                    block->end_finally_offset = next_ip + oparg3;
+                    block->depth = 0;
+                }
+                if (depth > block->depth) block->depth = depth;
+
+                // The catch block is called with the REASON_FINALLY and the exception on the stack
+                _stack_visit(&state, next_ip + oparg1, depth + 2);
+                _stack_visit(&state, next_ip, depth + 1);
+                break;
+
+            // End finally unwinds the stack to the depth at which the exception block was set up
+            case VM_END_FINALLY :
+                block = NULL;
+                for (int i=0; i!=state.block_cnt; i++) {
+                    if (state.blocks[i].end_finally_offset == ip) block = &state.blocks[i];
+                }
+                if (! block) {
+                    fatal_error(1, "Stack calculation: END_FINALLY at offset %d without exception block\n", ip);   /* LCOV_EXCL_LINE */
+                }
+                _stack_visit(&state, next_ip, block->depth);
+                break;
+
+            // Opcodes without a stack effect
+            case VM_NOP :
+            case VM_ROT_TWO :
+            case VM_ROT_THREE :
+            case VM_ROT_FOUR :
+            case VM_POP_BLOCK :
+            case VM_ITER_RESET :
+            case VM_BUILD_TUPLE :
+            case VM_USE :
+            case VM_LOAD_ATTRIB :
+            case VM_LOAD_CONST_STORE_ID :
+            case VM_LOAD_CONST_STORE_FAST :
+                _stack_visit(&state, next_ip, depth);
+                break;
+
+            case VM_LOAD_CONST :
+            case VM_LOAD_ID :
+            case VM_LOAD_FAST :
+            case VM_DUP_TOP :
+            case VM_LOAD_METHOD :
+                _stack_visit(&state, next_ip, depth + 1);
+                break;
+
+            case VM_LOAD_FAST_LOAD_FAST :
+            case VM_LOAD_FAST_LOAD_CONST :
+            case VM_LOAD_CONST_LOAD_FAST :
+                _stack_visit(&state, next_ip, depth + 2);
+                break;
+
+            case VM_POP_TOP :
+            case VM_STORE_ID :
+            case VM_STORE_FAST :
+            case VM_STORE_FRAME_ID :
+            case VM_IMPORT :
+            case VM_STORE_SUBSCRIPT :
+            case VM_OPERATOR :
+            case VM_NUM_ADD :
+            case VM_NUM_SUB :
+            case VM_NUM_MUL :
+            case VM_COMPARE_OP :
+            case VM_NUM_EQ :
+            case VM_NUM_NE :
+            case VM_NUM_LT :
+            case VM_NUM_GT :
+            case VM_NUM_LE :
+            case VM_NUM_GE :
+            case VM_STR_EQ :
+            case VM_STR_NE :
+                _stack_visit(&state, next_ip, depth - 1);
+                break;
+
+            case VM_STORE_ATTRIB :
+                _stack_visit(&state, next_ip, depth - 2);
+                break;
+
+            case VM_DUP_TOPX :
+            case VM_ITER_FETCH :
+                _stack_visit(&state, next_ip, depth + oparg1);
+                break;
+
+            // Callable, varargs and arguments are replaced by the return value
+            case VM_CALL :
+                _stack_visit(&state, next_ip, depth - oparg1 - 1);
+                break;
+            case VM_CALL_METHOD :
+                _stack_visit(&state, next_ip, depth - oparg1 - 2);
+                break;
+
+            case VM_PACK_TUPLE :
+                _stack_visit(&state, next_ip, depth - oparg1 + 1);
+                break;
+            case VM_UNPACK_TUPLE :
+                _stack_visit(&state, next_ip, depth + oparg1 - 1);
+                break;
+
+            case VM_BUILD_DATASTRUCT :
+            case VM_LOAD_SUBSCRIPT :
+                _stack_visit(&state, next_ip, depth - oparg1);
+                break;
+
+            // Value, visibility and access, and for methods the flags and a typehint, name and value per argument
+            case VM_BUILD_ATTRIB :
+                _stack_visit(&state, next_ip, depth - 2 - (oparg1 == ATTRIB_TYPE_METHOD ? 1 + 3 * oparg2 : 0));
+                break;
+
+            // Flags, interface count, interfaces, parent, name and a name and value per attribute. The number of
+            // interfaces is loaded by the LOAD_CONST right before the flags.
+            case VM_BUILD_CLASS :
+            case VM_BUILD_INTERFACE :
+                _stack_visit(&state, next_ip, depth + 1 - 4 - 2 * oparg1 - _stack_numerical_constant(frame, ip - 6));
+                break;
+
+            default :
+                fatal_error(1, "Stack calculation: unknown stack effect for opcode 0x%02X at offset %d\n", opcode, ip);   /* LCOV_EXCL_LINE */
+        }
+    }
+
+    smm_free(state.depth);
+    smm_free(state.queued);
+    smm_free(state.worklist);
+    if (state.blocks) smm_free(state.blocks);
+
+    // Always have room for at least a single return value
+    return state.max_depth > 0 ? state.max_depth : 1;
 }
 
 
@@ -498,6 +823,294 @@ t_asm_line *asm_create_labelline(char *label) {
 
 
 
+/*
+ * Peephole optimiser. This works directly on the assembler lines of a frame, before any label is resolved, so lines
+ * can be removed or combined without keeping track of offsets. Labels are never removed or moved.
+ */
+
+int asm_optimize_level = ASM_OPTIMIZE_FULL;
+
+#define ASM_MAX_JUMP_CHAIN      16
+
+static int _is_code(t_dll_element *e, int opcode) {
+    return e && ((t_asm_line *)e->data)->type == ASM_LINE_TYPE_CODE && ((t_asm_line *)e->data)->opcode == opcode;
+}
+
+/**
+ * Removes a line from the frame, and returns the next line
+ */
+static t_dll_element *_opt_remove_line(t_dll *frame, t_dll_element *e) {
+    t_dll_element *next = DLL_NEXT(e);
+    _asm_free_line((t_asm_line *)e->data);
+    dll_remove(frame, e);
+    return next;
+}
+
+/**
+ * Returns 1 when the opcode never continues with the next line
+ */
+static int _opt_is_terminator(int opcode) {
+    switch (opcode) {
+        case VM_RETURN :
+        case VM_THROW :
+        case VM_BREAK_LOOP :
+        case VM_BREAKELSE_LOOP :
+        case VM_CONTINUE_LOOP :
+        case VM_JUMP_FORWARD :
+        case VM_JUMP_ABSOLUTE :
+            return 1;
+    }
+    return 0;
+}
+
+/**
+ * Returns the first code line after a label, or NULL when not found
+ */
+static t_dll_element *_opt_find_label_code(t_hash_table *labels, char *label) {
+    t_dll_element *e = ht_find_str(labels, label);
+    while (e && ((t_asm_line *)e->data)->type == ASM_LINE_TYPE_LABEL) {
+        e = DLL_NEXT(e);
+    }
+    return e;
+}
+
+/**
+ * Retargets jumps that land on an unconditional jump, to the final destination of the jump chain. Relative jumps can
+ * only move forward, so a JUMP_FORWARD ending up behind itself becomes a JUMP_ABSOLUTE, and conditional jumps are
+ * only threaded forward.
+ */
+static int _opt_thread_jumps(t_dll *frame) {
+    t_hash_table *labels = ht_create();         // key: label name => value: dll element of the label
+    t_hash_table *positions = ht_create();      // key: label name => value: position of the label inside the frame
+    int changed = 0;
+    long pos = 0;
+
+    t_dll_element *e = DLL_HEAD(frame);
+    while (e) {
+        t_asm_line *line = (t_asm_line *)e->data;
+        if (line->type == ASM_LINE_TYPE_LABEL) {
+            ht_add_str(labels, line->s, e);
+            ht_add_str(positions, line->s, (void *)pos);
+        }
+        pos++;
+        e = DLL_NEXT(e);
+    }
+
+    pos = 0;
+    e = DLL_HEAD(frame);
+    while (e) {
+        t_asm_line *line = (t_asm_line *)e->data;
+        if (line->type == ASM_LINE_TYPE_CODE && (line->opcode == VM_JUMP_FORWARD || line->opcode == VM_JUMP_ABSOLUTE ||
+                                                 line->opcode == VM_JUMP_IF_TRUE || line->opcode == VM_JUMP_IF_FALSE)) {
+            char *target = line->opr[0]->data.s;
+
+            for (int i=0; i!=ASM_MAX_JUMP_CHAIN; i++) {
+                t_dll_element *dst = _opt_find_label_code(labels, target);
+                if (! dst || dst == e) break;
+
+                t_asm_line *dst_line = (t_asm_line *)dst->data;
+                if (dst_line->opcode != VM_JUMP_FORWARD && dst_line->opcode != VM_JUMP_ABSOLUTE) break;
+                if (strcmp(dst_line->opr[0]->data.s, target) == 0) break;
+                target = dst_line->opr[0]->data.s;
+            }
+
+            if (target != line->opr[0]->data.s) {
+                int forward = (long)ht_find_str(positions, target) > pos;
+
+                if (forward || line->opcode == VM_JUMP_ABSOLUTE || line->opcode == VM_JUMP_FORWARD) {
+                    if (! forward) line->opcode = VM_JUMP_ABSOLUTE;
+                    char *s = string_strdup0(target);
+                    smm_free(line->opr[0]->data.s);
+                    line->opr[0]->data.s = s;
+                    changed = 1;
+                }
+            }
+        }
+        pos++;
+        e = DLL_NEXT(e);
+    }
+
+    ht_destroy(labels);
+    ht_destroy(positions);
+    return changed;
+}
+
+/**
+ * Removes code that can never be reached: everything between a terminating opcode and the next label.
+ */
+static int _opt_remove_unreachable(t_dll *frame) {
+    int changed = 0;
+
+    t_dll_element *e = DLL_HEAD(frame);
+    while (e) {
+        t_asm_line *line = (t_asm_line *)e->data;
+        e = DLL_NEXT(e);
+
+        if (line->type != ASM_LINE_TYPE_CODE || ! _opt_is_terminator(line->opcode)) continue;
+
+        while (e && ((t_asm_line *)e->data)->type == ASM_LINE_TYPE_CODE) {
+            e = _opt_remove_line(frame, e);
+            changed = 1;
+        }
+    }
+
+    return changed;
+}
+
+/**
+ * Removes opcodes that do nothing: NOPs, unconditional jumps to the next line, and pushes that are popped right away.
+ */
+static int _opt_remove_noops(t_dll *frame) {
+    int changed = 0;
+
+    t_dll_element *e = DLL_HEAD(frame);
+    while (e) {
+        t_asm_line *line = (t_asm_line *)e->data;
+        t_dll_element *next = DLL_NEXT(e);
+
+        if (line->type != ASM_LINE_TYPE_CODE) {
+            e = next;
+            continue;
+        }
+
+        if (line->opcode == VM_NOP) {
+            e = _opt_remove_line(frame, e);
+            changed = 1;
+            continue;
+        }
+
+        // Jump to one of the labels directly following the jump
+        if (line->opcode == VM_JUMP_FORWARD || line->opcode == VM_JUMP_ABSOLUTE) {
+            t_dll_element *l = next;
+            while (l && ((t_asm_line *)l->data)->type == ASM_LINE_TYPE_LABEL) {
+                if (strcmp(((t_asm_line *)l->data)->s, line->opr[0]->data.s) == 0) break;
+                l = DLL_NEXT(l);
+            }
+            if (l && ((t_asm_line *)l->data)->type == ASM_LINE_TYPE_LABEL) {
+                e = _opt_remove_line(frame, e);
+                changed = 1;
+                continue;
+            }
+        }
+
+        // Pushes without side effects, directly followed by a pop
+        if ((line->opcode == VM_DUP_TOP || line->opcode == VM_LOAD_CONST) && _is_code(next, VM_POP_TOP)) {
+            _opt_remove_line(frame, next);
+            e = _opt_remove_line(frame, e);
+            changed = 1;
+            continue;
+        }
+
+        e = next;
+    }
+
+    return changed;
+}
+
+/**
+ * Replaces stores into local variables that are never loaded by a pop
+ */
+static int _opt_remove_dead_stores(t_dll *frame) {
+    t_hash_table *loaded = ht_create();
+    t_dll_element *e;
+    int changed = 0;
+
+    e = DLL_HEAD(frame);
+    while (e) {
+        t_asm_line *line = (t_asm_line *)e->data;
+        if (line->type == ASM_LINE_TYPE_CODE && line->opcode == VM_LOAD_FAST && ! ht_exists_str(loaded, line->opr[0]->data.s)) {
+            ht_add_str(loaded, line->opr[0]->data.s, (void *)1);
+        }
+        e = DLL_NEXT(e);
+    }
+
+    e = DLL_HEAD(frame);
+    while (e) {
+        t_asm_line *line = (t_asm_line *)e->data;
+        if (line->type == ASM_LINE_TYPE_CODE && line->opcode == VM_STORE_FAST && ! ht_exists_str(loaded, line->opr[0]->data.s)) {
+            _asm_free_opr(line->opr[0]);
+            line->opcode = VM_POP_TOP;
+            line->opr_count = 0;
+            changed = 1;
+        }
+        e = DLL_NEXT(e);
+    }
+
+    ht_destroy(loaded);
+    return changed;
+}
+
+/**
+ * Combines the most frequent pairs of opcodes into a single superinstruction
+ */
+static void _opt_superinstructions(t_dll *frame) {
+    static const int pairs[][3] = {
+        { VM_LOAD_CONST, VM_STORE_ID,    VM_LOAD_CONST_STORE_ID },
+        { VM_LOAD_CONST, VM_STORE_FAST,  VM_LOAD_CONST_STORE_FAST },
+        { VM_LOAD_FAST,  VM_LOAD_FAST,   VM_LOAD_FAST_LOAD_FAST },
+        { VM_LOAD_FAST,  VM_LOAD_CONST,  VM_LOAD_FAST_LOAD_CONST },
+        { VM_LOAD_CONST, VM_LOAD_FAST,   VM_LOAD_CONST_LOAD_FAST },
+    };
+
+    t_dll_element *e = DLL_HEAD(frame);
+    while (e) {
+        t_asm_line *line = (t_asm_line *)e->data;
+        t_dll_element *next = DLL_NEXT(e);
+
+        if (line->type != ASM_LINE_TYPE_CODE || ! next || ((t_asm_line *)next->data)->type != ASM_LINE_TYPE_CODE) {
+            e = next;
+            continue;
+        }
+
+        // Keep line numbers exact, and the LOAD_CONST that the stack calculation expects in front of a class build
+        t_asm_line *next_line = (t_asm_line *)next->data;
+        t_dll_element *after = DLL_NEXT(next);
+        if ((next_line->lineno != 0 && next_line->lineno != line->lineno) ||
+            _is_code(after, VM_BUILD_CLASS) || _is_code(after, VM_BUILD_INTERFACE) ||
+            (after && (_is_code(DLL_NEXT(after), VM_BUILD_CLASS) || _is_code(DLL_NEXT(after), VM_BUILD_INTERFACE)))) {
+            e = next;
+            continue;
+        }
+
+        for (int i=0; i!=sizeof(pairs) / sizeof(pairs[0]); i++) {
+            if (line->opcode != pairs[i][0] || next_line->opcode != pairs[i][1]) continue;
+
+            line->opcode = pairs[i][2];
+            line->opr = smm_realloc(line->opr, sizeof(t_asm_opr *) * 2);
+            line->opr[1] = next_line->opr[0];
+            line->opr_count = 2;
+            next_line->opr_count = 0;
+            next = _opt_remove_line(frame, next);
+            break;
+        }
+
+        e = next;
+    }
+}
+
+/**
+ * Runs the peephole optimiser on a frame
+ */
+static void _optimize_frame(t_dll *frame, int level) {
+    if (level < ASM_OPTIMIZE_BASIC) return;
+
+    _opt_thread_jumps(frame);
+
+    int changed;
+    do {
+        changed = _opt_remove_unreachable(frame);
+        changed |= _opt_remove_noops(frame);
+        if (level >= ASM_OPTIMIZE_FULL) {
+            changed |= _opt_remove_dead_stores(frame);
+        }
+    } while (changed);
+
+    if (level >= ASM_OPTIMIZE_FULL) {
+        _opt_superinstructions(frame);
+    }
+}
+
+
 /**
  *
  */
@@ -513,6 +1126,7 @@ t_bytecode *assembler(t_hash_table *asm_code, const char *filename) {
         t_dll *frame = ht_iter_value(&iter);
         char *key = ht_iter_key_str(&iter);
 
+        _optimize_frame(frame, asm_optimize_level);
         t_asm_frame *assembled_frame = assemble_frame(frame, strcmp(key, "main") == 0 ? 1 : 0);
         ht_add_str(assembled_frames, key, assembled_frame);
 
@@ -560,7 +1174,7 @@ static void _assembler_output_frame(t_dll *frame, FILE *f) {
                 fprintf(f, "          ");
             }
 
-            fprintf(f, "%5d %-20s", oprcnt, vm_code_names[vm_codes_offset[line->opcode]]);
+            fprintf(f, "%5d %-24s", oprcnt, vm_code_names[vm_codes_offset[line->opcode]]);
             oprcnt++;
 
             // Output additional operands
@@ -37,6 +37,7 @@
 #include "general/smm.h"
 #include "objects/objects.h"
 #include "general/base64.h"
+#include "vm/vm.h"
 #include "version.h"
 
 #define OPTION_MAX_CHILDREN     101
@@ -376,8 +377,24 @@ DBGP_CMD_DEF(context_get) {
     t_vm_stackframe *frame = di->frame;
 
     t_hash_table *ht;
+    t_hash_table *locals_ht = NULL;
     if (context_id == 0) {
-        ht = frame->local_identifiers->data.ht;
+        // Locals are stored both in slots and in the local identifiers
+        locals_ht = ht_create();
+
+        if (frame->local_identifiers) {
+            t_hash_iter local_iter;
+            ht_iter_init(&local_iter, frame->local_identifiers->data.ht);
+            while (ht_iter_valid(&local_iter)) {
+                ht_add_str(locals_ht, ht_iter_key_str(&local_iter), ht_iter_value(&local_iter));
+                ht_iter_next(&local_iter);
+            }
+        }
+        for (int i=0; i!=frame->codeframe->bytecode->identifiers_len; i++) {
+            if (frame->locals[i] == NULL) continue;
+            ht_replace_str(locals_ht, frame->codeframe->bytecode->identifiers[i]->s, vm_frame_get_local(frame, i));
+        }
+        ht = locals_ht;
     } else if (context_id == 1) {
         ht = frame->frame_identifiers->data.ht;
     } else if (context_id == 2) {
@@ -437,6 +454,8 @@ DBGP_CMD_DEF(context_get) {
         ht_iter_next(&iter);
     }
 
+    if (locals_ht) ht_destroy(locals_ht);
+
     return root_node;
 }
 
@@ -448,6 +467,9 @@ DBGP_CMD_DEF(detach) {
     di->state = DBGP_STATE_STOPPED;
     di->attached = 0;
 
+    // New frames don't need the debugger hooks anymore
+    vm_select_execute_loop();
+
     xmlNodePtr root_node = dbgp_xml_create_response(di);
     xmlSetProp(root_node, BAD_CAST "status", BAD_CAST dbgp_status_names[di->state]);
 
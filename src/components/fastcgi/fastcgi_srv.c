@@ -43,6 +43,7 @@
 #include "general/smm.h"
 #include "general/path_handling.h"
 #include "vm/vm.h"
+#include "gc/gc.h"
 #include "compiler/ast_to_asm.h"
 #include "compiler/output/asm.h"
 
@@ -181,6 +182,10 @@ static int fcgi_loop(void) {
         vm_execute(initial_frame);
 
         vm_stackframe_destroy(initial_frame);
+
+        // Objects of this request that only reference each other would otherwise stay around until the worker exits
+        gc_collect();
+
         bytecode_free(bc);
     }
 
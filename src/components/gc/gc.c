@@ -25,31 +25,368 @@
  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 #include <stdio.h>
+#include <time.h>
 #include "objects/object.h"
 #include "objects/objects.h"
 #include "gc/gc.h"
-#include "general/mutex.h"
+#include "general/config.h"
 #include "general/smm.h"
 #include "debug.h"
 #include "general/output.h"
 
-#define GC_OBJECT_QUEUE_SIZE        100;
+#define GC_OBJECT_QUEUE_SIZE        100
+
+#define GC_DEFAULT_THRESHOLD        10000   // Number of possible cycle roots before a collection is requested
+#define GC_DEFAULT_SLICE            1000    // Number of possible cycle roots handled by a single collection step
+
+// Cycle collector colors, stored in the lower bits of the gc_color header field
+#define GC_COLOR_BLACK              0       // In use (or not examined)
+#define GC_COLOR_GRAY               1       // Possible member of a cycle
+#define GC_COLOR_WHITE              2       // Member of a garbage cycle
+#define GC_COLOR_PURPLE             3       // Possible root of a cycle
+#define GC_COLOR_MASK               3
+#define GC_FLAG_BUFFERED            4       // Object is linked into the list of possible roots
+
+#define GC_COLOR(obj)               ((obj)->gc_color & GC_COLOR_MASK)
+#define GC_SET_COLOR(obj, color)    ((obj)->gc_color = ((obj)->gc_color & ~GC_COLOR_MASK) | (color))
+
+// Added to the reference count of garbage objects while they are freed, so releasing references between them can
+// never free them a second time.
+#define GC_GARBAGE_GUARD            (1 << 24)
 
 typedef struct _gc_queue {
-    t_mutex mutex;          // Mutex to guard the queue
     t_object **queue;       // Actual queue
     int index;              // Current first free item
     int size;               // Size of the queue
+    long hits;              // Number of objects recycled from the queue
+    long misses;            // Number of recycle requests while the queue was empty
 } t_gc_queue;
 
-t_gc_queue gc_queue[OBJECT_TYPE_LEN];
+// Growable array of objects, used as work stack and for gathering garbage
+typedef struct _gc_objects {
+    t_object **objects;
+    long len;
+    long size;
+} t_gc_objects;
+
+typedef struct _gc_stats {
+    long collections;       // Number of collection steps
+    long roots;             // Number of possible roots examined
+    long collected;         // Number of garbage objects freed
+    double total_pause;     // Time spent inside the collector (in ms)
+    double max_pause;       // Longest single collection step (in ms)
+} t_gc_stats;
+
+// Every thread has its own set of queues, so we don't need to lock them.
+static __thread t_gc_queue gc_queue[OBJECT_TYPE_LEN];
+
+// Doubly linked list of possible cycle roots, linked through the object headers
+static __thread t_object *gc_roots = NULL;
+static __thread long gc_roots_count = 0;
+
+static __thread long gc_threshold = GC_DEFAULT_THRESHOLD;
+static __thread long gc_slice = GC_DEFAULT_SLICE;
+static __thread t_gc_objects gc_stack;
+static __thread t_gc_objects gc_garbage;
+static __thread t_gc_stats gc_stats;
+static __thread int gc_collecting = 0;
+
+// Set when enough possible roots are buffered. The VM runs a collection step at its next safe point.
+__thread int gc_collect_requested = 0;
+
+// Default queue sizes. Only types that need nothing more than smm_free() to be destroyed can be recycled.
+static const int gc_queue_default_size[OBJECT_TYPE_LEN] = {
+    [objectTypeNumerical] = GC_OBJECT_QUEUE_SIZE,
+    [objectTypeRegex] = GC_OBJECT_QUEUE_SIZE,
+    [objectTypeString] = GC_OBJECT_QUEUE_SIZE,
+    [objectTypeHash] = GC_OBJECT_QUEUE_SIZE,
+    [objectTypeTuple] = GC_OBJECT_QUEUE_SIZE,
+    [objectTypeList] = GC_OBJECT_QUEUE_SIZE,
+};
+
+
+/*
+ * Cycle collection
+ *
+ * Reference counting alone never frees objects that reference each other. Every container object that loses a
+ * reference, but stays alive, is buffered as a possible root of such a cycle. A collection step takes a slice of these
+ * roots and does a trial deletion (Bacon & Rajan): references between the objects reachable from the roots are
+ * subtracted from their reference counts. Everything that ends up at 0 is only referenced from inside the subgraph
+ * and is garbage; everything else is restored.
+ *
+ * Only references that are counted may be visited by the traverse functions. References that are counted but not
+ * visited just keep objects alive.
+ */
+
+static void _gc_push(t_gc_objects *objects, t_object *obj) {
+    if (objects->len == objects->size) {
+        objects->size = objects->size ? objects->size * 2 : 256;
+        objects->objects = smm_realloc(objects->objects, sizeof(t_object *) * objects->size);
+    }
+    objects->objects[objects->len++] = obj;
+}
+
+static int _gc_is_tracked(t_object *obj) {
+    return obj && ! OBJECT_IS_TAGGED(obj) && GC_IS_CONTAINER(obj);
+}
+
+static void _gc_traverse(t_object *obj, void (*visit)(t_object *)) {
+    // User objects have the functions of the builtin class they extend, so traverse their own references as well
+    if (OBJECT_IS_USER(obj)) {
+        object_user_traverse(obj, visit);
+    }
+    if (obj->funcs && obj->funcs->traverse) {
+        obj->funcs->traverse(obj, visit);
+    }
+}
+
+
+static void _gc_visit_mark_gray(t_object *obj) {
+    if (! _gc_is_tracked(obj)) return;
+
+    obj->ref_count--;
+    if (GC_COLOR(obj) != GC_COLOR_GRAY) {
+        GC_SET_COLOR(obj, GC_COLOR_GRAY);
+        _gc_push(&gc_stack, obj);
+    }
+}
+
+/**
+ * Removes all internal references from the subgraph reachable from obj
+ */
+static void _gc_mark_gray(t_object *obj) {
+    if (GC_COLOR(obj) == GC_COLOR_GRAY) return;
+
+    GC_SET_COLOR(obj, GC_COLOR_GRAY);
+    _gc_push(&gc_stack, obj);
+    while (gc_stack.len) {
+        _gc_traverse(gc_stack.objects[--gc_stack.len], _gc_visit_mark_gray);
+    }
+}
+
+
+static void _gc_visit_scan_black(t_object *obj) {
+    if (! _gc_is_tracked(obj)) return;
+
+    obj->ref_count++;
+    if (GC_COLOR(obj) != GC_COLOR_BLACK) {
+        GC_SET_COLOR(obj, GC_COLOR_BLACK);
+        _gc_push(&gc_stack, obj);
+    }
+}
+
+/**
+ * Restores the references from obj, and everything reachable from it, as obj is still in use
+ */
+static void _gc_scan_black(t_object *obj) {
+    long base = gc_stack.len;
+
+    GC_SET_COLOR(obj, GC_COLOR_BLACK);
+    _gc_push(&gc_stack, obj);
+    while (gc_stack.len > base) {
+        _gc_traverse(gc_stack.objects[--gc_stack.len], _gc_visit_scan_black);
+    }
+}
+
+
+static void _gc_visit_scan(t_object *obj) {
+    if (! _gc_is_tracked(obj)) return;
+    _gc_push(&gc_stack, obj);
+}
+
+/**
+ * Colors the subgraph reachable from obj white (garbage) or black (externally referenced)
+ */
+static void _gc_scan(t_object *obj) {
+    _gc_push(&gc_stack, obj);
+    while (gc_stack.len) {
+        obj = gc_stack.objects[--gc_stack.len];
+        if (GC_COLOR(obj) != GC_COLOR_GRAY) continue;
+
+        if (obj->ref_count > 0) {
+            _gc_scan_black(obj);
+        } else {
+            GC_SET_COLOR(obj, GC_COLOR_WHITE);
+            _gc_traverse(obj, _gc_visit_scan);
+        }
+    }
+}
+
+
+static void _gc_visit_collect_white(t_object *obj) {
+    if (! _gc_is_tracked(obj)) return;
+
+    if (GC_COLOR(obj) == GC_COLOR_WHITE) {
+        GC_SET_COLOR(obj, GC_COLOR_BLACK);
+        _gc_push(&gc_stack, obj);
+        _gc_push(&gc_garbage, obj);
+    }
+}
+
+/**
+ * Gathers all white objects reachable from obj as garbage
+ */
+static void _gc_collect_white(t_object *obj) {
+    if (GC_COLOR(obj) != GC_COLOR_WHITE) return;
+
+    GC_SET_COLOR(obj, GC_COLOR_BLACK);
+    _gc_push(&gc_stack, obj);
+    _gc_push(&gc_garbage, obj);
+    while (gc_stack.len) {
+        _gc_traverse(gc_stack.objects[--gc_stack.len], _gc_visit_collect_white);
+    }
+}
+
+
+static void _gc_visit_restore(t_object *obj) {
+    if (! _gc_is_tracked(obj)) return;
+    obj->ref_count++;
+}
+
+/**
+ * Frees all gathered garbage
+ */
+static void _gc_free_garbage(void) {
+    // Restore the references held by the garbage, so releasing them works like it normally does
+    for (long i=0; i!=gc_garbage.len; i++) {
+        _gc_traverse(gc_garbage.objects[i], _gc_visit_restore);
+    }
+    for (long i=0; i!=gc_garbage.len; i++) {
+        gc_garbage.objects[i]->ref_count += GC_GARBAGE_GUARD;
+    }
+
+    // Free the values first, as they can still point to other garbage objects
+    for (long i=0; i!=gc_garbage.len; i++) {
+        object_free_values(gc_garbage.objects[i]);
+    }
+    for (long i=0; i!=gc_garbage.len; i++) {
+        object_destroy(gc_garbage.objects[i]);
+    }
+
+    // Inline caches could still point to attributes we just freed
+    object_attrib_generation++;
+
+    gc_stats.collected += gc_garbage.len;
+    gc_garbage.len = 0;
+}
+
+
+static void _gc_unlink_root(t_object *obj) {
+    if (obj->gc_prev) {
+        obj->gc_prev->gc_next = obj->gc_next;
+    } else {
+        gc_roots = obj->gc_next;
+    }
+    if (obj->gc_next) {
+        obj->gc_next->gc_prev = obj->gc_prev;
+    }
+    obj->gc_prev = obj->gc_next = NULL;
+    obj->gc_color &= ~GC_FLAG_BUFFERED;
+    gc_roots_count--;
+}
 
 
 /**
- * Do garbage collection
+ * Buffers an object that lost a reference, as it might be part of a garbage cycle
+ */
+void gc_possible_root(t_object *obj) {
+    GC_SET_COLOR(obj, GC_COLOR_PURPLE);
+    if (obj->gc_color & GC_FLAG_BUFFERED) return;
+
+    obj->gc_color |= GC_FLAG_BUFFERED;
+    obj->gc_prev = NULL;
+    obj->gc_next = gc_roots;
+    if (gc_roots) gc_roots->gc_prev = obj;
+    gc_roots = obj;
+    gc_roots_count++;
+
+    if (gc_threshold && gc_roots_count >= gc_threshold && ! gc_collecting) {
+        gc_collect_requested = 1;
+    }
+}
+
+
+/**
+ * Removes an object that is about to be destroyed from the possible roots
+ */
+void gc_forget_root(t_object *obj) {
+    if (obj->gc_color & GC_FLAG_BUFFERED) {
+        _gc_unlink_root(obj);
+    }
+    obj->gc_color = GC_COLOR_BLACK;
+}
+
+
+/**
+ * Does a trial deletion on at most max_roots possible roots. Returns the number of roots handled.
+ */
+static long _gc_collect_roots(long max_roots) {
+    struct timespec start, end;
+    t_gc_objects roots = { NULL, 0, 0 };
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    gc_collecting = 1;
+
+    // Take the roots out of the buffer. Roots that got a reference back in the meantime are in use.
+    while (gc_roots && roots.len < max_roots) {
+        t_object *obj = gc_roots;
+        _gc_unlink_root(obj);
+        if (GC_COLOR(obj) == GC_COLOR_PURPLE && obj->ref_count > 0) {
+            _gc_push(&roots, obj);
+        } else {
+            GC_SET_COLOR(obj, GC_COLOR_BLACK);
+        }
+    }
+
+    for (long i=0; i!=roots.len; i++) {
+        _gc_mark_gray(roots.objects[i]);
+    }
+    for (long i=0; i!=roots.len; i++) {
+        _gc_scan(roots.objects[i]);
+    }
+    for (long i=0; i!=roots.len; i++) {
+        _gc_collect_white(roots.objects[i]);
+    }
+    _gc_free_garbage();
+
+    long count = roots.len;
+    smm_free(roots.objects);
+
+    gc_collecting = 0;
+    if (gc_roots_count < gc_threshold) {
+        gc_collect_requested = 0;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double pause = (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_nsec - start.tv_nsec) / 1000000.0;
+    gc_stats.collections++;
+    gc_stats.roots += count;
+    gc_stats.total_pause += pause;
+    if (pause > gc_stats.max_pause) gc_stats.max_pause = pause;
+
+    return count;
+}
+
+
+/**
+ * Does a single incremental collection step, which handles at most gc.slice possible roots
+ */
+void gc_collect_step(void) {
+    if (gc_collecting) return;
+    _gc_collect_roots(gc_slice > 0 ? gc_slice : gc_roots_count);
+}
+
+
+/**
+ * Do garbage collection on all possible roots
  */
 void gc_collect(void) {
     DEBUG_PRINT_CHAR("gc_collect()");
+
+    if (gc_collecting) return;
+    while (gc_roots) {
+        _gc_collect_roots(gc_roots_count);
+    }
 }
 
 
@@ -62,19 +399,15 @@ t_object *gc_queue_recycle(int type) {
         return NULL;
     }
 
-    // Lock mutex for this queue
-    mutex_wait(&gc_queue[type].mutex);
-
-    t_object *obj = NULL;
-    if (gc_queue[type].index > 0) {
-        gc_queue[type].index--;
-        obj = gc_queue[type].queue[gc_queue[type].index];
+    t_gc_queue *queue = &gc_queue[type];
+    if (queue->index == 0) {
+        if (queue->size) queue->misses++;
+        return NULL;
     }
 
-    // Unlock mutex
-    mutex_post(&gc_queue[type].mutex);
-
-    return obj;
+    queue->hits++;
+    queue->index--;
+    return queue->queue[queue->index];
 }
 
 
@@ -82,26 +415,37 @@ t_object *gc_queue_recycle(int type) {
  * Try and adds object to the end of the queue. Returns 1 on success, 0 when queue is full
  */
 int gc_queue_add(t_object *obj) {
-    int ret;
-
-    // @TODO: There is no sanity check to see if obj->type is between 0 and OBJECT_TYPE_LEN!
+    // Check bounds for type
+    if (obj->type < 0 || obj->type >= OBJECT_TYPE_LEN) {
+        return 0;
+    }
 
-    // Lock mutex for this queue
-    mutex_wait(&gc_queue[obj->type].mutex);
+    t_gc_queue *queue = &gc_queue[obj->type];
+    if (queue->index >= queue->size) {
+        return 0;
+    }
 
     // Add to recycle queue
-    if (gc_queue[obj->type].index < gc_queue[obj->type].size) {
-        gc_queue[obj->type].queue[gc_queue[obj->type].index] = obj;
-        gc_queue[obj->type].index++;
-        ret = 1;
-    } else {
-        ret = 0;
-    }
+    queue->queue[queue->index] = obj;
+    queue->index++;
+    return 1;
+}
 
-    // Unlock mutex
-    mutex_post(&gc_queue[obj->type].mutex);
 
-    return ret;
+/**
+ * Displays recycle statistics per object type
+ */
+void gc_debug_stats(void) {
+    DEBUG_PRINT_CHAR("Recycle queues:\n");
+    DEBUG_PRINT_CHAR("  %-10s %6s %10s %10s\n", "type", "size", "hits", "misses");
+    for (int i=0; i!=OBJECT_TYPE_LEN; i++) {
+        if (! gc_queue[i].size) continue;
+        DEBUG_PRINT_CHAR("  %-10s %6d %10ld %10ld\n", objectTypeNames[i], gc_queue[i].size, gc_queue[i].hits, gc_queue[i].misses);
+    }
+
+    DEBUG_PRINT_CHAR("Cycle collector:\n");
+    DEBUG_PRINT_CHAR("  steps: %ld  roots: %ld  collected: %ld  buffered: %ld\n", gc_stats.collections, gc_stats.roots, gc_stats.collected, gc_roots_count);
+    DEBUG_PRINT_CHAR("  total pause: %.3f ms  longest pause: %.3f ms\n", gc_stats.total_pause, gc_stats.max_pause);
 }
 
 
@@ -109,13 +453,30 @@ int gc_queue_add(t_object *obj) {
  *
  */
 void gc_init(void) {
-    // Create all queues
+    char key[64];
+
+    // A threshold of 0 disables automatic cycle collection
+    gc_threshold = config_get_long("gc.threshold", GC_DEFAULT_THRESHOLD);
+    if (gc_threshold < 0) gc_threshold = 0;
+    gc_slice = config_get_long("gc.slice", GC_DEFAULT_SLICE);
+
+    gc_roots = NULL;
+    gc_roots_count = 0;
+    gc_collect_requested = 0;
+
+    // Create all queues. Their sizes can be set through gc.queue.<type> in the configuration
     for (int i=0; i!=OBJECT_TYPE_LEN; i++) {
-        mutex_create(&gc_queue[i].mutex);
-        gc_queue[i].size = GC_OBJECT_QUEUE_SIZE;
+        gc_queue[i].size = 0;
+        if (gc_queue_default_size[i]) {
+            snprintf(key, sizeof(key), "gc.queue.%s", objectTypeNames[i]);
+            gc_queue[i].size = config_get_long(key, gc_queue_default_size[i]);
+            if (gc_queue[i].size < 0) gc_queue[i].size = 0;
+        }
 
-        gc_queue[i].queue = smm_malloc(sizeof(t_object *) * gc_queue[i].size);
+        gc_queue[i].queue = gc_queue[i].size ? smm_malloc(sizeof(t_object *) * gc_queue[i].size) : NULL;
         gc_queue[i].index = 0;
+        gc_queue[i].hits = 0;
+        gc_queue[i].misses = 0;
     }
 }
 
@@ -124,8 +485,25 @@ void gc_init(void) {
  *
  */
 void gc_fini(void) {
+    gc_roots = NULL;
+    gc_roots_count = 0;
+
+    smm_free(gc_stack.objects);
+    gc_stack.objects = NULL;
+    gc_stack.len = gc_stack.size = 0;
+    smm_free(gc_garbage.objects);
+    gc_garbage.objects = NULL;
+    gc_garbage.len = gc_garbage.size = 0;
+
     for (int i=0; i!=OBJECT_TYPE_LEN; i++) {
-        mutex_destroy(&gc_queue[i].mutex);
+        // Destroy all objects that are still waiting to be recycled
+        while (gc_queue[i].index > 0) {
+            t_object *obj = gc_queue[i].queue[--gc_queue[i].index];
+            obj->funcs->destroy(obj);
+        }
+
         smm_free(gc_queue[i].queue);
+        gc_queue[i].queue = NULL;
+        gc_queue[i].size = 0;
     }
 }
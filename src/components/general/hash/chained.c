@@ -29,31 +29,13 @@
 #include "objects/object.h"
 #include "general/hashtable.h"
 #include "general/hash/hash_funcs.h"
+#include "general/intern.h"
 #include "general/smm.h"
 
 /**
  * These hash tables are not reentrant, nor threadsafe!
  */
 
-static hash_t ht_hash(t_hash_table *ht, t_hash_key *key) {
-    hash_t hash_value = 0;
-    if (! ht) return 0;      // Not a hash table
-
-    switch (key->type) {
-        case HASH_KEY_STR :
-            hash_value = ht->hashfuncs->hash(ht, (const char *)key->val.s);
-            break;
-        case HASH_KEY_NUM :
-            hash_value = key->val.n;
-            break;
-        case HASH_KEY_OBJ :
-            hash_value = ht->hashfuncs->hash(ht, (const char *)object_get_hash((t_object *)(key->val.o)));
-            break;
-    }
-
-    return hash_value;
-}
-
 /**
  * Resize the hashtable, and rehash all values
  */
@@ -92,11 +74,10 @@ static void chf_resize(t_hash_table *ht, int new_bucket_count) {
 
 
 /**
- * Return bucket for specified key
+ * Return bucket for specified key, where hash_value is the (uncapped) hash of the key
  */
-static t_hash_table_bucket *find_bucket(t_hash_table *ht, t_hash_key *key) {
+static t_hash_table_bucket *find_bucket(t_hash_table *ht, t_hash_key *key, hash_t hash_value) {
     // Locate the hash value in the bucket list.
-    hash_t hash_value = ht_hash(ht, key);
     hash_t hash_value_capped = hash_value % ht->bucket_count;
     if (ht->bucket_list[hash_value_capped] == NULL) {
         // Not found
@@ -108,23 +89,24 @@ static t_hash_table_bucket *find_bucket(t_hash_table *ht, t_hash_key *key) {
     t_hash_table_bucket *htb = ht->bucket_list[hash_value_capped];
 
 
-    // Cache the key hashval when we are dealing with objects.
-    char *key_hash_val = NULL;
-    if (key->type == HASH_KEY_OBJ) {
-        key_hash_val = object_get_hash((t_object *)(key->val.o));
-    }
-
-
     while (htb) {
+        // Different hashes can never be the same key
+        if (htb->hash != hash_value) {
+            htb = htb->next_in_bucket;
+            continue;
+        }
+
         switch (key->type) {
             case HASH_KEY_STR :
-                if (strcmp(htb->key->val.s, key->val.s) == 0) found = 1;
+                // Interned keys match by address
+                if (htb->key->val.s == key->val.s) found = 1;
+                else if (htb->key->len == key->len && memcmp(htb->key->val.s, key->val.s, key->len) == 0) found = 1;
                 break;
             case HASH_KEY_NUM :
                 if (htb->key->val.n == key->val.n) found = 1;
                 break;
             case HASH_KEY_OBJ :
-                if (strcmp(object_get_hash((t_object *)(htb->key->val.o)), key_hash_val) == 0) found = 1;
+                if (object_hash_equals((t_object *)(htb->key->val.o), (t_object *)(key->val.o))) found = 1;
                 break;
         }
         if (found) return htb;
@@ -136,12 +118,12 @@ static t_hash_table_bucket *find_bucket(t_hash_table *ht, t_hash_key *key) {
 
 
 /**
- * Find key in hash table
+ * Find key with a precomputed hash in hash table
  */
-static void *chf_find(t_hash_table *ht, t_hash_key *key) {
+static void *chf_find_hashed(t_hash_table *ht, t_hash_key *key, hash_t hash) {
     if (! ht) return NULL;      // Not a hash table
 
-    t_hash_table_bucket *htb = find_bucket(ht, key);
+    t_hash_table_bucket *htb = find_bucket(ht, key, hash);
     if (! htb) return NULL;
 
     return htb->value;
@@ -149,25 +131,41 @@ static void *chf_find(t_hash_table *ht, t_hash_key *key) {
 
 
 /**
- * Check if a key exists in a hashtable
+ * Find key in hash table
  */
-static int chf_exists(t_hash_table *ht, t_hash_key *key) {
+static void *chf_find(t_hash_table *ht, t_hash_key *key) {
+    return chf_find_hashed(ht, key, ht_key_hash(ht, key));
+}
+
+
+/**
+ * Check if a key with a precomputed hash exists in a hashtable
+ */
+static int chf_exists_hashed(t_hash_table *ht, t_hash_key *key, hash_t hash) {
     if (! ht) return 0;      // Not a hash table
 
-    t_hash_table_bucket *htb = find_bucket(ht, key);
+    t_hash_table_bucket *htb = find_bucket(ht, key, hash);
     if (! htb) return 0;
 
     return 1;
 }
 
 
+/**
+ * Check if a key exists in a hashtable
+ */
+static int chf_exists(t_hash_table *ht, t_hash_key *key) {
+    return chf_exists_hashed(ht, key, ht_key_hash(ht, key));
+}
+
+
 /**
  * Add key/value pair to the hash
  */
 static int chf_add(t_hash_table *ht, t_hash_key *key, void *value) {
     if (! ht) return 0;      // Not a hash table
 
-    hash_t hash_value = ht_hash(ht, key);
+    hash_t hash_value = ht_key_hash(ht, key);
     hash_t hash_value_capped = hash_value % ht->bucket_count;
 
     // Create bucket for new variable
@@ -222,7 +220,7 @@ static int chf_add(t_hash_table *ht, t_hash_key *key, void *value) {
 static void *chf_replace(t_hash_table *ht, t_hash_key *key, void *value) {
     if (! ht) return 0;      // Not a hash table
 
-    t_hash_table_bucket *htb = find_bucket(ht, key);
+    t_hash_table_bucket *htb = find_bucket(ht, key, ht_key_hash(ht, key));
     if (! htb) {
         chf_add(ht, key, value);
         return NULL;
@@ -244,7 +242,7 @@ static void *chf_remove(t_hash_table *ht, t_hash_key *key) {
 
     t_hash_table_bucket *prev, *next;
 
-    hash_t hash_value = ht_hash(ht, key);
+    hash_t hash_value = ht_key_hash(ht, key);
     hash_t hash_value_capped = hash_value % ht->bucket_count;
 
     // Nothing to remove if nothing was found
@@ -254,19 +252,7 @@ static void *chf_remove(t_hash_table *ht, t_hash_key *key) {
     t_hash_table_bucket *prev_htb = NULL;   // Keep a reference to the previous element in the bucket
     t_hash_table_bucket *htb = ht->bucket_list[hash_value_capped];
     while (htb) {
-        int found = 0;
-        switch (htb->key->type) {
-            case HASH_KEY_STR :
-                found = strcmp(htb->key->val.s, key->val.s) == 0;
-                break;
-            case HASH_KEY_NUM :
-                found = htb->key->val.n == key->val.n;
-                break;
-            case HASH_KEY_OBJ :
-                found = strcmp(object_get_hash((t_object *)(htb->key->val.o)), object_get_hash((t_object *)(key->val.o)));
-                break;
-        }
-        if (found) break;
+        if (htb->hash == hash_value && ht_key_equals(htb->key, key)) break;
         prev_htb = htb;
         htb = htb->next_in_bucket;
     }
@@ -364,15 +350,59 @@ void chf_deep_copy(t_hash_table *ht) {
 }
 
 
+/**
+ * Frees all buckets and the bucket list
+ */
+static void chf_destroy(t_hash_table *ht) {
+    t_hash_table_bucket *bucket = ht->head;
+    while (bucket) {
+        t_hash_table_bucket *next_bucket = bucket->next_element;
+
+        ht_key_free(bucket->key);
+        smm_free(bucket);
+
+        bucket = next_bucket;
+    }
+
+    smm_free(ht->bucket_list);
+}
+
+
+/**
+ * Iterate buckets in the order they were added
+ */
+static void chf_iter_rewind(t_hash_iter *iter) {
+    iter->bucket = iter->ht->head;
+}
+
+static void chf_iter_next(t_hash_iter *iter) {
+    if (iter->bucket) iter->bucket = iter->bucket->next_element;
+}
+
+static int chf_iter_fetch(t_hash_iter *iter, t_hash_key **key, void **value) {
+    if (iter->bucket == NULL) return 0;
+
+    if (key) *key = iter->bucket->key;
+    if (value) *value = iter->bucket->value;
+    return 1;
+}
+
+
 // Hash structure with our function definitions
 t_hashfuncs chained_hf = {
     hash_native,                // Use the native hashing method
     //hash_djbx33a,
     chf_find,
     chf_exists,
+    chf_find_hashed,
+    chf_exists_hashed,
     chf_add,
     chf_replace,
     chf_remove,
     chf_resize,
     chf_deep_copy,
+    chf_destroy,
+    chf_iter_rewind,
+    chf_iter_next,
+    chf_iter_fetch,
 };
@@ -45,6 +45,18 @@ hash_t hash_native(t_hash_table *ht, const char *key) {
 }
 
 
+/**
+ * SDBM hash over len bytes. Returns the same hash as hash_native() for strings without \0's.
+ */
+hash_t hash_native_len(const char *key, size_t len) {
+    hash_t h = 0;
+
+    while (len--) h = *key++ + (h<<6) + (h<<16) - h;
+
+    return h;
+}
+
+
 /**
  * Bernstein DJB33A hash
  */
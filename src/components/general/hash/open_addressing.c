@@ -0,0 +1,458 @@
+/*
+ Copyright (c) 2012-2013, The Saffire Group
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+     * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+     * Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in the
+       documentation and/or other materials provided with the distribution.
+     * Neither the name of the Saffire Group the
+       names of its contributors may be used to endorse or promote products
+       derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include <string.h>
+#include <stdint.h>
+#ifdef __SSE2__
+    #include <emmintrin.h>
+#endif
+#include "general/hashtable.h"
+#include "general/intern.h"
+#include "general/string.h"
+#include "general/hash/hash_funcs.h"
+#include "general/hash/open_addressing.h"
+#include "general/smm.h"
+
+/*
+ * Open addressing hash table. Slots are grouped per 16, and every slot has a control byte that tells if the slot is
+ * empty, deleted, or holds an entry with the given 7 bits of its hash. A whole group of control bytes is matched at
+ * once (with SSE2 when available), so most lookups only touch a single group and a single entry.
+ *
+ * The entries themselves are stored in a dense array in insertion order, and the slots only point into this array.
+ * This keeps iteration in insertion order without linking the entries together.
+ *
+ * These hash tables are not reentrant, nor threadsafe!
+ */
+
+#define OA_GROUP_WIDTH          16
+#define OA_MIN_CAPACITY         OA_GROUP_WIDTH
+#define OA_MAX_LOAD_FACTOR      0.875
+
+#define OA_CTRL_EMPTY           ((int8_t)-128)
+#define OA_CTRL_DELETED         ((int8_t)-2)
+
+typedef struct _oa_entry {
+    t_hash_key key;             // Key of the entry, stored inline so a lookup does not need another cache line
+    void *value;                // Value of the entry
+    hash_t hash;                // Hash of the key (for quick rehashing)
+} t_oa_entry;
+
+// Key type of a removed entry
+#define OA_KEY_REMOVED          -1
+#define OA_ENTRY_REMOVED(e)     ((e)->key.type == OA_KEY_REMOVED)
+
+typedef struct _oa_table {
+    unsigned int capacity;      // Number of slots (power of 2, and at least a single group)
+    unsigned int used_slots;    // Number of slots that are not empty (including deleted slots)
+    int8_t *ctrl;               // Control byte for each slot
+    unsigned int *slots;        // Index into the entries for each slot
+
+    t_oa_entry *entries;        // Dense entries in insertion order
+    unsigned int entry_count;   // Number of entries in use (including removed entries)
+    unsigned int entry_size;    // Number of allocated entries
+} t_oa_table;
+
+#define OA(ht)                  ((t_oa_table *)(ht)->data)
+
+// Spread the hash, so sequential (numerical) keys are spread over all groups and control bytes
+#define OA_MIX(hash)            ((hash_t)(hash) * (hash_t)0x9E3779B97F4A7C15ULL)
+#define OA_H2(mixed)            ((int8_t)((mixed) >> (sizeof(hash_t) * 8 - 7)))
+
+
+/**
+ * Returns a bitmask with a bit set for every control byte in the group that equals c
+ */
+#ifdef __SSE2__
+static inline unsigned int _oa_match(const int8_t *group, int8_t c) {
+    __m128i ctrl = _mm_loadu_si128((const __m128i *)group);
+    return (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(c)));
+}
+#else
+static inline unsigned int _oa_match(const int8_t *group, int8_t c) {
+    unsigned int mask = 0;
+    for (int i=0; i!=OA_GROUP_WIDTH; i++) {
+        if (group[i] == c) mask |= 1 << i;
+    }
+    return mask;
+}
+#endif
+
+
+/**
+ * Returns the maximum load factor for this table
+ */
+static float _oa_load_factor(t_hash_table *ht) {
+    if (ht->load_factor <= 0 || ht->load_factor > OA_MAX_LOAD_FACTOR) return OA_MAX_LOAD_FACTOR;
+    return ht->load_factor;
+}
+
+
+/**
+ * Returns the slot that holds key, or -1 when the key is not found
+ */
+static long _oa_find_slot(t_oa_table *oa, t_hash_key *key, hash_t hash) {
+    hash_t mixed = OA_MIX(hash);
+    int8_t h2 = OA_H2(mixed);
+    unsigned int group_mask = (oa->capacity / OA_GROUP_WIDTH) - 1;
+    unsigned int group = mixed & group_mask;
+
+    // Triangular probing over the groups, which visits every group once
+    for (unsigned int step = 1; step <= group_mask + 1; step++) {
+        int8_t *ctrl = oa->ctrl + group * OA_GROUP_WIDTH;
+
+        unsigned int match = _oa_match(ctrl, h2);
+        while (match) {
+            unsigned int slot = group * OA_GROUP_WIDTH + __builtin_ctz(match);
+            t_oa_entry *entry = &oa->entries[oa->slots[slot]];
+            if (entry->hash == hash) {
+                // Interned string keys match by address, so try that before a full compare
+                if (entry->key.type == key->type && entry->key.type == HASH_KEY_STR && entry->key.val.s == key->val.s) return slot;
+                if (ht_key_equals(&entry->key, key)) return slot;
+            }
+            match &= match - 1;
+        }
+
+        // A group with an empty slot was never full, so the key was never placed beyond this group
+        if (_oa_match(ctrl, OA_CTRL_EMPTY)) return -1;
+
+        group = (group + step) & group_mask;
+    }
+
+    return -1;
+}
+
+
+/**
+ * Returns the first empty or deleted slot for a new entry with the given hash
+ */
+static unsigned int _oa_find_free_slot(t_oa_table *oa, hash_t hash) {
+    hash_t mixed = OA_MIX(hash);
+    unsigned int group_mask = (oa->capacity / OA_GROUP_WIDTH) - 1;
+    unsigned int group = mixed & group_mask;
+
+    // The load factor makes sure there is always a free slot
+    for (unsigned int step = 1; ; step++) {
+        int8_t *ctrl = oa->ctrl + group * OA_GROUP_WIDTH;
+
+        unsigned int match = _oa_match(ctrl, OA_CTRL_EMPTY) | _oa_match(ctrl, OA_CTRL_DELETED);
+        if (match) return group * OA_GROUP_WIDTH + __builtin_ctz(match);
+
+        group = (group + step) & group_mask;
+    }
+}
+
+
+/**
+ * Compacts the entries, and places them in a new set of slots with the given capacity
+ */
+static void _oa_rebuild(t_hash_table *ht, unsigned int capacity) {
+    t_oa_table *oa = OA(ht);
+
+    // Drop removed entries. This keeps the insertion order of the remaining entries.
+    unsigned int count = 0;
+    for (int i=0; i!=oa->entry_count; i++) {
+        if (! OA_ENTRY_REMOVED(&oa->entries[i])) oa->entries[count++] = oa->entries[i];
+    }
+    oa->entry_count = count;
+
+    if (oa->ctrl) smm_free(oa->ctrl);
+    if (oa->slots) smm_free(oa->slots);
+
+    oa->capacity = capacity;
+    oa->ctrl = smm_malloc(capacity);
+    memset(oa->ctrl, OA_CTRL_EMPTY, capacity);
+    oa->slots = smm_malloc(sizeof(unsigned int) * capacity);
+
+    for (int i=0; i!=oa->entry_count; i++) {
+        unsigned int slot = _oa_find_free_slot(oa, oa->entries[i].hash);
+        oa->ctrl[slot] = OA_H2(OA_MIX(oa->entries[i].hash));
+        oa->slots[slot] = i;
+    }
+    oa->used_slots = oa->entry_count;
+
+    ht->bucket_count = capacity;
+}
+
+
+/**
+ * Returns the capacity needed to store count elements
+ */
+static unsigned int _oa_capacity_for(t_hash_table *ht, unsigned int count) {
+    unsigned int capacity = OA_MIN_CAPACITY;
+    float lf = _oa_load_factor(ht);
+
+    while (capacity * lf < count) capacity <<= 1;
+    return capacity;
+}
+
+
+/**
+ * Resize the hashtable, and rehash all values
+ */
+static void oaf_resize(t_hash_table *ht, int new_bucket_count) {
+    unsigned int capacity = _oa_capacity_for(ht, new_bucket_count > ht->element_count ? new_bucket_count : ht->element_count);
+
+    if (! ht->data) {
+        // Initial allocation. The entries are allocated on the first add.
+        ht->data = smm_zalloc(sizeof(t_oa_table));
+    }
+
+    _oa_rebuild(ht, capacity);
+}
+
+
+/**
+ * Find key with a precomputed hash in hash table
+ */
+static void *oaf_find_hashed(t_hash_table *ht, t_hash_key *key, hash_t hash) {
+    if (! ht) return NULL;      // Not a hash table
+
+    t_oa_table *oa = OA(ht);
+    long slot = _oa_find_slot(oa, key, hash);
+    if (slot == -1) return NULL;
+
+    return oa->entries[oa->slots[slot]].value;
+}
+
+
+/**
+ * Find key in hash table
+ */
+static void *oaf_find(t_hash_table *ht, t_hash_key *key) {
+    return oaf_find_hashed(ht, key, ht_key_hash(ht, key));
+}
+
+
+/**
+ * Check if a key with a precomputed hash exists in a hashtable
+ */
+static int oaf_exists_hashed(t_hash_table *ht, t_hash_key *key, hash_t hash) {
+    if (! ht) return 0;      // Not a hash table
+
+    return _oa_find_slot(OA(ht), key, hash) != -1;
+}
+
+
+/**
+ * Check if a key exists in a hashtable
+ */
+static int oaf_exists(t_hash_table *ht, t_hash_key *key) {
+    return oaf_exists_hashed(ht, key, ht_key_hash(ht, key));
+}
+
+
+/**
+ * Add key/value pair to the hash
+ */
+static int oaf_add(t_hash_table *ht, t_hash_key *key, void *value) {
+    if (! ht) return 0;      // Not a hash table
+
+    t_oa_table *oa = OA(ht);
+    hash_t hash = ht_key_hash(ht, key);
+
+    // Make room for a new entry. Compact first when enough entries have been removed.
+    if (oa->entry_count == oa->entry_size) {
+        if (oa->entry_count - ht->element_count > oa->entry_count / 4) {
+            _oa_rebuild(ht, oa->capacity);
+        } else {
+            oa->entry_size = oa->entry_size ? oa->entry_size * 2 : 8;
+            oa->entries = smm_realloc(oa->entries, sizeof(t_oa_entry) * oa->entry_size);
+        }
+    }
+
+    // Keep the slots below the load factor. Deleted slots count as well, since they lengthen the probes.
+    if (oa->used_slots + 1 > oa->capacity * _oa_load_factor(ht)) {
+        _oa_rebuild(ht, _oa_capacity_for(ht, (ht->element_count + 1) * 2));
+    }
+
+    unsigned int slot = _oa_find_free_slot(oa, hash);
+    if (oa->ctrl[slot] == OA_CTRL_EMPTY) oa->used_slots++;
+    oa->ctrl[slot] = OA_H2(OA_MIX(hash));
+    oa->slots[slot] = oa->entry_count;
+
+    // The key is stored inside the entry (including the string it owns), so the key structure itself is not needed anymore
+    t_oa_entry *entry = &oa->entries[oa->entry_count++];
+    entry->key = *key;
+    entry->value = value;
+    entry->hash = hash;
+    smm_free(key);
+
+    ht->element_count++;
+
+    return 1;
+}
+
+
+/**
+ * Add key/value pair to the hash
+ */
+static void *oaf_replace(t_hash_table *ht, t_hash_key *key, void *value) {
+    if (! ht) return 0;      // Not a hash table
+
+    t_oa_table *oa = OA(ht);
+    long slot = _oa_find_slot(oa, key, ht_key_hash(ht, key));
+    if (slot == -1) {
+        oaf_add(ht, key, value);
+        return NULL;
+    }
+
+    t_oa_entry *entry = &oa->entries[oa->slots[slot]];
+    void *val = entry->value;
+    entry->value = value;
+    return val;
+}
+
+
+/**
+ * Remove key from hash table
+ */
+static void *oaf_remove(t_hash_table *ht, t_hash_key *key) {
+    if (! ht) return 0;      // Not a hash table
+
+    t_oa_table *oa = OA(ht);
+    long slot = _oa_find_slot(oa, key, ht_key_hash(ht, key));
+    if (slot == -1) return 0;
+
+    t_oa_entry *entry = &oa->entries[oa->slots[slot]];
+    void *val = entry->value;
+
+    ht_key_free_value(&entry->key);
+    entry->key.type = OA_KEY_REMOVED;
+    entry->value = NULL;
+
+    // A group that still has an empty slot was never full, so no probe continued past it, and the slot can be
+    // emptied. Otherwise it must stay marked as deleted.
+    int8_t *group = oa->ctrl + (slot & ~(OA_GROUP_WIDTH - 1));
+    if (_oa_match(group, OA_CTRL_EMPTY)) {
+        oa->ctrl[slot] = OA_CTRL_EMPTY;
+        oa->used_slots--;
+    } else {
+        oa->ctrl[slot] = OA_CTRL_DELETED;
+    }
+
+    // Removed entries at the end of the entries can be reused directly
+    while (oa->entry_count && OA_ENTRY_REMOVED(&oa->entries[oa->entry_count - 1])) oa->entry_count--;
+
+    ht->element_count--;
+
+    return val;
+}
+
+
+/**
+ * Makes a deep copy of the entries and slots
+ */
+static void oaf_deep_copy(t_hash_table *ht) {
+    ht->copy_on_write = 0;
+
+    t_oa_table *org = OA(ht);
+    t_oa_table *oa = smm_malloc(sizeof(t_oa_table));
+    memcpy(oa, org, sizeof(t_oa_table));
+
+    oa->ctrl = smm_malloc(oa->capacity);
+    memcpy(oa->ctrl, org->ctrl, oa->capacity);
+    oa->slots = smm_malloc(sizeof(unsigned int) * oa->capacity);
+    memcpy(oa->slots, org->slots, sizeof(unsigned int) * oa->capacity);
+
+    oa->entries = NULL;
+    if (oa->entry_size) {
+        // Keys are stored inside the entries. Only strings that are not interned need their own copy.
+        oa->entries = smm_malloc(sizeof(t_oa_entry) * oa->entry_size);
+        memcpy(oa->entries, org->entries, sizeof(t_oa_entry) * oa->entry_count);
+        for (unsigned int i=0; i != oa->entry_count; i++) {
+            t_hash_key *key = &oa->entries[i].key;
+            if (key->type == HASH_KEY_STR && ! string_is_interned(key->val.s)) {
+                key->val.s = string_strdup0(key->val.s);
+            }
+        }
+    }
+
+    ht->data = oa;
+}
+
+
+/**
+ * Frees all entries and slots
+ */
+static void oaf_destroy(t_hash_table *ht) {
+    t_oa_table *oa = OA(ht);
+
+    for (unsigned int i=0; i != oa->entry_count; i++) {
+        if (! OA_ENTRY_REMOVED(&oa->entries[i])) ht_key_free_value(&oa->entries[i].key);
+    }
+    if (oa->entries) smm_free(oa->entries);
+    smm_free(oa->ctrl);
+    smm_free(oa->slots);
+    smm_free(oa);
+    ht->data = NULL;
+}
+
+
+/**
+ * Iterate the dense entries, skipping removed entries
+ */
+static void oaf_iter_rewind(t_hash_iter *iter) {
+    t_oa_table *oa = OA(iter->ht);
+
+    iter->bucket_idx = 0;
+    while (iter->bucket_idx < oa->entry_count && OA_ENTRY_REMOVED(&oa->entries[iter->bucket_idx])) iter->bucket_idx++;
+}
+
+static void oaf_iter_next(t_hash_iter *iter) {
+    t_oa_table *oa = OA(iter->ht);
+
+    iter->bucket_idx++;
+    while (iter->bucket_idx < oa->entry_count && OA_ENTRY_REMOVED(&oa->entries[iter->bucket_idx])) iter->bucket_idx++;
+}
+
+static int oaf_iter_fetch(t_hash_iter *iter, t_hash_key **key, void **value) {
+    t_oa_table *oa = OA(iter->ht);
+
+    if (iter->bucket_idx >= oa->entry_count || OA_ENTRY_REMOVED(&oa->entries[iter->bucket_idx])) return 0;
+
+    if (key) *key = &oa->entries[iter->bucket_idx].key;
+    if (value) *value = oa->entries[iter->bucket_idx].value;
+    return 1;
+}
+
+
+// Hash structure with our function definitions
+t_hashfuncs open_addressing_hf = {
+    hash_native,                // Use the native hashing method
+    oaf_find,
+    oaf_exists,
+    oaf_find_hashed,
+    oaf_exists_hashed,
+    oaf_add,
+    oaf_replace,
+    oaf_remove,
+    oaf_resize,
+    oaf_deep_copy,
+    oaf_destroy,
+    oaf_iter_rewind,
+    oaf_iter_next,
+    oaf_iter_fetch,
+};
@@ -30,11 +30,12 @@
 #include "general/hashtable.h"
 #include "general/smm.h"
 #include "general/string.h"
+#include "general/intern.h"
+#include "general/hash/hash_funcs.h"
+#include "general/hash/chained.h"
 #include "objects/object.h"
 #include "debug.h"
 
-extern t_hashfuncs chained_hf;
-
 
 #define HT_INITIAL_BUCKET_COUNT    16           // Initial hash size
 #define HT_LOAD_FACTOR           1.25           // Above this load, we will increase the hash size (it's above 1.00
@@ -59,6 +60,8 @@ static t_hash_table *_ht_create(int bucket_count, float load_factor, float resiz
     ht->hashfuncs = hashfuncs;
     ht->head = NULL;
     ht->tail = NULL;
+    ht->bucket_list = NULL;
+    ht->data = NULL;
 
     ht->hashfuncs->resize(ht, bucket_count);
     return ht;
@@ -102,28 +105,12 @@ t_hash_table *ht_copy(t_hash_table *ht, int copy_on_write) {
  * Free a hash table
  */
 void ht_destroy(t_hash_table *ht) {
-    t_hash_table_bucket *bucket, *next_bucket;
-
     // Nothing to free
     if (!ht) return;
 
     if (!ht->copy_on_write) {
-        // Destroy buckets
-        bucket = ht->head;
-        while (bucket) {
-            // Find next bucket
-            next_bucket = bucket->next_element;
-
-            // Now, we can safely remove bucket
-            ht_key_free(bucket->key);
-            smm_free(bucket);
-
-            // goto next bucket
-            bucket = next_bucket;
-        }
-
-        // Free bucket list array
-        smm_free(ht->bucket_list);
+        // Destroy elements
+        ht->hashfuncs->destroy(ht);
     }
 
 
@@ -142,22 +129,39 @@ void *ht_find(t_hash_table *ht, t_hash_key *key) {
     return ht->hashfuncs->find(ht, key);
 }
 void *ht_find_str(t_hash_table *ht, char *key) {
-    t_hash_key *hkey = ht_key_create(HASH_KEY_STR, (void *)key);
-    void *ret = ht_find(ht, hkey);
-    ht_key_free(hkey);
-    return ret;
+    size_t len;
+    hash_t hash = ht_hash_str(key, &len);
+    return ht_find_hashed(ht, key, len, hash);
 }
 void *ht_find_num(t_hash_table *ht, unsigned long key) {
-    t_hash_key *hkey = ht_key_create(HASH_KEY_NUM, (void *)key);
-    void *ret = ht_find(ht, hkey);
-    ht_key_free(hkey);
-    return ret;
+    t_hash_key hkey = { .type = HASH_KEY_NUM, .val.n = key };
+    return ht_find(ht, &hkey);
 }
 void *ht_find_obj(t_hash_table *ht, t_object *key) {
-    t_hash_key *hkey = ht_key_create(HASH_KEY_OBJ, key);
-    void *ret = ht_find(ht, hkey);
-    ht_key_free(hkey);
-    return ret;
+    t_hash_key hkey = { .type = HASH_KEY_OBJ, .val.o = key };
+    return ht_find(ht, &hkey);
+}
+
+/**
+ * Finds a string key of len bytes, with a hash that was computed up front through ht_hash_str() or
+ * string_intern_hash(). Nothing is allocated, and interned keys are matched by address.
+ */
+void *ht_find_hashed(t_hash_table *ht, const char *key, size_t len, hash_t hash) {
+    t_hash_key hkey = { .type = HASH_KEY_STR, .len = len, .val.s = (char *)key };
+    return ht->hashfuncs->find_hashed(ht, &hkey, hash);
+}
+
+/**
+ * Returns the hash of a string key, and stores its length in len. Interned strings have both precomputed.
+ */
+hash_t ht_hash_str(const char *key, size_t *len) {
+    if (string_is_interned(key)) {
+        *len = string_intern_strlen(key);
+        return string_intern_hash(key);
+    }
+
+    *len = strlen(key);
+    return hash_native_len(key, *len);
 }
 
 /**
@@ -167,22 +171,21 @@ int ht_exists(t_hash_table *ht, t_hash_key *key) {
     return ht->hashfuncs->exists(ht, key);
 }
 int ht_exists_str(t_hash_table *ht, char *key) {
-    t_hash_key *hkey = ht_key_create(HASH_KEY_STR, (void *)key);
-    int ret = ht_exists(ht, hkey);
-    ht_key_free(hkey);
-    return ret;
+    size_t len;
+    hash_t hash = ht_hash_str(key, &len);
+    return ht_exists_hashed(ht, key, len, hash);
 }
 int ht_exists_num(t_hash_table *ht, unsigned long key) {
-    t_hash_key *hkey = ht_key_create(HASH_KEY_NUM, (void *)key);
-    int ret = ht_exists(ht, hkey);
-    ht_key_free(hkey);
-    return ret;
+    t_hash_key hkey = { .type = HASH_KEY_NUM, .val.n = key };
+    return ht_exists(ht, &hkey);
 }
 int ht_exists_obj(t_hash_table *ht, t_object *key) {
-    t_hash_key *hkey = ht_key_create(HASH_KEY_OBJ, key);
-    int ret = ht_exists(ht, hkey);
-    ht_key_free(hkey);
-    return ret;
+    t_hash_key hkey = { .type = HASH_KEY_OBJ, .val.o = key };
+    return ht_exists(ht, &hkey);
+}
+int ht_exists_hashed(t_hash_table *ht, const char *key, size_t len, hash_t hash) {
+    t_hash_key hkey = { .type = HASH_KEY_STR, .len = len, .val.s = (char *)key };
+    return ht->hashfuncs->exists_hashed(ht, &hkey, hash);
 }
 
 /**
@@ -219,8 +222,7 @@ void *ht_replace(t_hash_table *ht, t_hash_key *key, void *value) {
     }
 
     /* Check if the key exists, if so, remove and add new value. We do this because even though the
-     * key by itself is equal, it could be on a different address. It would mean that if we do
-     * key comparision the wrong way (by address, instead of their actual value), things can go wrong. */
+     * key by itself is equal, it could be a different key structure. */
     if (ht->hashfuncs->exists(ht, key)) {
         ht->hashfuncs->remove(ht, key);
         ht->hashfuncs->add(ht, key, value);
@@ -253,22 +255,19 @@ void *ht_remove(t_hash_table *ht, t_hash_key *key) {
     return ht->hashfuncs->remove(ht, key);
 }
 void *ht_remove_str(t_hash_table *ht, char *key) {
-    t_hash_key *hkey = ht_key_create(HASH_KEY_STR, key);
-    void *ret = ht_remove(ht, hkey);
-    ht_key_free(hkey);
-    return ret;
+    size_t len;
+    ht_hash_str(key, &len);
+
+    t_hash_key hkey = { .type = HASH_KEY_STR, .len = len, .val.s = key };
+    return ht_remove(ht, &hkey);
 }
 void *ht_remove_num(t_hash_table *ht, unsigned long key) {
-    t_hash_key *hkey = ht_key_create(HASH_KEY_NUM, (void *)key);
-    void *ret = ht_remove(ht, hkey);
-    ht_key_free(hkey);
-    return ret;
+    t_hash_key hkey = { .type = HASH_KEY_NUM, .val.n = key };
+    return ht_remove(ht, &hkey);
 }
 void *ht_remove_obj(t_hash_table *ht, t_object *key) {
-    t_hash_key *hkey = ht_key_create(HASH_KEY_OBJ, key);
-    void *ret = ht_remove(ht, hkey);
-    ht_key_free(hkey);
-    return ret;
+    t_hash_key hkey = { .type = HASH_KEY_OBJ, .val.o = key };
+    return ht_remove(ht, &hkey);
 }
 
 /*
@@ -279,7 +278,8 @@ void *ht_remove_obj(t_hash_table *ht, t_object *key) {
 int ht_iter_init(t_hash_iter *iter, t_hash_table *ht) {
     iter->ht = ht;
     iter->bucket_idx = 0;
-    iter->bucket = ht ? ht->head : NULL;
+    iter->bucket = NULL;
+    if (ht) ht->hashfuncs->iter_rewind(iter);
     return 1;
 }
 
@@ -296,7 +296,8 @@ int ht_iter_rewind(t_hash_iter *iter, t_hash_table *ht) {
     if (ht != NULL) iter->ht = ht;
 
     iter->bucket_idx = 0;
-    iter->bucket = ht->head;
+    iter->bucket = NULL;
+    iter->ht->hashfuncs->iter_rewind(iter);
 
     return 1;
 }
@@ -305,61 +306,71 @@ int ht_iter_rewind(t_hash_iter *iter, t_hash_table *ht) {
  * Return 0 when iterator is not valid (no more elements)
  */
 int ht_iter_valid(t_hash_iter *iter) {
-    return (iter->bucket != NULL);
+    if (iter->ht == NULL) return 0;
+    return iter->ht->hashfuncs->iter_fetch(iter, NULL, NULL);
 }
 
 /**
- * Goto next element (either inside the bucket, or the next bucket)
+ * Goto next element
  */
 int ht_iter_next(t_hash_iter *iter) {
     // Nothing found (or no more items)
-    if (iter->bucket == NULL) return 0;
+    if (! ht_iter_valid(iter)) return 0;
 
-    iter->bucket = iter->bucket->next_element;
-    return (iter->bucket != NULL);
+    iter->ht->hashfuncs->iter_next(iter);
+    return ht_iter_valid(iter);
 }
 
 /**
  * Fetch key from current element
  */
 t_hash_key *ht_iter_key(t_hash_iter *iter) {
-    if (iter->bucket == NULL) return NULL;
-    return iter->bucket->key;
+    t_hash_key *key;
+    if (iter->ht == NULL || ! iter->ht->hashfuncs->iter_fetch(iter, &key, NULL)) return NULL;
+    return key;
 }
 
 char *ht_iter_key_str(t_hash_iter *iter) {
-    if (iter->bucket == NULL) return NULL;
-    return iter->bucket->key->val.s;
+    t_hash_key *key = ht_iter_key(iter);
+    return key ? key->val.s : NULL;
 }
 
 unsigned long ht_iter_key_num(t_hash_iter *iter) {
-    if (iter->bucket == NULL) return NULL;
-    return iter->bucket->key->val.n;
+    t_hash_key *key = ht_iter_key(iter);
+    return key ? key->val.n : 0;
 }
 
 t_object *ht_iter_key_obj(t_hash_iter *iter) {
-    if (iter->bucket == NULL) return NULL;
-    return iter->bucket->key->val.o;
+    t_hash_key *key = ht_iter_key(iter);
+    return key ? key->val.o : NULL;
 }
 
 /**
  * Fetch value from current element
  */
 void *ht_iter_value(t_hash_iter *iter) {
-    if (iter->bucket == NULL) return NULL;
-    return iter->bucket->value;
+    void *value;
+    if (iter->ht == NULL || ! iter->ht->hashfuncs->iter_fetch(iter, NULL, &value)) return NULL;
+    return value;
 }
 
 
 /**
- *
+ * Creates a new key. Interned strings (names and constants) are used as-is and can be compared by address, other
+ * strings are copied and owned by the key.
  */
 t_hash_key *ht_key_create(int type, void *val) {
-    t_hash_key *hk = (t_hash_key *)malloc(sizeof(t_hash_key));
+    t_hash_key *hk = (t_hash_key *)smm_malloc(sizeof(t_hash_key));
     switch (type) {
         case HASH_KEY_STR :
             hk->type = HASH_KEY_STR;
-            hk->val.s = string_strdup0((char *)val);
+            if (string_is_interned((char *)val)) {
+                hk->val.s = (char *)val;
+                hk->len = string_intern_strlen(hk->val.s);
+            } else {
+                hk->val.s = string_strdup0((char *)val);
+                hk->len = strlen(hk->val.s);
+            }
             break;
         case HASH_KEY_NUM :
             hk->type = HASH_KEY_NUM;
@@ -379,28 +390,83 @@ t_hash_key *ht_key_create(int type, void *val) {
  * Create copy of a key
  */
 t_hash_key *ht_key_copy(t_hash_key *org) {
-    t_hash_key *cpy = (t_hash_key *)malloc(sizeof(t_hash_key));
+    t_hash_key *cpy = (t_hash_key *)smm_malloc(sizeof(t_hash_key));
     memcpy(cpy, org, sizeof(t_hash_key));
 
-    if (cpy->type == HASH_KEY_STR) {
+    // Interned strings are shared, all others are owned by the key
+    if (cpy->type == HASH_KEY_STR && ! string_is_interned(cpy->val.s)) {
         cpy->val.s = string_strdup0(org->val.s);
     }
     return cpy;
 }
 
+/**
+ * Frees the string owned by a key, but not the key structure itself
+ */
+void ht_key_free_value(t_hash_key *hk) {
+    if (hk->type == HASH_KEY_STR && ! string_is_interned(hk->val.s)) {
+        smm_free(hk->val.s);
+    }
+}
+
 /**
  * Free hash key
  */
 void ht_key_free(t_hash_key *hk) {
     if (!hk) return;
 
-    if (hk->type == HASH_KEY_STR) {
-        smm_free(hk->val.s);
-    }
+    ht_key_free_value(hk);
     smm_free(hk);
 }
 
 
+/**
+ * Returns the hash of a key
+ */
+hash_t ht_key_hash(t_hash_table *ht, t_hash_key *key) {
+    hash_t hash_value = 0;
+    if (! ht) return 0;      // Not a hash table
+
+    switch (key->type) {
+        case HASH_KEY_STR :
+            // Interned strings have their hash precomputed
+            if (string_is_interned(key->val.s)) {
+                hash_value = string_intern_hash(key->val.s);
+            } else {
+                hash_value = hash_native_len(key->val.s, key->len);
+            }
+            break;
+        case HASH_KEY_NUM :
+            hash_value = key->val.n;
+            break;
+        case HASH_KEY_OBJ :
+            hash_value = object_get_hash((t_object *)(key->val.o));
+            break;
+    }
+
+    return hash_value;
+}
+
+/**
+ * Returns 1 when both keys are equal. Interned string keys match by address.
+ */
+int ht_key_equals(t_hash_key *key1, t_hash_key *key2) {
+    if (key1->type != key2->type) return 0;
+
+    switch (key1->type) {
+        case HASH_KEY_STR :
+            if (key1->val.s == key2->val.s) return 1;
+            return key1->len == key2->len && memcmp(key1->val.s, key2->val.s, key1->len) == 0;
+        case HASH_KEY_NUM :
+            return key1->val.n == key2->val.n;
+        case HASH_KEY_OBJ :
+            return object_hash_equals((t_object *)(key1->val.o), (t_object *)(key2->val.o));
+    }
+
+    return 0;
+}
+
+
 #ifdef __DEBUG
 
 void ht_debug(t_hash_table *ht) {
@@ -0,0 +1,241 @@
+/*
+ Copyright (c) 2012-2013, The Saffire Group
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+     * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+     * Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in the
+       documentation and/or other materials provided with the distribution.
+     * Neither the name of the Saffire Group the
+       names of its contributors may be used to endorse or promote products
+       derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include <string.h>
+#include "general/intern.h"
+#include "general/hashtable.h"
+#include "general/hash/hash_funcs.h"
+#include "general/smm.h"
+
+
+// Size of the first chunk of interned strings. Large strings get a chunk of their own.
+#define INTERN_CHUNK_SIZE       (64 * 1024)
+
+// Initial number of slots in the intern table (must be a power of 2)
+#define INTERN_INITIAL_SLOTS    1024
+
+
+typedef struct _intern_entry {
+    hash_t hash;                    // Hash of the string (same as hash_native() would return)
+    size_t len;                     // Length of the string, without the trailing \0
+    char s[];                       // Actual string
+} t_intern_entry;
+
+typedef struct _intern_chunk {
+    struct _intern_chunk *next;     // Next chunk
+    char *pos;                      // First free byte in this chunk
+    char *end;                      // End of this chunk
+    char data[];                    // Interned entries
+} t_intern_chunk;
+
+#define INTERN_ENTRY(s)     ((t_intern_entry *)((char *)(s) - offsetof(t_intern_entry, s)))
+
+
+static t_intern_chunk *chunks = NULL;           // Chunks holding the entries, current chunk first
+static t_intern_entry **entries = NULL;         // Open addressing table with all entries
+static unsigned int entries_size = 0;
+static unsigned int entries_count = 0;
+
+
+/**
+ * Returns the slot where the given string is stored, or where it should be stored when it is not interned yet.
+ */
+static t_intern_entry **_intern_find_slot(const char *s, size_t len, hash_t hash) {
+    unsigned int mask = entries_size - 1;
+    unsigned int idx = hash & mask;
+
+    while (entries[idx]) {
+        t_intern_entry *entry = entries[idx];
+        if (entry->hash == hash && entry->len == len && memcmp(entry->s, s, len) == 0) break;
+        idx = (idx + 1) & mask;
+    }
+
+    return &entries[idx];
+}
+
+
+/**
+ * Resizes the intern table and reinserts all entries
+ */
+static void _intern_resize(unsigned int new_size) {
+    t_intern_entry **old_entries = entries;
+    unsigned int old_size = entries_size;
+
+    entries = smm_zalloc(sizeof(t_intern_entry *) * new_size);
+    entries_size = new_size;
+
+    for (int i=0; i!=old_size; i++) {
+        if (! old_entries[i]) continue;
+
+        unsigned int idx = old_entries[i]->hash & (new_size - 1);
+        while (entries[idx]) idx = (idx + 1) & (new_size - 1);
+        entries[idx] = old_entries[i];
+    }
+
+    if (old_entries) smm_free(old_entries);
+}
+
+
+/**
+ * Allocates room for a new entry of a string with the given length
+ */
+static t_intern_entry *_intern_alloc(size_t len) {
+    size_t size = offsetof(t_intern_entry, s) + len + 1;
+    size = (size + sizeof(hash_t) - 1) & ~(sizeof(hash_t) - 1);
+
+    t_intern_chunk *chunk = chunks;
+    if (! chunk || chunk->pos + size > chunk->end) {
+        // Every chunk is twice the size of the previous one, so string_is_interned() only has a few chunks to check
+        size_t chunk_size = chunks ? (chunks->end - chunks->data) * 2 : INTERN_CHUNK_SIZE;
+        int large = size > chunk_size / 4;
+        if (large) chunk_size = size;
+
+        chunk = smm_malloc(sizeof(t_intern_chunk) + chunk_size);
+        chunk->pos = chunk->data;
+        chunk->end = chunk->data + chunk_size;
+
+        if (chunks && large) {
+            // A large string gets its own chunk, so keep filling the current one
+            chunk->next = chunks->next;
+            chunks->next = chunk;
+        } else {
+            chunk->next = chunks;
+            chunks = chunk;
+        }
+    }
+
+    t_intern_entry *entry = (t_intern_entry *)chunk->pos;
+    chunk->pos += size;
+
+    return entry;
+}
+
+
+/**
+ * Returns the interned version of the (binary safe) string s with the given length. The interned string is always
+ * \0-terminated.
+ */
+char *string_intern_len(const char *s, size_t len) {
+    if (! entries) _intern_resize(INTERN_INITIAL_SLOTS);
+
+    hash_t hash = hash_native_len(s, len);
+    t_intern_entry **slot = _intern_find_slot(s, len, hash);
+    if (*slot) return (*slot)->s;
+
+    t_intern_entry *entry = _intern_alloc(len);
+    entry->hash = hash;
+    entry->len = len;
+    memcpy(entry->s, s, len);
+    entry->s[len] = '\0';
+    *slot = entry;
+
+    // Keep the table at most half full
+    if (++entries_count * 2 > entries_size) {
+        _intern_resize(entries_size * 2);
+    }
+
+    return entry->s;
+}
+
+
+/**
+ * Returns the interned version of string s. When s is already interned, it is returned as-is.
+ */
+char *string_intern(const char *s) {
+    if (string_is_interned(s)) return (char *)s;
+
+    return string_intern_len(s, strlen(s));
+}
+
+
+/**
+ * Returns the interned version of string s, or NULL when s has never been interned.
+ */
+char *string_intern_find(const char *s) {
+    if (string_is_interned(s)) return (char *)s;
+    if (! entries) return NULL;
+
+    size_t len = strlen(s);
+    t_intern_entry *entry = *_intern_find_slot(s, len, hash_native_len(s, len));
+
+    return entry ? entry->s : NULL;
+}
+
+
+/**
+ * Returns 1 when s points to an interned string, without having to look at the string itself.
+ */
+int string_is_interned(const char *s) {
+    // Interned strings always start on an aligned address
+    if ((unsigned long)s & (sizeof(hash_t) - 1)) return 0;
+
+    for (t_intern_chunk *chunk = chunks; chunk; chunk = chunk->next) {
+        if (s < chunk->data + offsetof(t_intern_entry, s) || s >= chunk->pos) continue;
+
+        // s could still point into the middle of an interned string, so make sure the entry is actually known
+        t_intern_entry *entry = INTERN_ENTRY(s);
+        unsigned int mask = entries_size - 1;
+        for (unsigned int idx = entry->hash & mask; entries[idx]; idx = (idx + 1) & mask) {
+            if (entries[idx] == entry) return 1;
+        }
+        return 0;
+    }
+
+    return 0;
+}
+
+
+/**
+ * Returns the precomputed hash of an interned string
+ */
+hash_t string_intern_hash(const char *s) {
+    return INTERN_ENTRY(s)->hash;
+}
+
+
+/**
+ * Returns the length of an interned string
+ */
+size_t string_intern_strlen(const char *s) {
+    return INTERN_ENTRY(s)->len;
+}
+
+
+/**
+ * Frees all interned strings. Any interned string that is still referenced will be invalid afterwards.
+ */
+void string_intern_fini(void) {
+    while (chunks) {
+        t_intern_chunk *next = chunks->next;
+        smm_free(chunks);
+        chunks = next;
+    }
+
+    if (entries) smm_free(entries);
+    entries = NULL;
+    entries_size = 0;
+    entries_count = 0;
+}
@@ -25,19 +25,220 @@
  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 #include <stdio.h>
+#include <stdint.h>
 #include <string.h>
 #include <malloc.h>
 #include "general/output.h"
 #include "general/hashtable.h"
 #include "general/smm.h"
+#include "debug.h"
 
 
-// @TODO: Fix this into a better/faster memory manager (slab allocator)
-
 long smm_malloc_calls = 0;
 long smm_realloc_calls = 0;
 long string_strdup_calls = 0;
 
+
+#ifdef __SMM_SLAB
+
+/*
+ * Small allocations are served from per-size-class free lists. When a free list runs dry, a new slab is allocated
+ * and carved up into blocks of that class. Every block is preceded by a tag that holds a magic value and the class
+ * it belongs to, so smm_free() and smm_realloc() know where to return it. Allocations that are too large for any
+ * class are tagged as well, but go straight to malloc(). The tag sits at the end of a 16 byte header, so blocks
+ * keep the same 16 byte alignment that malloc() guarantees.
+ *
+ * Memory that was not handed out by us (realpath(), strdup() etc) does not carry the magic and is passed on to the
+ * system allocator. Slabs are never returned to the system, freed blocks are reused for the same class instead.
+ */
+
+#define SMM_SLAB_SIZE           (64 * 1024)     // Size of a single slab
+
+#define SMM_TAG_MAGIC           0x5AFF5AFF00000000ULL
+#define SMM_TAG_MAGIC_MASK      0xFFFFFFFF00000000ULL
+#define SMM_TAG_CLASS_MASK      0x00000000000000FFULL
+
+#define SMM_CLASS_LARGE         0xFF            // Allocation is not served from a slab
+#define SMM_CLASS_COUNT         10
+#define SMM_MAX_SMALL_SIZE      256             // Largest allocation that is served from a slab
+
+#define SMM_HEADER_SIZE         16              // Room in front of every block. The tag is stored in the last 8 bytes
+
+#define SMM_TAG(ptr)            (((uint64_t *)(ptr))[-1])
+#define SMM_BLOCK_BASE(ptr)     ((char *)(ptr) - SMM_HEADER_SIZE)
+
+typedef struct _smm_free_block {
+    struct _smm_free_block *next;
+} t_smm_free_block;
+
+typedef struct _smm_class {
+    size_t size;                // Size of the blocks in this class (without tag)
+    t_smm_free_block *free;     // Free list
+    long allocs;                // Number of allocations from this class
+    long frees;                 // Number of frees into this class
+    long in_use;                // Number of blocks currently in use
+    long peak;                  // Maximum number of blocks in use
+    long slabs;                 // Number of slabs allocated for this class
+} t_smm_class;
+
+static t_smm_class smm_classes[SMM_CLASS_COUNT] = {
+    { 16 }, { 32 }, { 48 }, { 64 }, { 80 }, { 96 }, { 128 }, { 160 }, { 192 }, { 256 }
+};
+
+// Maps (size + 15) / 16 onto the smallest class that can hold that size
+static const unsigned char smm_size_to_class[(SMM_MAX_SMALL_SIZE / 16) + 1] = {
+    0, 0, 1, 2, 3, 4, 5, 6, 6, 7, 7, 8, 8, 9, 9, 9, 9
+};
+
+static long smm_large_allocs = 0;
+static long smm_foreign_frees = 0;
+
+
+/**
+ * Allocates a new slab for the given class and adds its blocks to the free list
+ */
+static void _smm_slab_refill(t_smm_class *cls, int idx) {
+    size_t block_size = SMM_HEADER_SIZE + cls->size;
+    int count = SMM_SLAB_SIZE / block_size;
+
+    char *slab = malloc(SMM_SLAB_SIZE);
+    if (slab == NULL) {
+        fatal_error(1, "Error while allocating memory (%lu bytes)!\n", (unsigned long)SMM_SLAB_SIZE);        /* LCOV_EXCL_LINE */
+    }
+    cls->slabs++;
+
+    // Add blocks back to front, so they are handed out in address order
+    for (int i = count - 1; i >= 0; i--) {
+        t_smm_free_block *block = (t_smm_free_block *)(slab + (i * block_size) + SMM_HEADER_SIZE);
+        SMM_TAG(block) = SMM_TAG_MAGIC | idx;
+
+        block->next = cls->free;
+        cls->free = block;
+    }
+}
+
+void *smm_malloc(size_t size) {
+    smm_malloc_calls++;
+
+    if (size > SMM_MAX_SMALL_SIZE) {
+        char *base = malloc(SMM_HEADER_SIZE + size);
+        if (base == NULL) {
+            fatal_error(1, "Error while allocating memory (%lu bytes)!\n", (unsigned long)size);        /* LCOV_EXCL_LINE */
+        }
+        SMM_TAG(base + SMM_HEADER_SIZE) = SMM_TAG_MAGIC | SMM_CLASS_LARGE;
+        smm_large_allocs++;
+        return base + SMM_HEADER_SIZE;
+    }
+
+    int idx = smm_size_to_class[(size + 15) >> 4];
+    t_smm_class *cls = &smm_classes[idx];
+    if (cls->free == NULL) {
+        _smm_slab_refill(cls, idx);
+    }
+
+    t_smm_free_block *block = cls->free;
+    cls->free = block->next;
+
+    cls->allocs++;
+    cls->in_use++;
+    if (cls->in_use > cls->peak) cls->peak = cls->in_use;
+
+    return block;
+}
+
+void *smm_zalloc(size_t size) {
+    void *p = smm_malloc(size);
+    bzero(p, size);
+    return p;
+}
+
+void *smm_realloc(void *ptr, size_t size) {
+    smm_realloc_calls++;
+
+    if (ptr == NULL) {
+        return smm_malloc(size);
+    }
+
+    uint64_t tag = SMM_TAG(ptr);
+
+    // Not allocated by us, let the system handle it
+    if ((tag & SMM_TAG_MAGIC_MASK) != SMM_TAG_MAGIC) {
+        void *newptr = realloc(ptr, size);
+        if (newptr == NULL) {
+            fatal_error(1, "Error while reallocating memory (%lu bytes)!\n", (unsigned long)size);      /* LCOV_EXCL_LINE */
+        }
+        return newptr;
+    }
+
+    int idx = tag & SMM_TAG_CLASS_MASK;
+    size_t copy_size = size;
+
+    if (idx == SMM_CLASS_LARGE) {
+        // Large blocks that stay large can be resized in place by the system
+        if (size > SMM_MAX_SMALL_SIZE) {
+            char *base = realloc(SMM_BLOCK_BASE(ptr), SMM_HEADER_SIZE + size);
+            if (base == NULL) {
+                fatal_error(1, "Error while reallocating memory (%lu bytes)!\n", (unsigned long)size);      /* LCOV_EXCL_LINE */
+            }
+            return base + SMM_HEADER_SIZE;
+        }
+    } else {
+        // The current block is still large enough
+        if (size <= smm_classes[idx].size) {
+            return ptr;
+        }
+        copy_size = smm_classes[idx].size;
+    }
+
+    void *newptr = smm_malloc(size);
+    memcpy(newptr, ptr, copy_size);
+    smm_free(ptr);
+    return newptr;
+}
+
+void smm_free(void *ptr) {
+    if (ptr == NULL) return;
+
+    uint64_t tag = SMM_TAG(ptr);
+
+    // Not allocated by us, let the system handle it
+    if ((tag & SMM_TAG_MAGIC_MASK) != SMM_TAG_MAGIC) {
+        smm_foreign_frees++;
+        free(ptr);
+        return;
+    }
+
+    int idx = tag & SMM_TAG_CLASS_MASK;
+    if (idx == SMM_CLASS_LARGE) {
+        free(SMM_BLOCK_BASE(ptr));
+        return;
+    }
+
+    t_smm_class *cls = &smm_classes[idx];
+    t_smm_free_block *block = (t_smm_free_block *)ptr;
+    block->next = cls->free;
+    cls->free = block;
+
+    cls->frees++;
+    cls->in_use--;
+}
+
+/**
+ * Displays allocation statistics per size class
+ */
+void smm_debug_stats(void) {
+    DEBUG_PRINT_CHAR("Memory: %ld malloc calls, %ld realloc calls\n", smm_malloc_calls, smm_realloc_calls);
+    DEBUG_PRINT_CHAR("  %6s %10s %10s %10s %10s %6s\n", "size", "allocs", "frees", "in use", "peak", "slabs");
+    for (int i = 0; i != SMM_CLASS_COUNT; i++) {
+        DEBUG_PRINT_CHAR("  %6lu %10ld %10ld %10ld %10ld %6ld\n", (unsigned long)smm_classes[i].size, smm_classes[i].allocs,
+                         smm_classes[i].frees, smm_classes[i].in_use, smm_classes[i].peak, smm_classes[i].slabs);
+    }
+    DEBUG_PRINT_CHAR("  %6s %10ld\n", "large", smm_large_allocs);
+    DEBUG_PRINT_CHAR("  %6s %10s %10ld\n", "system", "", smm_foreign_frees);
+}
+
+#else
+
 void *smm_malloc(size_t size) {
     smm_malloc_calls++;
     void *ptr = malloc(size);
@@ -65,3 +266,12 @@ void *smm_realloc(void *ptr, size_t size) {
 void smm_free(void *ptr) {
     return free(ptr);
 }
+
+/**
+ * Displays allocation statistics
+ */
+void smm_debug_stats(void) {
+    DEBUG_PRINT_CHAR("Memory: %ld malloc calls, %ld realloc calls\n", smm_malloc_calls, smm_realloc_calls);
+}
+
+#endif
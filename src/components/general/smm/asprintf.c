@@ -53,6 +53,7 @@ int smm_vasprintf_string(t_string **ret, t_string *format, va_list args) {
     *ret = string_new();
     (*ret)->val = tmp;
     (*ret)->len = len;
+    (*ret)->flags = string_scan_flags(tmp, len);
     return (*ret)->len;
 }
 
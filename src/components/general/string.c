@@ -26,11 +26,91 @@
 */
 #include <stdio.h>
 #include <string.h>
+#include <stdint.h>
+#ifdef __SSE2__
+    #include <emmintrin.h>
+#endif
 
 #include "general/string.h"
 #include "general/smm.h"
 
 
+/**
+ * Returns the length of the leading ASCII part of the string
+ */
+static size_t _ascii_prefix_len(const char *s, size_t len) {
+    size_t i = 0;
+
+#ifdef __SSE2__
+    // Check 16 bytes at once: the top bit of every byte ends up in the mask
+    for (; i + 16 <= len; i += 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)(s + i));
+        if (_mm_movemask_epi8(chunk)) break;
+    }
+#else
+    for (; i + sizeof(uint64_t) <= len; i += sizeof(uint64_t)) {
+        uint64_t chunk;
+        memcpy(&chunk, s + i, sizeof(uint64_t));
+        if (chunk & 0x8080808080808080ULL) break;
+    }
+#endif
+
+    while (i < len && (unsigned char)s[i] < 0x80) i++;
+    return i;
+}
+
+/**
+ * Returns 1 when the string is well-formed UTF-8 (no overlong forms, surrogates or code points above U+10FFFF)
+ */
+static int _utf8_is_valid(const unsigned char *s, size_t len) {
+    size_t i = 0;
+
+    while (i < len) {
+        unsigned char c = s[i];
+
+        if (c < 0x80) {
+            i++;
+            continue;
+        }
+
+        size_t count;
+        unsigned char lo = 0x80, hi = 0xBF;     // Allowed range of the second byte
+        if (c >= 0xC2 && c <= 0xDF) {
+            count = 1;
+        } else if (c >= 0xE0 && c <= 0xEF) {
+            count = 2;
+            if (c == 0xE0) lo = 0xA0;
+            if (c == 0xED) hi = 0x9F;
+        } else if (c >= 0xF0 && c <= 0xF4) {
+            count = 3;
+            if (c == 0xF0) lo = 0x90;
+            if (c == 0xF4) hi = 0x8F;
+        } else {
+            return 0;
+        }
+
+        if (len - i <= count) return 0;
+        if (s[i+1] < lo || s[i+1] > hi) return 0;
+        for (size_t j=2; j <= count; j++) {
+            if ((s[i+j] & 0xC0) != 0x80) return 0;
+        }
+        i += count + 1;
+    }
+
+    return 1;
+}
+
+/**
+ * Returns the STRING_FLAG_* flags for the given characters
+ */
+int string_scan_flags(const char *s, size_t len) {
+    size_t ascii_len = _ascii_prefix_len(s, len);
+    if (ascii_len == len) return STRING_FLAG_ASCII | STRING_FLAG_UTF8;
+
+    return _utf8_is_valid((const unsigned char *)s + ascii_len, len - ascii_len) ? STRING_FLAG_UTF8 : 0;
+}
+
+
 /**
  *
  */
@@ -48,6 +128,7 @@ t_string *char_to_string(const char *s, size_t len) {
     memcpy(str->val, s, len);
     *(str->val + len) = '\0';
     str->len = len;
+    str->flags = string_scan_flags(s, len);
 
     return str;
 }
@@ -78,6 +159,7 @@ t_string *string_new(void) {
     str->val = NULL;
     str->len = 0;
     str->unicode = NULL;
+    str->flags = STRING_FLAG_ASCII | STRING_FLAG_UTF8;
     return str;
 }
 
@@ -95,6 +177,7 @@ t_string *string_strdup(t_string *s) {
     str->val = (char *)smm_malloc(s->len+1);    // 0 zerminated
     memcpy(str->val, s->val, s->len+1);
     str->len = s->len;
+    str->flags = s->flags;
 
     return str;
 
@@ -113,18 +196,65 @@ t_string *string_strcat(t_string *dst, const t_string *src) {
     dst->val[dst->len + src->len] = '\0';
     dst->len += src->len;
 
+    // Joining two valid strings keeps them valid. Only malformed strings could become valid UTF-8 at the boundary.
+    if (STRING_IS_UTF8(dst) && STRING_IS_UTF8(src)) {
+        dst->flags &= src->flags;
+    } else {
+        dst->flags = string_scan_flags(dst->val, dst->len);
+    }
+
     return dst;
 
 }
 
 
+/**
+ * Joins count strings, with an optional separator between them, into a new string. The total length is calculated
+ * up front, so the result is allocated only once.
+ */
+t_string *string_join(const t_string *sep, t_string **parts, size_t count) {
+    size_t len = 0;
+    int flags = STRING_FLAG_ASCII | STRING_FLAG_UTF8;
+
+    for (size_t i=0; i!=count; i++) {
+        len += parts[i]->len;
+        flags &= parts[i]->flags;
+    }
+    if (sep && count > 1) {
+        len += sep->len * (count - 1);
+        flags &= sep->flags;
+    }
+
+    t_string *dst = string_new();
+    dst->val = (char *)smm_malloc(len + 1);
+
+    char *p = dst->val;
+    for (size_t i=0; i!=count; i++) {
+        if (sep && i > 0) {
+            memcpy(p, sep->val, sep->len);
+            p += sep->len;
+        }
+        memcpy(p, parts[i]->val, parts[i]->len);
+        p += parts[i]->len;
+    }
+    *p = '\0';
+    dst->len = len;
+
+    // Same as string_strcat(): only when all parts are valid UTF-8, we know the result is as well.
+    dst->flags = (flags & STRING_FLAG_UTF8) ? flags : string_scan_flags(dst->val, dst->len);
+
+    return dst;
+}
+
+
 int string_strcmp(t_string *s1, t_string *s2) {
     int res, len = s1->len;
     if (len > s2->len) len = s2->len;
 
     res = memcmp(s1->val, s2->val, len);
-    if (! res) return res;
+    if (res) return res;
 
+    if (s1->len == s2->len) return 0;
     return s1->len > s2->len ? 1 : -1;
 }
 
@@ -142,6 +272,7 @@ t_string *string_copy_partial(t_string *src, int offset, int count) {
     dst->val = smm_malloc(count+1);
     memcpy(dst->val, (char *)(src->val + offset), count);
     dst->val[count] = '\0';
+    dst->flags = STRING_IS_ASCII(src) ? STRING_FLAG_ASCII | STRING_FLAG_UTF8 : string_scan_flags(dst->val, count);
 
     return dst;
 }
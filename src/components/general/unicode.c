@@ -30,6 +30,7 @@
 #include "general/string.h"
 #include "objects/objects.h"
 #include "general/smm.h"
+#include "general/intern.h"
 #include "general/output.h"
 
 // Our default converter (@TODO: what about reading from other converters like utf16 etc??)
@@ -56,6 +57,7 @@ UChar *utf8_from_string(t_string *str) {
 
     // Create unicode from string, and store this in string
     str->unicode = (UChar *)smm_malloc(sizeof(UChar) * (str->len + 1));
+    str->unicode[str->len] = 0;
     u_uastrncpy(str->unicode, str->val, str->len);
 
     return str->unicode;
@@ -112,24 +114,56 @@ t_string *utf8_to_string(UChar *str, size_t len) {
 //    return bytes;
 //}
 
+/**
+ * Returns 1 when needle is found inside the haystack.
+ *
+ * UTF-8 is self-synchronizing, so on valid UTF-8 a byte match is always a match on character boundaries, and we
+ * can search the bytes directly. Only malformed strings are converted to unicode first.
+ */
 int utf8_strstr(t_string *haystack, t_string *needle) {
-    utf8_from_string(haystack);
-    utf8_from_string(needle);
-
-    return (u_strstr(haystack->unicode, needle->unicode) != NULL);
+    if (! STRING_IS_UTF8(haystack) || ! STRING_IS_UTF8(needle)) {
+        utf8_from_string(haystack);
+        utf8_from_string(needle);
+
+        return (u_strstr(haystack->unicode, needle->unicode) != NULL);
+    }
+
+    if (needle->len == 0) return 1;
+    if (needle->len > haystack->len) return 0;
+
+    // Find the first byte of the needle, and only compare the rest on a hit
+    const char *p = haystack->val;
+    const char *last = haystack->val + haystack->len - needle->len;
+    while (p <= last) {
+        p = memchr(p, needle->val[0], last - p + 1);
+        if (! p) return 0;
+        if (memcmp(p + 1, needle->val + 1, needle->len - 1) == 0) return 1;
+        p++;
+    }
+
+    return 0;
 }
 
 /**
+ * Compares two strings in code point order.
  *
+ * Byte order of valid UTF-8 is the same as its code point order, so those are compared with memcmp(). Only
+ * malformed strings are converted to unicode first.
  */
 int utf8_strcmp(t_string *s1, t_string *s2) {
-    int res, len = s1->len;
-    if (len > s2->len) len = s2->len;
+    int res;
+
+    if (! STRING_IS_UTF8(s1) || ! STRING_IS_UTF8(s2)) {
+        utf8_from_string(s1);
+        utf8_from_string(s2);
 
-    utf8_from_string(s1);
-    utf8_from_string(s2);
+        return u_strCompare(s1->unicode, -1, s2->unicode, -1, 1);    // Code point order
+    }
 
-    if ((res = u_memcmp(s1->unicode, s2->unicode, len))) return res;
+    size_t len = s1->len < s2->len ? s1->len : s2->len;
+    if ((res = memcmp(s1->val, s2->val, len))) return res;
+
+    if (s1->len == s2->len) return 0;
     return s1->len > s2->len ? 1 : -1;
 }
 
@@ -169,38 +203,117 @@ int utf8_strcmp(t_string *s1, t_string *s2) {
 //}
 
 
+// ucasemap_utf8ToUpper() or ucasemap_utf8ToLower()
+typedef int32_t (*t_casemap_func)(const UCaseMap *, char *, int32_t, const char *, int32_t, UErrorCode *);
+
 /**
- *
+ * Changes the case of a string through the case mapping of the locale. The conversion works directly on the UTF-8
+ * bytes, and the result can be longer than the source (for instance, the german sharp s becomes "SS").
  */
-t_string *utf8_toupper(t_string *src, char *locale) {
+static t_string *_utf8_change_case(t_string *src, t_locale *locale, t_casemap_func func) {
     UErrorCode status = U_ZERO_ERROR;
+    UCaseMap *casemap = utf8_locale_casemap(locale);
+
+    int32_t capacity = src->len + 1;
+    char *buf = (char *)smm_malloc(capacity);
+    int32_t len = func(casemap, buf, capacity, src->val, src->len, &status);
+
+    if (status == U_BUFFER_OVERFLOW_ERROR) {
+        // Result did not fit, and ICU has told us how much room it needs
+        status = U_ZERO_ERROR;
+        capacity = len + 1;
+        buf = (char *)smm_realloc(buf, capacity);
+        len = func(casemap, buf, capacity, src->val, src->len, &status);
+    }
+
+    t_string *dst = U_FAILURE(status) ? string_strdup(src) : char_to_string(buf, len);
+    smm_free(buf);
+    return dst;
+}
 
-    utf8_from_string(src);
+/**
+ * Returns a new uppercased string
+ */
+t_string *utf8_toupper(t_string *src, t_locale *locale) {
+    return _utf8_change_case(src, locale, ucasemap_utf8ToUpper);
+}
 
-    // Convert the unicode string
-    UChar *u_str = (UChar *)smm_malloc(sizeof(UChar) * (src->len + 1));
-    u_strToUpper(u_str, src->len+1, src->unicode, src->len, locale, &status);
 
-    t_string *dst = utf8_to_string(u_str, src->len);
-    return dst;
+/**
+ * Returns a new lowercased string
+ */
+t_string *utf8_tolower(t_string *src, t_locale *locale) {
+    return _utf8_change_case(src, locale, ucasemap_utf8ToLower);
 }
 
 
-/**
- *
+/* ======================================================================
+ *   Locales
+ * ======================================================================
  */
-t_string *utf8_tolower(t_string *src, char *locale) {
-    UErrorCode status = U_ZERO_ERROR;
 
-    utf8_from_string(src);
+static t_locale *locales = NULL;            // All locales handed out so far
+static UCaseMap *default_casemap = NULL;    // Case mapping for strings without a locale
 
-    // Convert the unicode string
-    UChar *u_str = (UChar *)smm_malloc(sizeof(UChar) * (src->len + 1));
-    u_strToLower(u_str, src->len, src->unicode, src->len, locale, &status);
+/**
+ * Returns the shared handle for a locale, or NULL when no locale is given. Handles are owned by the registry and
+ * live until utf8_locale_fini(), so they can be shared by any number of strings without reference counting.
+ */
+t_locale *utf8_locale(const char *name) {
+    if (! name) return NULL;
+
+    // Locale names are interned, so known locales can be found by address
+    char *interned = string_intern(name);
+    for (t_locale *locale = locales; locale; locale = locale->next) {
+        if (locale->name == interned) return locale;
+    }
+
+    t_locale *locale = (t_locale *)smm_malloc(sizeof(t_locale));
+    locale->name = interned;
+    locale->casemap = NULL;
+    locale->next = locales;
+    locales = locale;
+
+    return locale;
+}
 
-    t_string *dst = utf8_to_string(u_str, src->len);
-    return dst;
+/**
+ * Returns the name of a locale, or NULL when there is no locale
+ */
+char *utf8_locale_name(t_locale *locale) {
+    return locale ? locale->name : NULL;
 }
 
+/**
+ * Returns the ICU case mapping of the locale. It is created on first use, and reused afterwards.
+ */
+UCaseMap *utf8_locale_casemap(t_locale *locale) {
+    UCaseMap **casemap = locale ? &locale->casemap : &default_casemap;
+    if (*casemap) return *casemap;
+
+    UErrorCode status = U_ZERO_ERROR;
+    *casemap = ucasemap_open(locale ? locale->name : NULL, 0, &status);
+    if (U_FAILURE(status)) {
+        fatal_error(1, "Cannot create case mapping for locale '%s': %s\n", locale ? locale->name : "default", u_errorName(status));      /* LCOV_EXCL_LINE */
+    }
 
+    return *casemap;
+}
 
+/**
+ * Frees all locale handles
+ */
+void utf8_locale_fini(void) {
+    while (locales) {
+        t_locale *locale = locales;
+        locales = locale->next;
+
+        if (locale->casemap) ucasemap_close(locale->casemap);
+        smm_free(locale);
+    }
+
+    if (default_casemap) {
+        ucasemap_close(default_casemap);
+        default_casemap = NULL;
+    }
+}
@@ -0,0 +1,147 @@
+/*
+ Copyright (c) 2012-2013, The Saffire Group
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+     * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+     * Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in the
+       documentation and/or other materials provided with the distribution.
+     * Neither the name of the Saffire Group the
+       names of its contributors may be used to endorse or promote products
+       derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include <string.h>
+#include "general/vector.h"
+#include "general/smm.h"
+
+#define VECTOR_MIN_CAPACITY     8
+
+
+/**
+ * Initialize an empty vector
+ */
+t_vector *vector_init(void) {
+    t_vector *v = (t_vector *)smm_malloc(sizeof(t_vector));
+
+    v->size = 0;
+    v->capacity = 0;
+    v->elements = NULL;
+    return v;
+}
+
+/**
+ * Initialize a vector with 'size' elements, all set to NULL
+ */
+t_vector *vector_init_size(long size) {
+    t_vector *v = vector_init();
+
+    if (size > 0) {
+        vector_reserve(v, size);
+        memset(v->elements, 0, size * sizeof(void *));
+        v->size = size;
+    }
+    return v;
+}
+
+/**
+ * Free a vector (assumes data in elements are already freed)
+ */
+void vector_free(t_vector *v) {
+    if (v->elements) smm_free(v->elements);
+    smm_free(v);
+}
+
+/**
+ * Make sure the vector can hold at least 'capacity' elements without growing
+ */
+void vector_reserve(t_vector *v, long capacity) {
+    if (capacity <= v->capacity) return;
+
+    v->elements = smm_realloc(v->elements, capacity * sizeof(void *));
+    v->capacity = capacity;
+}
+
+/**
+ * Grows the vector so 'extra' elements can be added. The capacity doubles, so appending is amortised O(1).
+ */
+static void _vector_grow(t_vector *v, long extra) {
+    long needed = v->size + extra;
+    if (needed <= v->capacity) return;
+
+    long capacity = v->capacity ? v->capacity * 2 : VECTOR_MIN_CAPACITY;
+    while (capacity < needed) capacity *= 2;
+    vector_reserve(v, capacity);
+}
+
+/**
+ * Append an element to the end of the vector
+ */
+void vector_append(t_vector *v, void *data) {
+    if (v->size == v->capacity) _vector_grow(v, 1);
+
+    v->elements[v->size++] = data;
+}
+
+/**
+ * Append 'count' elements to the end of the vector
+ */
+void vector_append_all(t_vector *v, void **data, long count) {
+    if (count <= 0) return;
+
+    _vector_grow(v, count);
+    memcpy(v->elements + v->size, data, count * sizeof(void *));
+    v->size += count;
+}
+
+/**
+ * Returns the element at 'idx', or NULL when the index is out of range
+ */
+void *vector_get(t_vector *v, long idx) {
+    if (idx < 0 || idx >= v->size) return NULL;
+
+    return v->elements[idx];
+}
+
+/**
+ * Replaces the element at 'idx' and returns the previous element, or NULL when the index is out of range
+ */
+void *vector_set(t_vector *v, long idx, void *data) {
+    if (idx < 0 || idx >= v->size) return NULL;
+
+    void *old = v->elements[idx];
+    v->elements[idx] = data;
+    return old;
+}
+
+/**
+ * Swaps two elements. Indices must be in range.
+ */
+void vector_swap(t_vector *v, long idx1, long idx2) {
+    void *tmp = v->elements[idx1];
+    v->elements[idx1] = v->elements[idx2];
+    v->elements[idx2] = tmp;
+}
+
+/**
+ * Returns a shallow copy of the vector
+ */
+t_vector *vector_copy(t_vector *v) {
+    t_vector *copy = vector_init();
+
+    vector_append_all(copy, v->elements, v->size);
+    return copy;
+}
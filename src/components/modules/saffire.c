@@ -40,7 +40,7 @@
 
 SAFFIRE_MODULE_METHOD(saffire, get_locale) {
     t_thread *thread = thread_get_current();
-    RETURN_STRING_FROM_CHAR(thread->locale);
+    RETURN_STRING_FROM_CHAR(thread->locale ? thread->locale->name : "");
 
 }
 
@@ -51,9 +51,9 @@ SAFFIRE_MODULE_METHOD(saffire, set_locale) {
         return NULL;
     }
 
-    // Set locale
+    // Set locale. Locale handles are shared, so the previous locale does not need to be freed.
     t_thread *thread = thread_get_current();
-    thread->locale = string_strdup0(STROBJ2CHAR0(locale_obj));
+    thread->locale = utf8_locale(STROBJ2CHAR0(locale_obj));
 
     RETURN_SELF;
 }
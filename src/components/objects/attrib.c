@@ -31,6 +31,8 @@
 #include "objects/objects.h"
 #include "general/smm.h"
 #include "general/md5.h"
+#include "general/string.h"
+#include "general/intern.h"
 #include "debug.h"
 #include "general/dll.h"
 
@@ -60,9 +62,16 @@ t_attrib_object *object_attrib_duplicate(t_attrib_object *attrib, t_object *self
     DEBUG_PRINT_CHAR("duplicating attrib '%s.%s' to '%s.%s'\n", attrib->data.bound_class->name, attrib->data.bound_name, self->name, attrib->data.bound_name);
     t_attrib_object *dup = smm_malloc(sizeof(Object_Attrib_struct));
     memcpy(dup, attrib, sizeof(Object_Attrib_struct));
+    OBJECT_REGISTRY_CLEAR(dup);
+    OBJECT_GC_CLEAR(dup);
 
     dup->ref_count = 0;     // no references yet
 
+    // The duplicate owns its own references, just like the original attribute
+    object_inc_ref(dup->data.attribute);
+    object_inc_ref(dup->data.bound_class);
+    dup->data.bound_name = attrib->data.bound_name;
+
     // @TODO: So we keep a list of max 100 duplicated attributes. But we don't use it for caching, but just to make sure that our
     // attribute doesn't get eaten by the GC. Fix this into something a bit better...
 
@@ -70,7 +79,9 @@ t_attrib_object *object_attrib_duplicate(t_attrib_object *attrib, t_object *self
     object_inc_ref((t_object *)dup);    // increase reference count, so it's protected in this dll
     dll_append(dupped_attributes, dup);
     if (dupped_attributes->size > 100) {
-        t_object *old_dup = (t_object *)(DLL_HEAD(dupped_attributes))->data;
+        t_dll_element *e = DLL_HEAD(dupped_attributes);
+        t_object *old_dup = (t_object *)e->data;
+        dll_remove(dupped_attributes, e);
         object_release(old_dup);
     }
 
@@ -89,11 +100,15 @@ t_attrib_object *object_attrib_find(t_object *self, char *name) {
 
     if (! self) return NULL;
 
+    // Hash the name only once for the whole class hierarchy
+    size_t len;
+    hash_t hash = ht_hash_str(name, &len);
+
     while (attr == NULL) {
         DEBUG_PRINT_CHAR(">>> Finding attribute '%s' on object %s\n", name, cur_obj->name);
 
         // Find the attribute in the current object
-        attr = ht_find_str(cur_obj->attributes, name);
+        attr = ht_find_hashed(cur_obj->attributes, name, len, hash);
         if (attr != NULL) break;
 
         // Not found and there is no parent, we're done!
@@ -110,6 +125,18 @@ t_attrib_object *object_attrib_find(t_object *self, char *name) {
     return attr;
 }
 
+/**
+ * Replaces the value of an attribute. The attribute table itself stays untouched.
+ */
+void object_attrib_set_value(t_attrib_object *attrib, t_object *value) {
+    t_object *old_value = attrib->data.attribute;
+
+    attrib->data.attribute = value;
+    object_inc_ref(value);
+
+    object_release(old_value);
+}
+
 /* ======================================================================
  *   Supporting functions
  * ======================================================================
@@ -151,7 +178,7 @@ static void obj_populate(t_object *obj, t_dll *arg_list) {
     object_inc_ref(attrib_obj->data.bound_class);
 
     e = DLL_NEXT(e);
-    attrib_obj->data.bound_name = string_strdup0((char *)e->data);
+    attrib_obj->data.bound_name = string_intern((char *)e->data);
 
     e = DLL_NEXT(e);
     attrib_obj->data.attr_type = (long)e->data;
@@ -180,8 +207,22 @@ static void obj_free(t_object *obj) {
     // "free" the attribute object. decrease refcount
     object_release(attr_obj->data.attribute);
 
-    if (attr_obj->data.bound_name) {
-        smm_free(attr_obj->data.bound_name);
+    // Release the class and instance we are bound to
+    object_release(attr_obj->data.bound_class);
+    if (attr_obj->data.bound_instance) {
+        object_release(attr_obj->data.bound_instance);
+    }
+
+    // The bound name is interned, so it is not freed
+}
+
+static void obj_traverse(t_object *obj, void (*visit)(t_object *)) {
+    t_attrib_object *attr_obj = (t_attrib_object *)obj;
+
+    visit(attr_obj->data.attribute);
+    visit(attr_obj->data.bound_class);
+    if (attr_obj->data.bound_instance) {
+        visit(attr_obj->data.bound_instance);
     }
 }
 
@@ -217,6 +258,8 @@ t_object_funcs attrib_funcs = {
         NULL,                 // Clone
         NULL,                 // Cache
         NULL,                 // Hash
+        NULL,                 // Equals
+        obj_traverse,         // Traverse
 #ifdef __DEBUG
         obj_debug,
 #endif
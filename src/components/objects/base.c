@@ -64,7 +64,15 @@
  * Instantiation
  */
 SAFFIRE_METHOD(base, new) {
+    // Objects are populated through a DLL of arguments
+    t_dll *arguments = dll_init();
+    for (int i=0; i!=argc; i++) {
+        dll_append(arguments, argv[i]);
+    }
+
     t_object *obj = object_alloca((t_object *)self, arguments);
+
+    dll_free(arguments);
     RETURN_OBJECT(obj);
 }
 
@@ -255,6 +263,8 @@ t_object_funcs base_funcs = {
         NULL,                 // Clone
         NULL,                 // Object cache
         NULL,             // Hash
+        NULL,             // Equals
+        NULL,             // Traverse
 #ifdef __DEBUG
         obj_debug,
 #endif
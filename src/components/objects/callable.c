@@ -86,7 +86,7 @@ SAFFIRE_METHOD(callable, internal) {
 //SAFFIRE_METHOD(callable, bind) {
 //    t_object *newbound_obj;
 //
-//    if (! object_parse_arguments(SAFFIRE_METHOD_ARGS, "u",  &newbound_obj)) {
+//    if (! object_parse_argv(SAFFIRE_METHOD_ARGV, "u",  &newbound_obj)) {
 //        return NULL;
 //    }
 //
@@ -244,6 +244,8 @@ t_object_funcs callable_funcs = {
         NULL,                 // Clone
         NULL,                 // Cache
         NULL,                 // Hash
+        NULL,                 // Equals
+        NULL,                 // Traverse
 #ifdef __DEBUG
         obj_debug
 #endif
@@ -40,7 +40,7 @@ SAFFIRE_METHOD(exception, ctor) {
     t_string_object *msg_obj;
     t_numerical_object *code_obj;
 
-    if (! object_parse_arguments(SAFFIRE_METHOD_ARGS, "s|n",  (t_object *)&msg_obj, (t_object *)&code_obj)) {
+    if (! object_parse_argv(SAFFIRE_METHOD_ARGV, "s|n",  (t_object *)&msg_obj, (t_object *)&code_obj)) {
         return NULL;
     }
 
@@ -75,7 +75,7 @@ SAFFIRE_METHOD(exception, getmessage) {
 SAFFIRE_METHOD(exception, setmessage) {
     t_string_object *message;
 
-    if (! object_parse_arguments(SAFFIRE_METHOD_ARGS, "s", &message)) {
+    if (! object_parse_argv(SAFFIRE_METHOD_ARGV, "s", &message)) {
         object_raise_exception(Object_ArgumentException, 1, "error while parsing argument list");
         return NULL;
     }
@@ -91,7 +91,7 @@ SAFFIRE_METHOD(exception, getcode) {
 SAFFIRE_METHOD(exception, setcode) {
     t_numerical_object *code;
 
-    if (! object_parse_arguments(SAFFIRE_METHOD_ARGS, "n", &code)) {
+    if (! object_parse_argv(SAFFIRE_METHOD_ARGV, "n", &code)) {
         return NULL;
     }
 
@@ -112,7 +112,7 @@ SAFFIRE_METHOD(exception, setcode) {
 SAFFIRE_COMPARISON_METHOD(exception, eq) {
     t_exception_object *other;
 
-    if (! object_parse_arguments(SAFFIRE_METHOD_ARGS, "o",  &other)) {
+    if (! object_parse_argv(SAFFIRE_METHOD_ARGV, "o",  &other)) {
         return NULL;
     }
 
@@ -122,7 +122,7 @@ SAFFIRE_COMPARISON_METHOD(exception, eq) {
 SAFFIRE_COMPARISON_METHOD(exception, ne) {
     t_exception_object *other;
 
-    if (! object_parse_arguments(SAFFIRE_METHOD_ARGS, "o",  &other)) {
+    if (! object_parse_argv(SAFFIRE_METHOD_ARGV, "o",  &other)) {
         return NULL;
     }
 
@@ -221,6 +221,8 @@ t_object_funcs exception_funcs = {
         NULL,               // Clone
         NULL,               // Cache
         NULL,               // Hash
+        NULL,               // Equals
+        NULL,               // Traverse
 #ifdef __DEBUG
         obj_debug
 #endif
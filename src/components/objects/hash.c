@@ -105,7 +105,7 @@ SAFFIRE_METHOD(hash, __hasNext) {
 SAFFIRE_METHOD(hash, populate) {
     t_hash_object *ht_obj;
 
-    if (! object_parse_arguments(SAFFIRE_METHOD_ARGS, "o",  (t_object *)&ht_obj)) {
+    if (! object_parse_argv(SAFFIRE_METHOD_ARGV, "o",  (t_object *)&ht_obj)) {
         return NULL;
     }
     if (! OBJECT_IS_HASH(ht_obj)) {
@@ -143,7 +143,7 @@ SAFFIRE_METHOD(hash, get) {
     t_object *key;
     t_object *default_value = NULL;
 
-    if (! object_parse_arguments(SAFFIRE_METHOD_ARGS, "o|o", &key, &default_value)) {
+    if (! object_parse_argv(SAFFIRE_METHOD_ARGV, "o|o", &key, &default_value)) {
         return NULL;
     }
 
@@ -156,17 +156,19 @@ SAFFIRE_METHOD(hash, get) {
  *
  */
 SAFFIRE_METHOD(hash, keys) {
-    t_hash_table *ht = ht_create();
+    t_vector *vector = vector_init();
+    vector_reserve(vector, self->data.ht->element_count);
 
     t_hash_iter iter;
     ht_iter_init(&iter, self->data.ht);
     while (ht_iter_valid(&iter)) {
         t_object *key = (t_object *)ht_iter_key_obj(&iter);
-        ht_add_num(ht, ht->element_count, (t_object *)key);
+        vector_append(vector, key);
+        object_inc_ref(key);
         ht_iter_next(&iter);
     }
 
-    RETURN_LIST(ht);
+    RETURN_LIST(vector);
 }
 
 
@@ -176,7 +178,7 @@ SAFFIRE_METHOD(hash, keys) {
 SAFFIRE_METHOD(hash, has) {
     t_object *key;
 
-    if (! object_parse_arguments(SAFFIRE_METHOD_ARGS, "o", &key)) {
+    if (! object_parse_argv(SAFFIRE_METHOD_ARGV, "o", &key)) {
         return NULL;
     }
 
@@ -194,7 +196,7 @@ SAFFIRE_METHOD(hash, has) {
 SAFFIRE_METHOD(hash, add) {
     t_object *key, *val;
 
-    if (! object_parse_arguments(SAFFIRE_METHOD_ARGS, "oo", &key, &val)) {
+    if (! object_parse_argv(SAFFIRE_METHOD_ARGV, "oo", &key, &val)) {
         return NULL;
     }
 
@@ -213,7 +215,7 @@ SAFFIRE_METHOD(hash, add) {
 SAFFIRE_METHOD(hash, remove) {
     t_object *key;
 
-    if (! object_parse_arguments(SAFFIRE_METHOD_ARGS, "o", &key)) {
+    if (! object_parse_argv(SAFFIRE_METHOD_ARGV, "o", &key)) {
         return NULL;
     }
 
@@ -417,6 +419,22 @@ static void obj_free(t_object *obj) {
     ht_destroy(hash_obj->data.ht);
 }
 
+static void obj_traverse(t_object *obj, void (*visit)(t_object *)) {
+    t_hash_object *hash_obj = (t_hash_object *)obj;
+    if (! hash_obj->data.ht) return;
+
+    t_hash_iter iter;
+    ht_iter_init(&iter, hash_obj->data.ht);
+    while (ht_iter_valid(&iter)) {
+        t_hash_key *key = ht_iter_key(&iter);
+        if (key->type == HASH_KEY_OBJ) {
+            visit(key->val.o);
+        }
+        visit(ht_iter_value(&iter));
+        ht_iter_next(&iter);
+    }
+}
+
 static void obj_destroy(t_object *obj) {
     smm_free(obj);
 }
@@ -443,6 +461,8 @@ t_object_funcs hash_funcs = {
         NULL,                 // Clone
         NULL,                 // Cache
         NULL,                 // Hash
+        NULL,                 // Equals
+        obj_traverse,         // Traverse
 #ifdef __DEBUG
         obj_debug
 #endif
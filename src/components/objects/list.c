@@ -31,6 +31,7 @@
 #include "objects/object.h"
 #include "objects/objects.h"
 #include "general/smm.h"
+#include "general/vector.h"
 #include "general/md5.h"
 #include "debug.h"
 #include "general/output.h"
@@ -67,7 +68,7 @@ SAFFIRE_METHOD(list, dtor) {
  * Saffire method: Returns the number of elements stored inside the list
  */
 SAFFIRE_METHOD(list, length) {
-    RETURN_NUMERICAL(self->data.ht->element_count);
+    RETURN_NUMERICAL(self->data.vector->size);
 }
 
 SAFFIRE_METHOD(list, __iterator) {
@@ -77,7 +78,7 @@ SAFFIRE_METHOD(list, __key) {
     RETURN_NUMERICAL(self->data.iter.idx);
 }
 SAFFIRE_METHOD(list, __value) {
-    t_object *obj = ht_find_num(self->data.ht, self->data.iter.idx);
+    t_object *obj = vector_get(self->data.vector, self->data.iter.idx);
     if (obj == NULL) RETURN_NULL;
     RETURN_OBJECT(obj);
 }
@@ -90,7 +91,7 @@ SAFFIRE_METHOD(list, __rewind) {
     RETURN_SELF;
 }
 SAFFIRE_METHOD(list, __hasNext) {
-    if (self->data.iter.idx < self->data.ht->element_count) {
+    if (self->data.iter.idx < self->data.vector->size) {
         RETURN_TRUE;
     }
     RETURN_FALSE;
@@ -103,11 +104,11 @@ SAFFIRE_METHOD(list, __hasNext) {
 SAFFIRE_METHOD(list, get) {
     t_numerical_object *key;
 
-    if (! object_parse_arguments(SAFFIRE_METHOD_ARGS, "n", &key)) {
+    if (! object_parse_argv(SAFFIRE_METHOD_ARGV, "n", &key)) {
         return NULL;
     }
 
-    t_object *obj = ht_find_num(self->data.ht, key->data.value);
+    t_object *obj = vector_get(self->data.vector, key->data.value);
     if (obj == NULL) RETURN_NULL;
     RETURN_OBJECT(obj);
 }
@@ -127,16 +128,9 @@ volatile int rdtscll() {
 SAFFIRE_METHOD(list, shuffle) {
     srand(rdtscll());
 
-    // The hashtable has a linked list, we shuffle this one as it is used during iteration
-    for (int i = self->data.ht->element_count-1; i >= 1; i--) {
-        /* because we are exchanging values, the keys can stay the same. We basically fetch the
-         * objects and swap them. */
-
-        int j = (rand () % i);
-        t_object *obj1 = ht_find_num(self->data.ht, i);
-        t_object *obj2 = ht_find_num(self->data.ht, j);
-        ht_replace_num(self->data.ht, i, obj2);
-        ht_replace_num(self->data.ht, j, obj1);
+    for (long i = self->data.vector->size-1; i >= 1; i--) {
+        long j = (rand () % i);
+        vector_swap(self->data.vector, i, j);
     }
     RETURN_SELF;
 }
@@ -145,7 +139,9 @@ SAFFIRE_METHOD(list, shuffle) {
   * Pick random element
   */
 SAFFIRE_METHOD(list, random) {
-    t_object *obj = ht_find_num(self->data.ht, (rand () % self->data.ht->element_count));
+    if (self->data.vector->size == 0) RETURN_NULL;
+
+    t_object *obj = vector_get(self->data.vector, (rand () % self->data.vector->size));
     if (obj == NULL) RETURN_NULL;
     RETURN_OBJECT(obj);
 }
@@ -156,11 +152,12 @@ SAFFIRE_METHOD(list, random) {
 SAFFIRE_METHOD(list, add) {
     t_object *val;
 
-    if (! object_parse_arguments(SAFFIRE_METHOD_ARGS, "o",  &val)) {
+    if (! object_parse_argv(SAFFIRE_METHOD_ARGV, "o",  &val)) {
         return NULL;
     }
 
-    ht_add_num(self->data.ht, self->data.ht->element_count, val);
+    vector_append(self->data.vector, val);
+    object_inc_ref(val);
     RETURN_SELF;
 }
 
@@ -172,7 +169,7 @@ SAFFIRE_METHOD(list, add) {
 SAFFIRE_METHOD(list, populate) {
     t_hash_object *ht_obj;
 
-    if (! object_parse_arguments(SAFFIRE_METHOD_ARGS, "o",  (t_object *)&ht_obj)) {
+    if (! object_parse_argv(SAFFIRE_METHOD_ARGV, "o",  (t_object *)&ht_obj)) {
         return NULL;
     }
     if (! OBJECT_IS_HASH(ht_obj)) {
@@ -180,14 +177,16 @@ SAFFIRE_METHOD(list, populate) {
         return NULL;
     }
 
-    if (! self->data.ht) {
-        self->data.ht = ht_create();
+    if (! self->data.vector) {
+        self->data.vector = vector_init();
     }
+    vector_reserve(self->data.vector, self->data.vector->size + ht_obj->data.ht->element_count);
 
     t_hash_iter iter;
     ht_iter_init(&iter, ht_obj->data.ht);
     while (ht_iter_valid(&iter)) {
-        ht_add_num(self->data.ht, self->data.ht->element_count, ht_iter_value(&iter));
+        vector_append(self->data.vector, ht_iter_value(&iter));
+        object_inc_ref(ht_iter_value(&iter));
         ht_iter_next(&iter);
     }
 
@@ -203,7 +202,7 @@ SAFFIRE_METHOD(list, sequence) {
     t_object *to;
     t_object *skip;
 
-    if (! object_parse_arguments(SAFFIRE_METHOD_ARGS, "oo|o",  &from, &to, &skip)) {
+    if (! object_parse_argv(SAFFIRE_METHOD_ARGV, "oo|o",  &from, &to, &skip)) {
         return NULL;
     }
 
@@ -229,7 +228,7 @@ SAFFIRE_METHOD(list, sequence) {
 
     t_list_object *list_obj = (t_list_object *)object_alloc(Object_List, 0);
     for (int i=((t_numerical_object *)from)->data.value; i<=((t_numerical_object *)to)->data.value; i+=((t_numerical_object *)skip)->data.value) {
-        ht_add_num(list_obj->data.ht, list_obj->data.ht->element_count, object_alloc(Object_Numerical, 1, i));
+        vector_append(list_obj->data.vector, object_alloc(Object_Numerical, 1, i));
     }
 
     RETURN_OBJECT(list_obj);
@@ -241,7 +240,7 @@ SAFFIRE_METHOD(list, sequence) {
  *
  */
 SAFFIRE_METHOD(list, conv_boolean) {
-    if (self->data.ht->element_count == 0) {
+    if (self->data.vector->size == 0) {
         RETURN_FALSE;
     } else {
         RETURN_TRUE;
@@ -259,7 +258,7 @@ SAFFIRE_METHOD(list, conv_null) {
  *
  */
 SAFFIRE_METHOD(list, conv_numerical) {
-    RETURN_NUMERICAL(self->data.ht->element_count);
+    RETURN_NUMERICAL(self->data.vector->size);
 }
 
 /**
@@ -268,7 +267,7 @@ SAFFIRE_METHOD(list, conv_numerical) {
 SAFFIRE_METHOD(list, conv_string) {
     char s[100];
 
-    snprintf(s, 99, "list[%d]", self->data.ht->element_count);
+    snprintf(s, 99, "list[%ld]", self->data.vector->size);
     RETURN_STRING_FROM_CHAR(s);
 }
 
@@ -353,25 +352,29 @@ static void obj_populate(t_object *obj, t_dll *arg_list) {
 
     // No arguments
     if (arg_list->size == 0) {
-        list_obj->data.ht = ht_create();
+        list_obj->data.vector = vector_init();
         return;
     }
 
     if (arg_list->size == 1) {
-        // Simple hash table. Direct copy
-        list_obj->data.ht = DLL_HEAD(arg_list)->data;
+        // Simple vector. Direct copy
+        list_obj->data.vector = DLL_HEAD(arg_list)->data;
         return;
     }
 
     // 2 (or higher). Use the DLL in arg2
-    list_obj->data.ht = ht_create();
     t_dll_element *e = DLL_HEAD(arg_list);
     e = DLL_NEXT(e);
     t_dll *dll = (t_dll *)e->data;
+
+    list_obj->data.vector = vector_init();
+    vector_reserve(list_obj->data.vector, dll->size);
+
     e = DLL_HEAD(dll);    // 2nd elementof the DLL is a DLL itself.. inception!
     while (e) {
         t_object *val = (t_object *)e->data;
-        ht_add_num(list_obj->data.ht, list_obj->data.ht->element_count, val);
+        vector_append(list_obj->data.vector, val);
+        object_inc_ref(val);
         e = DLL_NEXT(e);
     }
 }
@@ -380,8 +383,22 @@ static void obj_free(t_object *obj) {
     t_list_object *list_obj = (t_list_object *)obj;
     if (! list_obj) return;
 
-    if (list_obj->data.ht) {
-        ht_destroy(list_obj->data.ht);
+    if (list_obj->data.vector) {
+        // The list owns its elements
+        for (long i=0; i < list_obj->data.vector->size; i++) {
+            object_release(list_obj->data.vector->elements[i]);
+        }
+
+        vector_free(list_obj->data.vector);
+    }
+}
+
+static void obj_traverse(t_object *obj, void (*visit)(t_object *)) {
+    t_list_object *list_obj = (t_list_object *)obj;
+    if (! list_obj->data.vector) return;
+
+    for (long i=0; i < list_obj->data.vector->size; i++) {
+        visit(list_obj->data.vector->elements[i]);
     }
 }
 
@@ -395,8 +412,8 @@ static char *obj_debug(t_object *obj) {
     if (OBJECT_TYPE_IS_CLASS(obj)) {
         sprintf(global_buf, "List");
     } else {
-        t_hash_table *ht = ((t_list_object *)obj)->data.ht;
-        sprintf(global_buf, "list[%d]", ht ? ht->element_count : 0);
+        t_vector *vector = ((t_list_object *)obj)->data.vector;
+        sprintf(global_buf, "list[%ld]", vector ? vector->size : 0);
     }
     return global_buf;
 }
@@ -411,6 +428,8 @@ t_object_funcs list_funcs = {
         NULL,                 // Clone
         NULL,                 // Cache
         NULL,                 // Hash
+        NULL,                 // Equals
+        obj_traverse,         // Traverse
 #ifdef __DEBUG
         obj_debug
 #endif
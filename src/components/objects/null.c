@@ -53,7 +53,7 @@ SAFFIRE_METHOD(null, conv_string) {
 }
 
 SAFFIRE_COMPARISON_METHOD(null, ne) {
-    t_object* obj = DLL_HEAD(arguments)->data;
+    t_object* obj = argv[0];
 
     if(OBJECT_IS_NULL(obj)) {
         RETURN_FALSE;
@@ -115,6 +115,8 @@ t_object_funcs null_funcs = {
         NULL,               // Clone
         obj_cache,          // Cache
         NULL,               // Hash
+        NULL,               // Equals
+        NULL,               // Traverse
 #ifdef __DEBUG
         obj_debug
 #endif
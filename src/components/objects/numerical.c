@@ -112,7 +112,7 @@ SAFFIRE_METHOD(numerical, conv_string) {
 SAFFIRE_OPERATOR_METHOD(numerical, add) {
     t_numerical_object *other;
 
-    if (! object_parse_arguments(SAFFIRE_METHOD_ARGS, "n",  &other)) {
+    if (! object_parse_argv(SAFFIRE_METHOD_ARGV, "n",  &other)) {
         return NULL;
     }
 
@@ -122,7 +122,7 @@ SAFFIRE_OPERATOR_METHOD(numerical, add) {
 SAFFIRE_OPERATOR_METHOD(numerical, sub) {
     t_numerical_object *other;
 
-    if (! object_parse_arguments(SAFFIRE_METHOD_ARGS, "n",  &other)) {
+    if (! object_parse_argv(SAFFIRE_METHOD_ARGV, "n",  &other)) {
         return NULL;
     }
 
@@ -132,7 +132,7 @@ SAFFIRE_OPERATOR_METHOD(numerical, sub) {
 SAFFIRE_OPERATOR_METHOD(numerical, mul) {
     t_numerical_object *other;
 
-    if (! object_parse_arguments(SAFFIRE_METHOD_ARGS, "n",  &other)) {
+    if (! object_parse_argv(SAFFIRE_METHOD_ARGV, "n",  &other)) {
         return NULL;
     }
 
@@ -142,7 +142,7 @@ SAFFIRE_OPERATOR_METHOD(numerical, mul) {
 SAFFIRE_OPERATOR_METHOD(numerical, div) {
     t_numerical_object *other;
 
-    if (! object_parse_arguments(SAFFIRE_METHOD_ARGS, "n",  &other)) {
+    if (! object_parse_argv(SAFFIRE_METHOD_ARGV, "n",  &other)) {
         return NULL;
     }
 
@@ -157,7 +157,7 @@ SAFFIRE_OPERATOR_METHOD(numerical, div) {
 SAFFIRE_OPERATOR_METHOD(numerical, mod) {
     t_numerical_object *other;
 
-    if (! object_parse_arguments(SAFFIRE_METHOD_ARGS, "n",  &other)) {
+    if (! object_parse_argv(SAFFIRE_METHOD_ARGV, "n",  &other)) {
         return NULL;
     }
 
@@ -167,7 +167,7 @@ SAFFIRE_OPERATOR_METHOD(numerical, mod) {
 SAFFIRE_OPERATOR_METHOD(numerical, and) {
     t_numerical_object *other;
 
-    if (! object_parse_arguments(SAFFIRE_METHOD_ARGS, "n",  &other)) {
+    if (! object_parse_argv(SAFFIRE_METHOD_ARGV, "n",  &other)) {
         return NULL;
     }
 
@@ -177,7 +177,7 @@ SAFFIRE_OPERATOR_METHOD(numerical, and) {
 SAFFIRE_OPERATOR_METHOD(numerical, or) {
     t_numerical_object *other;
 
-    if (! object_parse_arguments(SAFFIRE_METHOD_ARGS, "n",  &other)) {
+    if (! object_parse_argv(SAFFIRE_METHOD_ARGV, "n",  &other)) {
         return NULL;
     }
 
@@ -187,7 +187,7 @@ SAFFIRE_OPERATOR_METHOD(numerical, or) {
 SAFFIRE_OPERATOR_METHOD(numerical, xor) {
     t_numerical_object *other;
 
-    if (! object_parse_arguments(SAFFIRE_METHOD_ARGS, "n",  &other)) {
+    if (! object_parse_argv(SAFFIRE_METHOD_ARGV, "n",  &other)) {
         return NULL;
     }
 
@@ -197,7 +197,7 @@ SAFFIRE_OPERATOR_METHOD(numerical, xor) {
 SAFFIRE_OPERATOR_METHOD(numerical, sl) {
     t_numerical_object *other;
 
-    if (! object_parse_arguments(SAFFIRE_METHOD_ARGS, "n",  &other)) {
+    if (! object_parse_argv(SAFFIRE_METHOD_ARGV, "n",  &other)) {
         return NULL;
     }
 
@@ -207,7 +207,7 @@ SAFFIRE_OPERATOR_METHOD(numerical, sl) {
 SAFFIRE_OPERATOR_METHOD(numerical, sr) {
     t_numerical_object *other;
 
-    if (! object_parse_arguments(SAFFIRE_METHOD_ARGS, "n",  &other)) {
+    if (! object_parse_argv(SAFFIRE_METHOD_ARGV, "n",  &other)) {
         return NULL;
     }
 
@@ -222,7 +222,7 @@ SAFFIRE_OPERATOR_METHOD(numerical, sr) {
 SAFFIRE_COMPARISON_METHOD(numerical, eq) {
     t_numerical_object *other;
 
-    if (! object_parse_arguments(SAFFIRE_METHOD_ARGS, "n",  &other)) {
+    if (! object_parse_argv(SAFFIRE_METHOD_ARGV, "n",  &other)) {
         return NULL;
     }
 
@@ -232,7 +232,7 @@ SAFFIRE_COMPARISON_METHOD(numerical, eq) {
 SAFFIRE_COMPARISON_METHOD(numerical, ne) {
     t_numerical_object *other;
 
-    if (! object_parse_arguments(SAFFIRE_METHOD_ARGS, "n",  &other)) {
+    if (! object_parse_argv(SAFFIRE_METHOD_ARGV, "n",  &other)) {
         return NULL;
     }
 
@@ -242,7 +242,7 @@ SAFFIRE_COMPARISON_METHOD(numerical, ne) {
 SAFFIRE_COMPARISON_METHOD(numerical, lt) {
     t_numerical_object *other;
 
-    if (! object_parse_arguments(SAFFIRE_METHOD_ARGS, "n",  &other)) {
+    if (! object_parse_argv(SAFFIRE_METHOD_ARGV, "n",  &other)) {
         return NULL;
     }
 
@@ -252,7 +252,7 @@ SAFFIRE_COMPARISON_METHOD(numerical, lt) {
 SAFFIRE_COMPARISON_METHOD(numerical, gt) {
     t_numerical_object *other;
 
-    if (! object_parse_arguments(SAFFIRE_METHOD_ARGS, "n",  &other)) {
+    if (! object_parse_argv(SAFFIRE_METHOD_ARGV, "n",  &other)) {
         return NULL;
     }
 
@@ -262,7 +262,7 @@ SAFFIRE_COMPARISON_METHOD(numerical, gt) {
 SAFFIRE_COMPARISON_METHOD(numerical, le) {
     t_numerical_object *other;
 
-    if (! object_parse_arguments(SAFFIRE_METHOD_ARGS, "n",  &other)) {
+    if (! object_parse_argv(SAFFIRE_METHOD_ARGV, "n",  &other)) {
         return NULL;
     }
 
@@ -272,7 +272,7 @@ SAFFIRE_COMPARISON_METHOD(numerical, le) {
 SAFFIRE_COMPARISON_METHOD(numerical, ge) {
     t_numerical_object *other;
 
-    if (! object_parse_arguments(SAFFIRE_METHOD_ARGS, "n",  &other)) {
+    if (! object_parse_argv(SAFFIRE_METHOD_ARGV, "n",  &other)) {
         return NULL;
     }
 
@@ -359,6 +359,16 @@ void object_numerical_fini(void) {
 }
 
 
+/**
+ * Returns a real numerical object for a tagged numerical. Any other object is returned as-is.
+ */
+t_object *object_numerical_box(t_object *obj) {
+    if (! OBJECT_IS_TAGGED(obj)) return obj;
+
+    return object_alloc(Object_Numerical, 1, TAGGED2NUM(obj));
+}
+
+
 /**
  * Clones a numerical object into a new object
  */
@@ -368,6 +378,8 @@ static t_object *obj_clone(t_object *obj) {
     // Create new object and copy all info
     t_numerical_object *new_obj = smm_malloc(sizeof(t_numerical_object));
     memcpy(new_obj, num_obj, sizeof(t_numerical_object));
+    OBJECT_REGISTRY_CLEAR(new_obj);
+    OBJECT_GC_CLEAR(new_obj);
 
     // New separated object, so refcount = 1
     new_obj->ref_count = 1;
@@ -388,10 +400,12 @@ static t_object *obj_cache(t_object *obj, t_dll *arg_list) {
     return NULL;
 }
 
-static char *obj_hash(t_object *obj) {
-    char *s = (char *)smm_malloc(32);
-    snprintf(s, 31, "%ld", ((t_numerical_object *)obj)->data.value);
-    return s;
+static hash_t obj_hash(t_object *obj) {
+    return (hash_t)((t_numerical_object *)obj)->data.value;
+}
+
+static int obj_equals(t_object *obj1, t_object *obj2) {
+    return ((t_numerical_object *)obj1)->data.value == ((t_numerical_object *)obj2)->data.value;
 }
 
 
@@ -430,6 +444,8 @@ t_object_funcs numerical_funcs = {
         NULL,               // Clone
         obj_cache,          // cache
         obj_hash,           // Hash
+        obj_equals,         // Equals
+        NULL,               // Traverse
 #ifdef __DEBUG
         obj_debug
 #endif
@@ -41,14 +41,47 @@
 #include "general/smm.h"
 #include "vm/thread.h"
 
-t_dll *all_objects;
+#ifdef __DEBUG
+static t_object *all_objects = NULL;        // Linked list of all allocated objects (through the object header)
+static long all_objects_count = 0;          // Number of objects inside the list
+
+/**
+ * Adds a newly allocated object to the list of all objects
+ */
+static void _object_register(t_object *obj) {
+    obj->registry_prev = NULL;
+    obj->registry_next = all_objects;
+    if (all_objects) all_objects->registry_prev = obj;
+    all_objects = obj;
+    all_objects_count++;
+}
+
+/**
+ * Removes an object from the list of all objects. Objects that are not allocated through _object_instantiate() are not
+ * registered, which we can detect since their neighbours don't point back to them.
+ */
+static void _object_deregister(t_object *obj) {
+    if (obj->registry_prev ? obj->registry_prev->registry_next != obj : all_objects != obj) return;
+
+    if (obj->registry_prev) {
+        obj->registry_prev->registry_next = obj->registry_next;
+    } else {
+        all_objects = obj->registry_next;
+    }
+    if (obj->registry_next) obj->registry_next->registry_prev = obj->registry_prev;
+
+    obj->registry_prev = obj->registry_next = NULL;
+    all_objects_count--;
+}
+#endif
 
 // @TODO: in_place: is this option really needed? (inplace modifications of object, like A++; or A = A + 2;)
 
 // Object type string constants
 const char *objectTypeNames[OBJECT_TYPE_LEN] = { "object", "callable", "attribute", "base", "boolean",
                                                  "null", "numerical", "regex", "string",
-                                                 "hash", "tuple", "user", "list", "exception" };
+                                                 "hash", "tuple", "user", "list", "exception",
+                                                 "stringbuilder" };
 
 // Object comparison methods. These should map on the COMPARISON_* defines
 const char *objectCmpMethods[9] = { "__cmp_eq", "__cmp_ne", "__cmp_lt", "__cmp_gt", "__cmp_le", "__cmp_ge",
@@ -109,41 +142,43 @@ static void _object_free(t_object *obj) {
 //    }
 //#endif
 
-    // Free values from the object
-    if (obj->funcs && obj->funcs->free) {
-        obj->funcs->free(obj);
-    }
+    object_free_values(obj);
+    object_destroy(obj);
+}
 
-    // Remove this object from the all_objects list
-    t_dll_element *e = DLL_HEAD(all_objects);
-    while (e) {
-        t_object *tmp = (t_object *)e->data;
 
-        if (tmp == obj) {
-            dll_remove(all_objects, e);
-            break;
-        }
-        e = DLL_NEXT(e);
+/**
+ * Frees the values from the object, but not the object itself
+ */
+void object_free_values(t_object *obj) {
+    // User objects use the functions of the class they extend, so they need to free their own values as well
+    if (OBJECT_IS_USER(obj)) {
+        object_user_free(obj);
     }
 
-
-    // Free the object
-    if (obj->funcs && obj->funcs->destroy) {
-        obj->funcs->destroy(obj);
+    if (obj->funcs && obj->funcs->free) {
+        obj->funcs->free(obj);
     }
-
-    // Object is destroyed. We cannot use object anymore.
-    obj = NULL;
+}
 
 
+/**
+ * Destroys an object which values are already freed. Don't use the object after this call!
+ */
+void object_destroy(t_object *obj) {
+#ifdef __DEBUG
+    // Remove this object from the all_objects list
+    _object_deregister(obj);
+#endif
 
-    // @TODO: here we should actually add the object to the GC destruction queue.
-    // If we need the object later, we can still catch it from this queue, otherwise it will
-    // be destroyed somewhere in the future.
+    // The object cannot be a cycle root anymore
+    gc_forget_root(obj);
 
-//    if (! gc_queue_add(obj) && obj->funcs && obj->funcs->destroy) {
-//        obj->funcs->destroy(obj);
-//    }
+    // Park the object in the recycle queue of its type, so _object_instantiate() can reuse it. When the type isn't
+    // recycled or the queue is full, destroy the object.
+    if (! gc_queue_add(obj) && obj->funcs && obj->funcs->destroy) {
+        obj->funcs->destroy(obj);
+    }
 }
 
 
@@ -151,7 +186,7 @@ static void _object_free(t_object *obj) {
  * Increase reference to object.
  */
 void object_inc_ref(t_object *obj) {
-    if (! obj) return;
+    if (! obj || OBJECT_IS_TAGGED(obj)) return;
 
     obj->ref_count++;
     if (OBJECT_IS_CALLABLE(obj) || OBJECT_IS_ATTRIBUTE(obj)) return;
@@ -163,7 +198,7 @@ void object_inc_ref(t_object *obj) {
  * Decrease reference from object.
  */
 long object_dec_ref(t_object *obj) {
-    if (! obj) return 0;
+    if (! obj || OBJECT_IS_TAGGED(obj)) return 0;
 
     obj->ref_count--;
 
@@ -171,7 +206,13 @@ long object_dec_ref(t_object *obj) {
 //        DEBUG_PRINT_CHAR("Decreased reference for: %s (%08lX) to %d\n", object_debug(obj), (unsigned long)obj, obj->ref_count);
 //    }
 
-    if (obj->ref_count != 0) return obj->ref_count;
+    if (obj->ref_count != 0) {
+        // A container that loses a reference but stays alive might only be kept alive by a cycle
+        if (GC_IS_CONTAINER(obj)) {
+            gc_possible_root(obj);
+        }
+        return obj->ref_count;
+    }
 
 #if __DEBUG_FREE_OBJECT
     DEBUG_PRINT_CHAR("*** Freeing object %s (%08lX)\n", object_debug(obj), (unsigned long)obj);
@@ -195,6 +236,11 @@ char global_debug_info[256];
 char *object_debug(t_object *obj) {
     if (! obj) return "(null)<0x0>";
 
+    if (OBJECT_IS_TAGGED(obj)) {
+        snprintf(global_debug_info, 255, "%s [I] (tagged %ld)", objectTypeNames[objectTypeNumerical], TAGGED2NUM(obj));
+        return global_debug_info;
+    }
+
     snprintf(global_debug_info, 255, "%s [%c] (%s)", objectTypeNames[obj->type], OBJECT_TYPE_IS_CLASS(obj) ? 'C' : 'I', obj->name);
     return global_debug_info;
 
@@ -242,9 +288,20 @@ t_object *object_clone(t_object *obj) {
  */
 static t_object *_object_instantiate(t_object *class_obj, t_dll *arguments) {
 
-    // Create new object
-    t_object *instance_obj = smm_malloc(sizeof(t_object) + class_obj->data_size);
+    // Reuse a previously freed object of the same type if possible, otherwise allocate a new one
+    t_object *instance_obj = gc_queue_recycle(class_obj->type);
+    if (instance_obj && instance_obj->data_size != class_obj->data_size) {
+        instance_obj->funcs->destroy(instance_obj);
+        instance_obj = NULL;
+    }
+    if (! instance_obj) {
+        instance_obj = smm_malloc(sizeof(t_object) + class_obj->data_size);
+    }
     memcpy(instance_obj, class_obj, sizeof(t_object) + class_obj->data_size);
+    OBJECT_GC_CLEAR(instance_obj);
+
+    // The instance starts with the shape of its class, but has no properties of its own yet
+    instance_obj->slots = NULL;
 
     // Since we just allocated the object, it can always be destroyed
     instance_obj->flags |= OBJECT_FLAG_ALLOCATED;
@@ -256,24 +313,48 @@ static t_object *_object_instantiate(t_object *class_obj, t_dll *arguments) {
     instance_obj->ref_count = 1;
     instance_obj->class = class_obj;
 
+    // Instances keep their (user) class alive
+    if (OBJECT_HAS_COUNTED_CLASS(instance_obj)) {
+        object_inc_ref(class_obj);
+    }
+
+#ifdef __DEBUG
     // We add 'res' to our list of generated objects.
-    dll_append(all_objects, instance_obj);
+    _object_register(instance_obj);
+#endif
 
     return instance_obj;
 }
 
-char *object_get_hash(t_object *obj) {
-    // When there is no hash function, we just use the address of the object
+/**
+ * Returns the hash of an object, as used for object keys inside hashtables.
+ */
+hash_t object_get_hash(t_object *obj) {
+    // When there is no hash function, we just use the (mixed) address of the object
     if (! obj->funcs->hash) {
-        char *tmp = (char *)smm_malloc(32);
-        snprintf(tmp, 31, "%ld", (long)obj);
-        return tmp;
+        hash_t h = (hash_t)obj;
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdUL;
+        h ^= h >> 33;
+        return h;
     }
 
     // Return objects hash
     return obj->funcs->hash(obj);
 }
 
+/**
+ * Returns 1 when both objects are equal as a hashtable key. Objects without an equals function are only equal to
+ * themselves.
+ */
+int object_hash_equals(t_object *obj1, t_object *obj2) {
+    if (obj1 == obj2) return 1;
+    if (obj1->type != obj2->type || obj1->funcs != obj2->funcs) return 0;
+    if (! obj1->funcs->equals) return 0;
+
+    return obj1->funcs->equals(obj1, obj2);
+}
+
 
 /**
  * Creates a new object with specific values, with a already created
@@ -336,15 +417,13 @@ t_object *object_new(t_object *obj, int arg_count, ...) {
 
 
 t_dll *dupped_attributes;
+unsigned long object_attrib_generation = 0;
 
 
 /**
  * Initialize all the (scalar) objects
  */
 void object_init() {
-    // All objects have a reference here (except dupped attributes, actually)
-    all_objects = dll_init();
-
     // All duplicated attributes are references here, because they are short-lived, we can do some other stuff with them later.
     dupped_attributes = dll_init();
 
@@ -362,6 +441,7 @@ void object_init() {
     object_tuple_init();
     object_list_init();
     object_exception_init();
+    object_stringbuilder_init();
 
     object_interfaces_init();
 }
@@ -388,6 +468,7 @@ void object_fini() {
 
     object_interfaces_fini();
 
+    object_stringbuilder_fini();
     object_exception_fini();
     object_list_fini();
     object_tuple_fini();
@@ -405,32 +486,25 @@ void object_fini() {
 
 #ifdef __DEBUG
     // We really can't show anything here, since objects should have been gone now. Expect failures
-    DEBUG_PRINT_CHAR("At object_fini(), we still have %ld objects left on the stack\n", all_objects->size);
-    e = DLL_HEAD(all_objects);
-    while (e) {
-        t_object *obj = (t_object *)e->data;
+    DEBUG_PRINT_CHAR("At object_fini(), we still have %ld objects left on the stack\n", all_objects_count);
+    for (t_object *obj = all_objects; obj; obj = obj->registry_next) {
         DEBUG_PRINT_CHAR("%-30s %08X %d\n", obj->name, (unsigned int)obj, obj->ref_count);
-        e = DLL_NEXT(e);
     }
-    dll_free(all_objects);
 #endif
 }
 
 
 /**
- *
+ * Parses the arguments from argv according to the speclist. Returns 0 (and throws an exception) when the arguments
+ * do not match.
  */
-int object_parse_arguments(t_dll *dll, const char *spec, ...) {
+static int _object_parse_arguments(t_object **argv, int argc, const char *spec, va_list storage_list) {
     const char *ptr = spec;
     int optional_argument = 0;
-    va_list storage_list;
     t_objectype_enum type;
-    int result = 0;
-
-    va_start(storage_list, spec);
 
-    // Point to first element
-    t_dll_element *e = DLL_HEAD(dll);
+    // Index of the first argument
+    int idx = 0;
 
     // First, check if the number of elements equals (or is more) than the number of mandatory objects in the spec
     int cnt = 0;
@@ -439,10 +513,9 @@ int object_parse_arguments(t_dll *dll, const char *spec, ...) {
         cnt++;
         ptr++;
     }
-    if (dll->size < cnt) {
-        object_raise_exception(Object_ArgumentException, 1, "Error while parsing argument list: at least %d arguments are needed. Only %ld are given", cnt, dll->size);
-        result = 0;
-        goto done;
+    if (argc < cnt) {
+        object_raise_exception(Object_ArgumentException, 1, "Error while parsing argument list: at least %d arguments are needed. Only %d are given", cnt, argc);
+        return 0;
     }
 
     // We know have have enough elements. Iterate the spec
@@ -475,42 +548,83 @@ int object_parse_arguments(t_dll *dll, const char *spec, ...) {
                 break;
             default :
                 object_raise_exception(Object_SystemException, 1, "Error while parsing argument list: cannot parse argument: '%c'", c);
-                result = 0;
-                goto done;
+                return 0;
                 break;
         }
 
         // Fetch the next object from the list. We must assume the user has added enough room
         t_object **storage_obj = va_arg(storage_list, t_object **);
-        if (optional_argument == 0 && (!e || !e->data)) {
+        t_object *argument_obj = idx < argc ? argv[idx] : NULL;
+        if (optional_argument == 0 && !argument_obj) {
             object_raise_exception(Object_ArgumentException, 1, "Error while fetching mandatory argument.");
-            result = 0;
-            goto done;
+            return 0;
         }
 
-        t_object *argument_obj = e ? e->data : NULL;
         if (argument_obj && type != objectTypeAny && type != argument_obj->type) {
             object_raise_exception(Object_ArgumentException, 1, "Error while parsing argument list: wanted a %s, but got a %s", objectTypeNames[type], objectTypeNames[argument_obj->type]);
-            result = 0;
-            goto done;
+            return 0;
         }
 
         // Copy this object to here
         *storage_obj = argument_obj;
 
         // Goto next element
-        e = e ? DLL_NEXT(e) : NULL;
+        idx++;
     }
 
     // Everything is ok
-    result = 1;
+    return 1;
+}
 
-    // General cleanup
-done:
+/**
+ * Parses the arguments of a builtin method
+ */
+int object_parse_argv(t_object **argv, int argc, const char *spec, ...) {
+    va_list storage_list;
+
+    va_start(storage_list, spec);
+    int result = _object_parse_arguments(argv, argc, spec, storage_list);
     va_end(storage_list);
+
     return result;
 }
 
+/**
+ * Parses the arguments of a module method
+ */
+int object_parse_arguments(t_dll *dll, const char *spec, ...) {
+    va_list storage_list;
+    t_object *argv[dll->size + 1];
+    int argc = 0;
+
+    t_dll_element *e = DLL_HEAD(dll);
+    while (e) {
+        argv[argc++] = e->data;
+        e = DLL_NEXT(e);
+    }
+
+    va_start(storage_list, spec);
+    int result = _object_parse_arguments(argv, argc, spec, storage_list);
+    va_end(storage_list);
+
+    return result;
+}
+
+/**
+ * Calls a module method, which still receives its arguments through a DLL.
+ */
+t_object *object_call_dll_method(t_object *self, t_object **argv, int argc, t_object *(*func)(t_object *, t_dll *)) {
+    t_dll *arguments = dll_init();
+    for (int i=0; i!=argc; i++) {
+        dll_append(arguments, argv[i]);
+    }
+
+    t_object *ret = func(self, arguments);
+
+    dll_free(arguments);
+    return ret;
+}
+
 
 /**
  * Adds interface to object (class)
@@ -542,6 +656,7 @@ void object_add_internal_method(t_object *obj, char *name, int method_flags, int
 
     ht_add_str(obj->attributes, name, attrib_obj);
     object_inc_ref((t_object *)attrib_obj);
+    object_attrib_generation++;
 }
 
 
@@ -555,6 +670,7 @@ void object_add_property(t_object *obj, char *name, int visibility, t_object *pr
 
     ht_replace_str(obj->attributes, name, attrib_obj);
     object_inc_ref((t_object *)attrib_obj);
+    object_attrib_generation++;
 }
 
 
@@ -573,6 +689,7 @@ void object_add_constant(t_object *obj, char *name, int visibility, t_object *co
 
     ht_add_str(obj->attributes, name, attrib_obj);
     object_inc_ref((t_object *)attrib_obj);
+    object_attrib_generation++;
 }
 
 
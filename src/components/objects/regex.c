@@ -35,6 +35,7 @@
 #include "objects/objects.h"
 #include "general/smm.h"
 #include "general/md5.h"
+#include "general/hash/hash_funcs.h"
 #include "debug.h"
 #include "general/output.h"
 
@@ -84,7 +85,7 @@ SAFFIRE_METHOD(regex, match) {
     int rc;
 
     // Parse the arguments
-    if (! object_parse_arguments(SAFFIRE_METHOD_ARGS, "s", &str)) {
+    if (! object_parse_argv(SAFFIRE_METHOD_ARGV, "s", &str)) {
         return NULL;
     }
 
@@ -292,10 +293,18 @@ static char *obj_debug(t_object *obj) {
 }
 #endif
 
-static char *obj_hash(t_object *obj) {
-    char *s;
-    smm_asprintf_char(&s, "%s%d", ((t_regex_object *)obj)->data.regex_string, ((t_regex_object *)obj)->data.regex_flags);
-    return s;
+static hash_t obj_hash(t_object *obj) {
+    t_regex_object *re_obj = (t_regex_object *)obj;
+
+    const char *regex = re_obj->data.regex_string;
+    return hash_native_len(regex, strlen(regex)) ^ (hash_t)re_obj->data.regex_flags;
+}
+
+static int obj_equals(t_object *obj1, t_object *obj2) {
+    t_regex_object *re1 = (t_regex_object *)obj1;
+    t_regex_object *re2 = (t_regex_object *)obj2;
+
+    return re1->data.regex_flags == re2->data.regex_flags && strcmp(re1->data.regex_string, re2->data.regex_string) == 0;
 }
 
 
@@ -307,6 +316,8 @@ t_object_funcs regex_funcs = {
         NULL,                 // Clone
         NULL,                 // Cache
         obj_hash,             // Hash
+        obj_equals,           // Equals
+        NULL,                 // Traverse
 #ifdef __DEBUG
         obj_debug
 #endif
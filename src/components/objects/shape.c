@@ -0,0 +1,131 @@
+/*
+ Copyright (c) 2012-2013, The Saffire Group
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+     * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+     * Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in the
+       documentation and/or other materials provided with the distribution.
+     * Neither the name of the Saffire Group the
+       names of its contributors may be used to endorse or promote products
+       derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "objects/object.h"
+#include "objects/shape.h"
+#include "general/hashtable.h"
+#include "general/smm.h"
+
+
+/**
+ * Creates a new (empty) root shape
+ */
+t_object_shape *object_shape_new(void) {
+    t_object_shape *shape = smm_malloc(sizeof(t_object_shape));
+
+    shape->parent = NULL;
+    shape->slot_count = 0;
+    shape->slots = ht_create();
+    shape->transitions = NULL;
+
+    return shape;
+}
+
+
+/**
+ * Frees a shape, and all shapes that are derived from it
+ */
+void object_shape_free(t_object_shape *shape) {
+    if (! shape) return;
+
+    if (shape->transitions) {
+        t_hash_iter iter;
+        ht_iter_init(&iter, shape->transitions);
+        while (ht_iter_valid(&iter)) {
+            object_shape_free((t_object_shape *)ht_iter_value(&iter));
+            ht_iter_next(&iter);
+        }
+        ht_destroy(shape->transitions);
+    }
+
+    ht_destroy(shape->slots);
+    smm_free(shape);
+}
+
+
+/**
+ * Returns the slot of a property, or -1 when the shape does not have this property
+ */
+int object_shape_find_slot(t_object_shape *shape, char *name) {
+    if (! shape) return -1;
+
+    return (long)ht_find_str(shape->slots, name) - 1;
+}
+
+
+/**
+ * Returns the shape with the property added. Shapes are reused, so objects that add the same properties in the same
+ * order end up with the same shape.
+ */
+static t_object_shape *_object_shape_transition(t_object_shape *shape, char *name) {
+    if (! shape->transitions) {
+        shape->transitions = ht_create();
+    }
+
+    t_object_shape *new_shape = ht_find_str(shape->transitions, name);
+    if (new_shape) return new_shape;
+
+    new_shape = object_shape_new();
+    new_shape->parent = shape;
+    new_shape->slot_count = shape->slot_count + 1;
+
+    t_hash_iter iter;
+    ht_iter_init(&iter, shape->slots);
+    while (ht_iter_valid(&iter)) {
+        ht_add_str(new_shape->slots, ht_iter_key_str(&iter), ht_iter_value(&iter));
+        ht_iter_next(&iter);
+    }
+    ht_add_str(new_shape->slots, name, (void *)(long)new_shape->slot_count);
+
+    ht_add_str(shape->transitions, name, new_shape);
+    return new_shape;
+}
+
+
+/**
+ * Adds a property to the object, and returns its slot. The slot is empty until object_shape_set_slot() is called.
+ */
+int object_shape_add_slot(t_object *obj, char *name) {
+    obj->shape = _object_shape_transition(obj->shape, name);
+
+    obj->slots = smm_realloc(obj->slots, obj->shape->slot_count * sizeof(t_object *));
+    obj->slots[obj->shape->slot_count - 1] = NULL;
+
+    return obj->shape->slot_count - 1;
+}
+
+
+/**
+ * Stores a value into a slot of the object. The object owns the values in its slots.
+ */
+void object_shape_set_slot(t_object *obj, int slot, t_object *value) {
+    t_object *old_value = obj->slots[slot];
+
+    obj->slots[slot] = value;
+    object_inc_ref(value);
+
+    if (old_value) object_release(old_value);
+}
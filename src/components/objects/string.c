@@ -34,49 +34,112 @@
 #include "objects/object.h"
 #include "objects/objects.h"
 #include "general/smm.h"
-#include "general/md5.h"
+#include "general/hash/hash_funcs.h"
 #include "general/output.h"
 #include "debug.h"
 #include "vm/thread.h"
 
+// Single character strings for the ASCII range, created on first use
+#define STRING_CACHED_CHARS     128
+
+t_string_object *string_char_cache[STRING_CACHED_CHARS];
+
 /* ======================================================================
  *   Supporting functions
  * ======================================================================
  */
 /**
- * Returns a byte[16] md5 hash of the given widestring
+ * Calculates the hash of the given string object
  */
 static void calculate_hash(t_string_object *str_obj) {
-    md5_state_t state;
-
-    md5_init(&state);
-    md5_append(&state, (md5_byte_t *)STROBJ2CHAR0(str_obj), STROBJ2CHAR0LEN(str_obj));
-    md5_finish(&state, str_obj->data.hash);
+    str_obj->data.hash = hash_native_len(STROBJ2CHAR0(str_obj), STROBJ2CHAR0LEN(str_obj));
 }
 
 
 static void string_change_locale(t_string_object *str_obj, char *locale) {
-    if (str_obj->data.locale) {
-        smm_free(str_obj->data.locale);
-    }
-    str_obj->data.locale = string_strdup0(locale);
+    str_obj->data.locale = utf8_locale(locale);
 }
 
-static t_string_object *string_create_new_object(t_string *str, char *locale) {
+static t_string_object *string_create_new_object(t_string *str, t_locale *locale) {
     t_string_object *uc_obj = (t_string_object *)object_alloc(Object_String, 0);
     uc_obj->data.value = str;
-    uc_obj->data.locale = string_strdup0(locale);
+    uc_obj->data.locale = locale;
 
     uc_obj->data.needs_hashing = 1;
 
     return uc_obj;
 }
 
-t_string *object_string_cat(t_string_object *s1, t_string_object *s2) {
-    t_string *dst = string_strdup(s1->data.value);
-    string_strcat(dst, s2->data.value);
+/**
+ * Creates a string object for the part of str_obj starting at offset. Since buffers are \0-terminated, only a part
+ * that runs up to the end of the string can share the buffer. The slice keeps the owner of the buffer alive.
+ */
+static t_string_object *string_create_slice(t_string_object *str_obj, size_t offset) {
+    t_string *dst = string_new();
+    dst->val = str_obj->data.value->val + offset;
+    dst->len = str_obj->data.value->len - offset;
+    dst->flags = STRING_IS_ASCII(str_obj->data.value) ? STRING_FLAG_ASCII | STRING_FLAG_UTF8 : string_scan_flags(dst->val, dst->len);
 
-    return dst;
+    // A slice of a slice refers to the original owner
+    t_object *owner = str_obj->data.owner ? str_obj->data.owner : (t_object *)str_obj;
+    object_inc_ref(owner);
+
+    t_string_object *slice_obj = string_create_new_object(dst, str_obj->data.locale);
+    slice_obj->data.owner = owner;
+    return slice_obj;
+}
+
+/**
+ * Returns the cached single character string for c, or NULL when c is not an ASCII character or the cached string
+ * has a different locale.
+ */
+static t_string_object *string_cached_char(char c, t_locale *locale) {
+    unsigned char idx = (unsigned char)c;
+    if (idx >= STRING_CACHED_CHARS) return NULL;
+
+    t_string_object *str_obj = string_char_cache[idx];
+    if (! str_obj) {
+        str_obj = smm_malloc(sizeof(t_string_object));
+        memcpy(str_obj, Object_String, sizeof(t_string_object));
+        OBJECT_REGISTRY_CLEAR(str_obj);
+        OBJECT_GC_CLEAR(str_obj);
+        str_obj->data.value = char_to_string(&c, 1);
+        str_obj->data.locale = locale;
+
+        // Immutable objects, and we don't allocate
+        str_obj->flags |= (OBJECT_FLAG_IMMUTABLE | OBJECT_FLAG_ALLOCATED);
+
+        // These are instances
+        str_obj->flags &= ~OBJECT_TYPE_MASK;
+        str_obj->flags |= OBJECT_TYPE_INSTANCE;
+
+        str_obj->ref_count = 1;
+        string_char_cache[idx] = str_obj;
+    }
+
+    // Strings carry their locale, so only hand out the cached string when it matches
+    if (str_obj->data.locale != locale) return NULL;
+
+    return str_obj;
+}
+
+/**
+ * Returns the character at offset of str_obj as a string object
+ */
+static t_object *string_char_at(t_string_object *str_obj, long offset) {
+    t_string_object *cached_obj = string_cached_char(str_obj->data.value->val[offset], str_obj->data.locale);
+    if (cached_obj) {
+        object_inc_ref((t_object *)cached_obj);
+        return (t_object *)cached_obj;
+    }
+
+    t_string *dst = string_copy_partial(str_obj->data.value, offset, 1);
+    return (t_object *)string_create_new_object(dst, str_obj->data.locale);
+}
+
+t_string *object_string_cat(t_string_object *s1, t_string_object *s2) {
+    t_string *parts[2] = { s1->data.value, s2->data.value };
+    return string_join(NULL, parts, 2);
 }
 
 int object_string_compare(t_string_object *s1, t_string_object *s2) {
@@ -88,32 +151,21 @@ int object_string_compare(t_string_object *s1, t_string_object *s2) {
  * ======================================================================
  */
 
-
- int object_string_hash_compare(t_string_object *s1, t_string_object *s2) {
-    int c = 0;
-
-    // Do a complete hash check to counter timing attacks
-    for (int i=0; i!=16; i++) {
-        c += (s1->data.hash[i] ^ s2->data.hash[i]);
-    }
-    return (c == 0);
- }
-
 /**
  * Saffire method: constructor
  */
 SAFFIRE_METHOD(string, ctor) {
     t_string_object *str_obj, *locale_obj;
-    if (! object_parse_arguments(SAFFIRE_METHOD_ARGS, "s|s", &str_obj, &locale_obj)) {
+    if (! object_parse_argv(SAFFIRE_METHOD_ARGV, "s|s", &str_obj, &locale_obj)) {
         return NULL;
     }
 
     self->data.value = string_strdup(str_obj->data.value);
     if (locale_obj) {
-        self->data.locale = string_to_char(locale_obj->data.value);
+        self->data.locale = utf8_locale(STROBJ2CHAR0(locale_obj));
     } else {
         t_thread *thread = thread_get_current();
-        self->data.locale = thread->locale ? string_strdup0(thread->locale) : NULL;
+        self->data.locale = thread->locale;
     }
     RETURN_SELF;
 }
@@ -167,6 +219,7 @@ SAFFIRE_METHOD(string, reverse) {
         dst->val[i] = self->data.value->val[dst->len - i];
     }
     utf8_free_unicode(dst);
+    dst->flags = string_scan_flags(dst->val, dst->len);
 
     t_string_object *obj = string_create_new_object(dst, self->data.locale);
     RETURN_OBJECT(obj);
@@ -210,11 +263,10 @@ SAFFIRE_METHOD(string, conv_string) {
  *
  */
 SAFFIRE_METHOD(string, splice) {
-    // @TODO: We probably want to just change the length and the offset of the t_string. Not doing any real copies
     t_object *min_obj;
     t_object *max_obj;
 
-    if (! object_parse_arguments(SAFFIRE_METHOD_ARGS, "oo", &min_obj, &max_obj)) {
+    if (! object_parse_argv(SAFFIRE_METHOD_ARGV, "oo", &min_obj, &max_obj)) {
         return NULL;
     }
 
@@ -226,6 +278,7 @@ SAFFIRE_METHOD(string, splice) {
     // Below 0, means we have to seek from the end of the string
     if (min < 0) min = self->data.value->len + min - 1;
     if (max < 0) max = self->data.value->len + max - 1;
+    if (min < 0) min = 0;
 
     if (min > self->data.value->len) min = self->data.value->len;
     if (max > self->data.value->len || max == 0) max = self->data.value->len;
@@ -243,6 +296,14 @@ SAFFIRE_METHOD(string, splice) {
         return NULL;
     }
 
+    // Slices up to the end of the string share its buffer, single characters come from the cache
+    if (min + new_size >= self->data.value->len) {
+        if (min == 0) RETURN_SELF;
+        RETURN_OBJECT(string_create_slice(self, min));
+    }
+    if (new_size == 1) {
+        RETURN_OBJECT(string_char_at(self, min));
+    }
 
     t_string *dst = string_copy_partial(self->data.value, min, new_size);
 
@@ -257,12 +318,12 @@ SAFFIRE_METHOD(string, splice) {
 SAFFIRE_METHOD(string, to_locale) {
     t_string_object *str_obj;
 
-    if (! object_parse_arguments(SAFFIRE_METHOD_ARGS, "s", (t_object *)&str_obj)) {
+    if (! object_parse_argv(SAFFIRE_METHOD_ARGV, "s", (t_object *)&str_obj)) {
         return NULL;
     }
 
-    // Clone as new string
-    t_string_object *dst = (t_string_object *)object_clone((t_object *)self);
+    // Strings don't have a clone function, and self may be shared (like cached characters). Use a new slice instead.
+    t_string_object *dst = string_create_slice(self, 0);
 
     // Set new locale
     string_change_locale(dst, STROBJ2CHAR0(str_obj));
@@ -275,11 +336,50 @@ SAFFIRE_METHOD(string, to_locale) {
  *
  */
 SAFFIRE_METHOD(string, get_locale) {
-    RETURN_STRING_FROM_CHAR(self->data.locale);
+    RETURN_STRING_FROM_CHAR(self->data.locale ? self->data.locale->name : "");
 }
 
 
 
+/**
+ * Saffire method: Returns a new string with all strings from a list or tuple, separated by this string
+ */
+SAFFIRE_METHOD(string, join) {
+    t_object *ds_obj;
+
+    if (! object_parse_argv(SAFFIRE_METHOD_ARGV, "o", &ds_obj)) {
+        return NULL;
+    }
+
+    t_vector *vector;
+    if (OBJECT_IS_LIST(ds_obj)) {
+        vector = ((t_list_object *)ds_obj)->data.vector;
+    } else if (OBJECT_IS_TUPLE(ds_obj)) {
+        vector = ((t_tuple_object *)ds_obj)->data.vector;
+    } else {
+        object_raise_exception(Object_ArgumentException, 1, "join() expects a list or tuple");
+        return NULL;
+    }
+
+    t_string **parts = smm_malloc(sizeof(t_string *) * (vector->size + 1));
+    for (long i=0; i < vector->size; i++) {
+        t_object *obj = vector->elements[i];
+        if (! OBJECT_IS_STRING(obj)) {
+            smm_free(parts);
+            object_raise_exception(Object_ArgumentException, 1, "join() expects only strings, element %ld is not", i);
+            return NULL;
+        }
+        parts[i] = ((t_string_object *)obj)->data.value;
+    }
+
+    t_string *dst = string_join(self->data.value, parts, vector->size);
+    smm_free(parts);
+
+    t_string_object *obj = string_create_new_object(dst, self->data.locale);
+    RETURN_OBJECT(obj);
+}
+
+
 /* ======================================================================
  *   Standard operators
  * ======================================================================
@@ -287,7 +387,7 @@ SAFFIRE_METHOD(string, get_locale) {
 SAFFIRE_OPERATOR_METHOD(string, add) {
     t_string_object *other;
 
-    if (! object_parse_arguments(SAFFIRE_METHOD_ARGS, "s",  &other)) {
+    if (! object_parse_argv(SAFFIRE_METHOD_ARGV, "s",  &other)) {
         return NULL;
     }
 
@@ -305,7 +405,7 @@ SAFFIRE_OPERATOR_METHOD(string, add) {
 SAFFIRE_COMPARISON_METHOD(string, eq) {
     t_string_object *other;
 
-    if (! object_parse_arguments(SAFFIRE_METHOD_ARGS, "s",  &other)) {
+    if (! object_parse_argv(SAFFIRE_METHOD_ARGV, "s",  &other)) {
         return NULL;
     }
 
@@ -313,9 +413,11 @@ SAFFIRE_COMPARISON_METHOD(string, eq) {
         RETURN_FALSE;
     }
 
-    // @TODO: Assuming that every unique string will be at the same address, we could do a simple address check
-    //        instead of a memcmp. However, it means that we MUST make sure that the value_len's are also matching,
-    //        otherwise "foo" would match "foobar", as they both have the same start address
+    // Only names and constants are interned, string values are not. So only the same string object can be
+    // matched by address, all others still need a compare.
+    if (self == other) {
+        RETURN_TRUE;
+    }
     if (object_string_compare(self, other) == 0) {
         RETURN_TRUE;
     }
@@ -325,7 +427,7 @@ SAFFIRE_COMPARISON_METHOD(string, eq) {
 SAFFIRE_COMPARISON_METHOD(string, ne) {
     t_string_object *other;
 
-    if (! object_parse_arguments(SAFFIRE_METHOD_ARGS, "s",  &other)) {
+    if (! object_parse_argv(SAFFIRE_METHOD_ARGV, "s",  &other)) {
         return NULL;
     }
 
@@ -333,9 +435,11 @@ SAFFIRE_COMPARISON_METHOD(string, ne) {
         RETURN_TRUE;
     }
 
-    // @TODO: Assuming that every unique string will be at the same address, we could do a simple address check
-    //        instead of a memcmp. However, it means that we MUST make sure that the value_len's are also matching,
-    //        otherwise "foo" would match "foobar", as they both have the same start address
+    // Only names and constants are interned, string values are not. So only the same string object can be
+    // matched by address, all others still need a compare.
+    if (self == other) {
+        RETURN_FALSE;
+    }
     if (object_string_compare(self, other) != 0) {
         RETURN_TRUE;
     }
@@ -345,7 +449,7 @@ SAFFIRE_COMPARISON_METHOD(string, ne) {
 SAFFIRE_COMPARISON_METHOD(string, lt) {
     t_string_object *other;
 
-    if (! object_parse_arguments(SAFFIRE_METHOD_ARGS, "s",  &other)) {
+    if (! object_parse_argv(SAFFIRE_METHOD_ARGV, "s",  &other)) {
         return NULL;
     }
 
@@ -358,7 +462,7 @@ SAFFIRE_COMPARISON_METHOD(string, lt) {
 SAFFIRE_COMPARISON_METHOD(string, gt) {
     t_string_object *other;
 
-    if (! object_parse_arguments(SAFFIRE_METHOD_ARGS, "s",  &other)) {
+    if (! object_parse_argv(SAFFIRE_METHOD_ARGV, "s",  &other)) {
         return NULL;
     }
 
@@ -371,7 +475,7 @@ SAFFIRE_COMPARISON_METHOD(string, gt) {
 SAFFIRE_COMPARISON_METHOD(string, le) {
     t_string_object *other;
 
-    if (! object_parse_arguments(SAFFIRE_METHOD_ARGS, "s",  &other)) {
+    if (! object_parse_argv(SAFFIRE_METHOD_ARGV, "s",  &other)) {
         return NULL;
     }
 
@@ -385,7 +489,7 @@ SAFFIRE_COMPARISON_METHOD(string, le) {
 SAFFIRE_COMPARISON_METHOD(string, ge) {
     t_string_object *other;
 
-    if (! object_parse_arguments(SAFFIRE_METHOD_ARGS, "s",  &other)) {
+    if (! object_parse_argv(SAFFIRE_METHOD_ARGV, "s",  &other)) {
         return NULL;
     }
 
@@ -398,7 +502,7 @@ SAFFIRE_COMPARISON_METHOD(string, ge) {
 SAFFIRE_COMPARISON_METHOD(string, in) {
     t_string_object *other;
 
-    if (! object_parse_arguments(SAFFIRE_METHOD_ARGS, "s",  &other)) {
+    if (! object_parse_argv(SAFFIRE_METHOD_ARGV, "s",  &other)) {
         return NULL;
     }
 
@@ -408,7 +512,7 @@ SAFFIRE_COMPARISON_METHOD(string, in) {
 SAFFIRE_COMPARISON_METHOD(string, ni) {
     t_string_object *other;
 
-    if (! object_parse_arguments(SAFFIRE_METHOD_ARGS, "s",  &other)) {
+    if (! object_parse_argv(SAFFIRE_METHOD_ARGV, "s",  &other)) {
         return NULL;
     }
 
@@ -427,9 +531,7 @@ SAFFIRE_METHOD(string, __key) {
 }
 
 SAFFIRE_METHOD(string, __value) {
-    t_string *dst = string_copy_partial(self->data.value, self->data.iter, 1);
-    t_string_object *dst_obj = string_create_new_object(dst, self->data.locale);
-    RETURN_OBJECT(dst_obj);
+    RETURN_OBJECT(string_char_at(self, self->data.iter));
 }
 
 SAFFIRE_METHOD(string, __next) {
@@ -458,7 +560,7 @@ SAFFIRE_METHOD(string, __remove) {
 SAFFIRE_METHOD(string, __get) {
     t_object *idx_obj;
 
-    if (! object_parse_arguments(SAFFIRE_METHOD_ARGS, "o", &idx_obj)) {
+    if (! object_parse_argv(SAFFIRE_METHOD_ARGV, "o", &idx_obj)) {
         return NULL;
     }
 
@@ -468,17 +570,14 @@ SAFFIRE_METHOD(string, __get) {
         return NULL;
     }
 
-
-    t_string *dst = string_copy_partial(self->data.value, idx, 1);
-    t_string_object *dst_obj = string_create_new_object(dst, self->data.locale);
-    RETURN_OBJECT(dst_obj);
+    RETURN_OBJECT(string_char_at(self, idx));
 }
 
 
 SAFFIRE_METHOD(string, __has) {
     t_object *idx_obj;
 
-    if (! object_parse_arguments(SAFFIRE_METHOD_ARGS, "o", &idx_obj)) {
+    if (! object_parse_argv(SAFFIRE_METHOD_ARGV, "o", &idx_obj)) {
         return NULL;
     }
 
@@ -518,6 +617,7 @@ void object_string_init(void) {
 
 
     object_add_internal_method((t_object *)&Object_String_struct, "splice",         ATTRIB_METHOD_NONE, ATTRIB_VISIBILITY_PUBLIC, object_string_method_splice);
+    object_add_internal_method((t_object *)&Object_String_struct, "join",           ATTRIB_METHOD_NONE, ATTRIB_VISIBILITY_PUBLIC, object_string_method_join);
 
     object_add_internal_method((t_object *)&Object_String_struct, "__opr_add",      ATTRIB_METHOD_NONE, ATTRIB_VISIBILITY_PUBLIC, object_string_method_opr_add);
 //    object_add_internal_method((t_object *)&Object_String_struct, "__opr_sl",       ATTRIB_METHOD_NONE, ATTRIB_VISIBILITY_PUBLIC, object_string_method_opr_sl);
@@ -558,12 +658,29 @@ void object_string_init(void) {
  * Frees memory for a string object
  */
 void object_string_fini(void) {
+    // Free single character cache
+    for (int i=0; i!=STRING_CACHED_CHARS; i++) {
+        if (string_char_cache[i]) object_release((t_object *)string_char_cache[i]);
+        string_char_cache[i] = NULL;
+    }
+
     // Free attributes
     object_free_internal_object((t_object *)&Object_String_struct);
 }
 
 
 
+static t_object *obj_cache(t_object *obj, t_dll *arg_list) {
+    // Only strings created from a single char can be found in the cache
+    if (arg_list->size != 2) return NULL;
+
+    t_dll_element *e = DLL_HEAD(arg_list);
+    if ((long)e->data != 1) return NULL;
+
+    char *value = (char *)DLL_NEXT(e)->data;
+    return (t_object *)string_cached_char(value[0], thread_get_current()->locale);
+}
+
 static void obj_populate(t_object *obj, t_dll *arg_list) {
     t_string_object *str_obj = (t_string_object *)obj;
 
@@ -587,13 +704,18 @@ static void obj_populate(t_object *obj, t_dll *arg_list) {
     }
 
     t_thread *thread = thread_get_current();
-    str_obj->data.locale = thread->locale ? string_strdup0(thread->locale) : NULL;
+    str_obj->data.locale = thread->locale;
 }
 
 static void obj_free(t_object *obj) {
     t_string_object *str_obj = (t_string_object *)obj;
     if (str_obj->data.value) smm_free(str_obj->data.value);
-    if (str_obj->data.locale) smm_free(str_obj->data.locale);
+
+    // Slices only borrow the buffer of their owner
+    if (str_obj->data.owner) {
+        object_release(str_obj->data.owner);
+        str_obj->data.owner = NULL;
+    }
 }
 
 
@@ -620,20 +742,26 @@ static char *obj_debug(t_object *obj) {
 }
 #endif
 
-static char *obj_hash(t_object *obj) {
+static hash_t obj_hash(t_object *obj) {
     t_string_object *str_obj = (t_string_object *)obj;
 
-    char *s = (char *)smm_malloc(17);
-
     if (str_obj->data.needs_hashing == 1) {
         // Generate hash
         calculate_hash(str_obj);
         str_obj->data.needs_hashing = 0;
     }
-    memcpy(s, str_obj->data.hash, 16);
-    s[16] = '\0';
 
-    return s;
+    return str_obj->data.hash;
+}
+
+static int obj_equals(t_object *obj1, t_object *obj2) {
+    t_string_object *s1 = (t_string_object *)obj1;
+    t_string_object *s2 = (t_string_object *)obj2;
+
+    if (STROBJ2CHAR0LEN(s1) != STROBJ2CHAR0LEN(s2)) return 0;
+    if (obj_hash(obj1) != obj_hash(obj2)) return 0;
+
+    return memcmp(STROBJ2CHAR0(s1), STROBJ2CHAR0(s2), STROBJ2CHAR0LEN(s1)) == 0;
 }
 
 
@@ -644,8 +772,10 @@ t_object_funcs string_funcs = {
         obj_free,             // Free a string object
         obj_destroy,          // Destroy a string object
         NULL,                 // Clone
-        NULL,                 // Object cache
+        obj_cache,            // Object cache
         obj_hash,             // Hash
+        obj_equals,           // Equals
+        NULL,                 // Traverse
 #ifdef __DEBUG
         obj_debug,
 #endif
@@ -658,9 +788,10 @@ t_string_object Object_String_struct = {
 
     {
         NULL,       // Value
-        "",         // Hash value
+        0,          // Hash value
         1,          // Needs hashing
         0,          // Internal iteration index
         NULL,       // Locale
+        NULL,       // Owner of the buffer (slices only)
     }
 };
@@ -0,0 +1,263 @@
+/*
+ Copyright (c) 2012-2013, The Saffire Group
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+     * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+     * Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in the
+       documentation and/or other materials provided with the distribution.
+     * Neither the name of the Saffire Group the
+       names of its contributors may be used to endorse or promote products
+       derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include <stdio.h>
+#include <string.h>
+#include "objects/object.h"
+#include "objects/objects.h"
+#include "general/hashtable.h"
+#include "general/smm.h"
+#include "general/string.h"
+#include "debug.h"
+#include "general/output.h"
+
+// Initial buffer size of a string builder
+#define STRINGBUILDER_INITIAL_CAPACITY     64
+
+/* ======================================================================
+ *   Supporting functions
+ * ======================================================================
+ */
+
+/**
+ * Appends a string to the builder. The buffer doubles in size when it fills up, so appending is amortised O(1)
+ * instead of the copy of everything built so far that string concatenation needs.
+ */
+static void stringbuilder_append(t_stringbuilder_object *sb_obj, const t_string *src) {
+    t_string *dst = sb_obj->data.value;
+
+    if (dst->len + src->len + 1 > sb_obj->data.capacity) {
+        size_t capacity = sb_obj->data.capacity;
+        while (dst->len + src->len + 1 > capacity) capacity *= 2;
+
+        dst->val = (char *)smm_realloc(dst->val, capacity);
+        sb_obj->data.capacity = capacity;
+    }
+
+    memcpy(dst->val + dst->len, src->val, src->len);
+    dst->len += src->len;
+    dst->val[dst->len] = '\0';
+
+    // Same as string_strcat(): only malformed strings could become valid UTF-8 at the boundary
+    if (STRING_IS_UTF8(dst) && STRING_IS_UTF8(src)) {
+        dst->flags &= src->flags;
+    } else {
+        dst->flags = string_scan_flags(dst->val, dst->len);
+    }
+}
+
+
+/* ======================================================================
+ *   Object methods
+ * ======================================================================
+ */
+
+
+/**
+ * Saffire method: constructor
+ */
+SAFFIRE_METHOD(stringbuilder, ctor) {
+    t_string_object *str_obj = NULL;
+
+    if (! object_parse_argv(SAFFIRE_METHOD_ARGV, "|s", &str_obj)) {
+        return NULL;
+    }
+
+    if (str_obj) {
+        stringbuilder_append(self, str_obj->data.value);
+    }
+    RETURN_SELF;
+}
+
+/**
+ * Saffire method: destructor
+ */
+SAFFIRE_METHOD(stringbuilder, dtor) {
+    RETURN_NULL;
+}
+
+
+/**
+ * Saffire method: Appends a string to the builder
+ */
+SAFFIRE_METHOD(stringbuilder, add) {
+    t_string_object *str_obj;
+
+    if (! object_parse_argv(SAFFIRE_METHOD_ARGV, "s", &str_obj)) {
+        return NULL;
+    }
+
+    stringbuilder_append(self, str_obj->data.value);
+    RETURN_SELF;
+}
+
+/**
+ * Saffire method: Returns the length of the string built so far
+ */
+SAFFIRE_METHOD(stringbuilder, length) {
+    RETURN_NUMERICAL(self->data.value->len);
+}
+
+/**
+ * Saffire method: Empties the builder, but keeps its buffer for reuse
+ */
+SAFFIRE_METHOD(stringbuilder, clear) {
+    self->data.value->len = 0;
+    self->data.value->val[0] = '\0';
+    self->data.value->flags = STRING_FLAG_ASCII | STRING_FLAG_UTF8;
+    RETURN_SELF;
+}
+
+
+/**
+ *
+ */
+SAFFIRE_METHOD(stringbuilder, conv_boolean) {
+    if (self->data.value->len == 0) {
+        RETURN_FALSE;
+    } else {
+        RETURN_TRUE;
+    }
+}
+
+/**
+ *
+ */
+SAFFIRE_METHOD(stringbuilder, conv_null) {
+    RETURN_NULL;
+}
+
+/**
+ *
+ */
+SAFFIRE_METHOD(stringbuilder, conv_numerical) {
+    RETURN_NUMERICAL(self->data.value->len);
+}
+
+/**
+ * Saffire method: Returns the string built so far as a new string object
+ */
+SAFFIRE_METHOD(stringbuilder, conv_string) {
+    RETURN_STRING(string_strdup(self->data.value));
+}
+
+
+/* ======================================================================
+ *   Global object management functions and data
+ * ======================================================================
+ */
+
+/**
+ * Initializes stringbuilder methods and properties, these are used
+ */
+void object_stringbuilder_init(void) {
+    Object_StringBuilder_struct.attributes = ht_create();
+    object_add_internal_method((t_object *)&Object_StringBuilder_struct, "__ctor",        ATTRIB_METHOD_CTOR, ATTRIB_VISIBILITY_PUBLIC, object_stringbuilder_method_ctor);
+    object_add_internal_method((t_object *)&Object_StringBuilder_struct, "__dtor",        ATTRIB_METHOD_DTOR, ATTRIB_VISIBILITY_PUBLIC, object_stringbuilder_method_dtor);
+
+    object_add_internal_method((t_object *)&Object_StringBuilder_struct, "__boolean",     ATTRIB_METHOD_NONE, ATTRIB_VISIBILITY_PUBLIC, object_stringbuilder_method_conv_boolean);
+    object_add_internal_method((t_object *)&Object_StringBuilder_struct, "__null",        ATTRIB_METHOD_NONE, ATTRIB_VISIBILITY_PUBLIC, object_stringbuilder_method_conv_null);
+    object_add_internal_method((t_object *)&Object_StringBuilder_struct, "__numerical",   ATTRIB_METHOD_NONE, ATTRIB_VISIBILITY_PUBLIC, object_stringbuilder_method_conv_numerical);
+    object_add_internal_method((t_object *)&Object_StringBuilder_struct, "__string",      ATTRIB_METHOD_NONE, ATTRIB_VISIBILITY_PUBLIC, object_stringbuilder_method_conv_string);
+
+    object_add_internal_method((t_object *)&Object_StringBuilder_struct, "add",           ATTRIB_METHOD_NONE, ATTRIB_VISIBILITY_PUBLIC, object_stringbuilder_method_add);
+    object_add_internal_method((t_object *)&Object_StringBuilder_struct, "clear",         ATTRIB_METHOD_NONE, ATTRIB_VISIBILITY_PUBLIC, object_stringbuilder_method_clear);
+    object_add_internal_method((t_object *)&Object_StringBuilder_struct, "length",        ATTRIB_METHOD_NONE, ATTRIB_VISIBILITY_PUBLIC, object_stringbuilder_method_length);
+
+    vm_populate_builtins("stringbuilder", (t_object *)&Object_StringBuilder_struct);
+}
+
+/**
+ * Frees memory for a stringbuilder object
+ */
+void object_stringbuilder_fini(void) {
+    // Free attributes
+    object_free_internal_object((t_object *)&Object_StringBuilder_struct);
+}
+
+
+
+static void obj_populate(t_object *obj, t_dll *arg_list) {
+    t_stringbuilder_object *sb_obj = (t_stringbuilder_object *)obj;
+
+    sb_obj->data.capacity = STRINGBUILDER_INITIAL_CAPACITY;
+    sb_obj->data.value = string_new();
+    sb_obj->data.value->val = (char *)smm_malloc(sb_obj->data.capacity);
+    sb_obj->data.value->val[0] = '\0';
+}
+
+static void obj_free(t_object *obj) {
+    t_stringbuilder_object *sb_obj = (t_stringbuilder_object *)obj;
+    if (! sb_obj) return;
+
+    string_free(sb_obj->data.value);
+    sb_obj->data.value = NULL;
+}
+
+static void obj_destroy(t_object *obj) {
+    smm_free(obj);
+}
+
+
+#ifdef __DEBUG
+char global_buf[1024];
+static char *obj_debug(t_object *obj) {
+    if (OBJECT_TYPE_IS_CLASS(obj)) {
+        sprintf(global_buf, "StringBuilder");
+    } else {
+        t_string *value = ((t_stringbuilder_object *)obj)->data.value;
+        sprintf(global_buf, "stringbuilder[%zu]", value ? value->len : 0);
+    }
+    return global_buf;
+}
+#endif
+
+
+// StringBuilder object management functions
+t_object_funcs stringbuilder_funcs = {
+        obj_populate,
+        obj_free,             // Free a stringbuilder object
+        obj_destroy,
+        NULL,                 // Clone
+        NULL,                 // Cache
+        NULL,                 // Hash
+        NULL,                 // Equals
+        NULL,                 // Traverse
+#ifdef __DEBUG
+        obj_debug
+#endif
+};
+
+
+
+// Intial object
+t_stringbuilder_object Object_StringBuilder_struct = {
+    OBJECT_HEAD_INIT("stringbuilder", objectTypeStringBuilder, OBJECT_TYPE_CLASS, &stringbuilder_funcs, sizeof(t_stringbuilder_object_data)),
+    {
+        NULL,
+        0
+    }
+};
@@ -32,6 +32,7 @@
 #include "objects/objects.h"
 #include "general/hashtable.h"
 #include "general/smm.h"
+#include "general/vector.h"
 #include "general/md5.h"
 #include "debug.h"
 #include "general/output.h"
@@ -68,7 +69,7 @@ SAFFIRE_METHOD(tuple, dtor) {
  * Saffire method: Returns the number of elements stored inside the tuple
  */
 SAFFIRE_METHOD(tuple, length) {
-    RETURN_NUMERICAL(self->data.ht->element_count);
+    RETURN_NUMERICAL(self->data.vector->size);
 }
 
 /**
@@ -77,18 +78,18 @@ SAFFIRE_METHOD(tuple, length) {
 SAFFIRE_METHOD(tuple, get) {
     t_numerical_object *index;
 
-    if (! object_parse_arguments(SAFFIRE_METHOD_ARGS, "n", &index)) {
+    if (! object_parse_argv(SAFFIRE_METHOD_ARGV, "n", &index)) {
         return NULL;
     }
 
     // Check index boundaries
     long idx = OBJ2NUM(index);
-    if (idx < 0 || idx >= self->data.ht->element_count) {
+    if (idx < 0 || idx >= self->data.vector->size) {
         object_raise_exception(Object_IndexException, 1, "Index out of range");
         return NULL;
     }
 
-    t_object *obj = ht_find_num(self->data.ht, OBJ2NUM(index));
+    t_object *obj = vector_get(self->data.vector, idx);
     if (obj == NULL) RETURN_NULL;
     RETURN_OBJECT(obj);
 }
@@ -99,10 +100,10 @@ SAFFIRE_METHOD(tuple, get) {
 //SAFFIRE_METHOD(tuple, add) {
 //    t_object *val;
 //
-//    if (! object_parse_arguments(SAFFIRE_METHOD_ARGS, "o", &val)) {
+//    if (! object_parse_argv(SAFFIRE_METHOD_ARGV, "o", &val)) {
 //        return NULL;
 //    }
-//    ht_add_num(self->data.ht, self->data.ht->element_count, val);
+//    vector_append(self->data.vector, val);
 //    RETURN_SELF;
 //}
 
@@ -112,7 +113,7 @@ SAFFIRE_METHOD(tuple, get) {
 SAFFIRE_METHOD(tuple, populate) {
     t_hash_object *ht_obj;
 
-    if (! object_parse_arguments(SAFFIRE_METHOD_ARGS, "o",  (t_object *)&ht_obj)) {
+    if (! object_parse_argv(SAFFIRE_METHOD_ARGV, "o",  (t_object *)&ht_obj)) {
         return NULL;
     }
     if (! OBJECT_IS_HASH(ht_obj)) {
@@ -120,14 +121,16 @@ SAFFIRE_METHOD(tuple, populate) {
         return NULL;
     }
 
-    if (! self->data.ht) {
-        self->data.ht = ht_create();
+    if (! self->data.vector) {
+        self->data.vector = vector_init();
     }
+    vector_reserve(self->data.vector, self->data.vector->size + ht_obj->data.ht->element_count);
 
     t_hash_iter iter;
     ht_iter_init(&iter, ht_obj->data.ht);
     while (ht_iter_valid(&iter)) {
-        ht_add_num(self->data.ht, self->data.ht->element_count, ht_iter_value(&iter));
+        vector_append(self->data.vector, ht_iter_value(&iter));
+        object_inc_ref(ht_iter_value(&iter));
         ht_iter_next(&iter);
     }
 
@@ -141,7 +144,7 @@ SAFFIRE_METHOD(tuple, populate) {
 SAFFIRE_METHOD(tuple, remove) {
     t_string_object *key;
 
-    if (! object_parse_arguments(SAFFIRE_METHOD_ARGS, "s", &key)) {
+    if (! object_parse_argv(SAFFIRE_METHOD_ARGV, "s", &key)) {
         return NULL;
     }
 
@@ -155,7 +158,7 @@ SAFFIRE_METHOD(tuple, remove) {
  *
  */
 SAFFIRE_METHOD(tuple, conv_boolean) {
-    if (self->data.ht->element_count == 0) {
+    if (self->data.vector->size == 0) {
         RETURN_FALSE;
     } else {
         RETURN_TRUE;
@@ -173,7 +176,7 @@ SAFFIRE_METHOD(tuple, conv_null) {
  *
  */
 SAFFIRE_METHOD(tuple, conv_numerical) {
-    RETURN_NUMERICAL(self->data.ht->element_count);
+    RETURN_NUMERICAL(self->data.vector->size);
 }
 
 /**
@@ -240,23 +243,33 @@ void object_tuple_fini(void) {
 static void obj_populate(t_object *obj, t_dll *arg_list) {
     t_tuple_object *tuple_obj = (t_tuple_object *)obj;
 
-    // Create new hash list
-    tuple_obj->data.ht = ht_create();
-
-    int cnt = 0;
     t_dll_element *e = DLL_HEAD(arg_list);
-    if (! e) return;
+    if (! e) {
+        // Create new vector
+        tuple_obj->data.vector = vector_init();
+        return;
+    }
 
+    if (arg_list->size == 1) {
+        // Simple vector. Direct copy
+        tuple_obj->data.vector = e->data;
+        return;
+    }
 
     e = DLL_NEXT(e);
 
     t_dll *dll = (t_dll *)e->data;
+
+    tuple_obj->data.vector = vector_init();
+    vector_reserve(tuple_obj->data.vector, dll->size);
+
     e = DLL_HEAD(dll);    // 2nd elementof the DLL is a DLL itself.. inception!
     while (e) {
         t_object *arg_obj = (t_object *)e->data;
 
         DEBUG_PRINT_STRING(char0_to_string("Adding object: %s\n"), object_debug(arg_obj));
-        ht_add_num(tuple_obj->data.ht, cnt++, arg_obj);
+        vector_append(tuple_obj->data.vector, arg_obj);
+        object_inc_ref(arg_obj);
 
         e = DLL_NEXT(e);
     }
@@ -266,8 +279,22 @@ static void obj_free(t_object *obj) {
     t_tuple_object *tuple_obj = (t_tuple_object *)obj;
     if (! tuple_obj) return;
 
-    if (tuple_obj->data.ht) {
-        ht_destroy(tuple_obj->data.ht);
+    if (tuple_obj->data.vector) {
+        // The tuple owns its elements
+        for (long i=0; i < tuple_obj->data.vector->size; i++) {
+            object_release(tuple_obj->data.vector->elements[i]);
+        }
+
+        vector_free(tuple_obj->data.vector);
+    }
+}
+
+static void obj_traverse(t_object *obj, void (*visit)(t_object *)) {
+    t_tuple_object *tuple_obj = (t_tuple_object *)obj;
+    if (! tuple_obj->data.vector) return;
+
+    for (long i=0; i < tuple_obj->data.vector->size; i++) {
+        visit(tuple_obj->data.vector->elements[i]);
     }
 }
 
@@ -282,7 +309,8 @@ static char *obj_debug(t_object *obj) {
     if (OBJECT_TYPE_IS_CLASS(obj)) {
         sprintf(global_buf, "Tuple");
     } else {
-        sprintf(global_buf, "tuple[%d]", ((t_tuple_object *)obj)->data.ht ? ((t_tuple_object *)obj)->data.ht->element_count : 0);
+        t_vector *vector = ((t_tuple_object *)obj)->data.vector;
+        sprintf(global_buf, "tuple[%ld]", vector ? vector->size : 0);
     }
     return global_buf;
 }
@@ -297,6 +325,8 @@ t_object_funcs tuple_funcs = {
         NULL,                 // Clone a tuple object
         NULL,                 // Cache
         NULL,                 // Hash
+        NULL,                 // Equals
+        obj_traverse,         // Traverse
 #ifdef __DEBUG
         obj_debug
 #endif
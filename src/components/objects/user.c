@@ -28,6 +28,7 @@
 #include <string.h>
 #include "objects/object.h"
 #include "objects/objects.h"
+#include "objects/shape.h"
 #include "general/smm.h"
 
 #include "general/output.h"
@@ -56,44 +57,110 @@ void object_user_fini() {
 
 
 
-static void obj_populate(t_object *self, t_dll *arg_list) {
-}
-
-static void obj_free(t_object *obj) {
+/**
+ * Frees the values of a user object. User objects use the functions of the builtin class they extend, so this is
+ * called on top of those functions.
+ */
+void object_user_free(t_object *obj) {
     t_user_object *user_obj = (t_user_object *)obj;
 
+    // Release the class we are instantiated from
+    if (OBJECT_HAS_COUNTED_CLASS(obj)) {
+        object_release(obj->class);
+    }
+
+    // Instances share everything else with their class, except for their properties
+    if (OBJECT_TYPE_IS_USER_INSTANCE(obj)) {
+        for (int i=0; obj->slots && i!=obj->shape->slot_count; i++) {
+            if (obj->slots[i]) object_release(obj->slots[i]);
+        }
+        smm_free(obj->slots);
+        obj->slots = NULL;
+        return;
+    }
+
     DEBUG_PRINT_CHAR("Freeing user object: %s\n", user_obj->name);
 
     // Free attributes
-    t_hash_iter iter;
-    ht_iter_init(&iter, user_obj->attributes);
-    while (ht_iter_valid(&iter)) {
+    if (obj->attributes) {
+        t_hash_iter iter;
+        ht_iter_init(&iter, user_obj->attributes);
+        while (ht_iter_valid(&iter)) {
 #ifdef __DEBUG
-        char *key = ht_iter_key_str(&iter);
-        DEBUG_PRINT_CHAR("Releasing attribute: %s\n", key);
+            char *key = ht_iter_key_str(&iter);
+            DEBUG_PRINT_CHAR("Releasing attribute: %s\n", key);
 #endif
 
-        t_object *attr_obj = (t_object *)ht_iter_value(&iter);
-        object_release(attr_obj);
+            t_object *attr_obj = (t_object *)ht_iter_value(&iter);
+            object_release(attr_obj);
 
-        ht_iter_next(&iter);
+            ht_iter_next(&iter);
 
+        }
+        ht_destroy(obj->attributes);
     }
-    ht_destroy(obj->attributes);
 
     // Release all interface objects
-    t_dll_element *e = DLL_HEAD(obj->interfaces);
-    while (e) {
-        object_release((t_object *)e->data);
-        e = DLL_NEXT(e);
+    if (obj->interfaces) {
+        t_dll_element *e = DLL_HEAD(obj->interfaces);
+        while (e) {
+            object_release((t_object *)e->data);
+            e = DLL_NEXT(e);
+        }
+        dll_free(obj->interfaces);
     }
-    dll_free(obj->interfaces);
 
     // Release parent class
     object_release(obj->parent);
 
     // Release name
     smm_free(obj->name);
+
+    // Free the shapes of our instances
+    object_shape_free(obj->shape);
+    obj->shape = NULL;
+
+    // The attribute table is gone, so no inline cache may point into it anymore
+    object_attrib_generation++;
+}
+
+
+/**
+ * Visits all objects a user object holds a reference to
+ */
+void object_user_traverse(t_object *obj, void (*visit)(t_object *)) {
+    if (OBJECT_HAS_COUNTED_CLASS(obj)) {
+        visit(obj->class);
+    }
+
+    // Instances share everything else with their class, except for their properties
+    if (OBJECT_TYPE_IS_USER_INSTANCE(obj)) {
+        for (int i=0; obj->slots && i!=obj->shape->slot_count; i++) {
+            if (obj->slots[i]) visit(obj->slots[i]);
+        }
+        return;
+    }
+
+    if (obj->attributes) {
+        t_hash_iter iter;
+        ht_iter_init(&iter, obj->attributes);
+        while (ht_iter_valid(&iter)) {
+            visit((t_object *)ht_iter_value(&iter));
+            ht_iter_next(&iter);
+        }
+    }
+
+    t_dll_element *e = obj->interfaces ? DLL_HEAD(obj->interfaces) : NULL;
+    while (e) {
+        visit((t_object *)e->data);
+        e = DLL_NEXT(e);
+    }
+
+    visit(obj->parent);
+}
+
+
+static void obj_populate(t_object *self, t_dll *arg_list) {
 }
 
 static void obj_destroy(t_object *obj) {
@@ -113,11 +180,13 @@ static char *obj_debug(t_object *obj) {
 // object management functions
 t_object_funcs user_funcs = {
         obj_populate,         // Populate a user object
-        obj_free,             // Free a user object
+        NULL,                 // Free (done through object_user_free())
         obj_destroy,          // Destroy a user object
         NULL,                 // Clone
         NULL,                 // Cache
         NULL,                 // Hash
+        NULL,                 // Equals
+        NULL,                 // Traverse
 #ifdef __DEBUG
         obj_debug
 #endif
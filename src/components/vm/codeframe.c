@@ -27,12 +27,130 @@
 #include <string.h>
 #include "vm/codeframe.h"
 #include "vm/context.h"
+#include "vm/vm.h"
+#include "vm/vm_opcodes.h"
 #include "general/smm.h"
 #include "debug.h"
 
 t_hash_table *codeframes;    // Hash table with all code frames
 
 
+/**
+ * Checks if a (relative or absolute) jump target stays inside the bytecode. Since the predecoded instruction
+ * stream has no bounds checking during execution, we must make sure no jump will ever leave it.
+ */
+static void _check_jump_target(t_bytecode *bytecode, unsigned int ip, unsigned int target) {
+    if (target > bytecode->code_len) {
+        fatal_error(1, "VM: instruction at offset %d jumps outside the bytecode (%d)\n", ip, target);     /* LCOV_EXCL_LINE */
+    }
+}
+
+
+/**
+ * Returns 1 when the instruction resolves attributes through an inline cache
+ */
+static int _has_inline_cache(int opcode) {
+    return (opcode == VM_LOAD_ATTRIB || opcode == VM_LOAD_METHOD || opcode == VM_STORE_ATTRIB);
+}
+
+/**
+ * Decodes the bytecode into an array of instructions, indexed by bytecode offset. This way the opcode and
+ * operands only need to be decoded once, instead of every time an instruction gets executed. It also creates
+ * the inline caches used by the attribute instructions.
+ */
+static void _vm_codeframe_predecode(t_vm_codeframe *codeframe) {
+    t_bytecode *bytecode = codeframe->bytecode;
+    void **dispatch_table = vm_get_dispatch_table();
+    unsigned int len = bytecode->code_len;
+    unsigned int cache_len = 0;
+
+    t_vm_instruction *instructions = smm_malloc((len + 1) * sizeof(t_vm_instruction));
+    bzero(instructions, (len + 1) * sizeof(t_vm_instruction));
+
+    unsigned int ip = 0;
+    while (ip < len) {
+        t_vm_instruction *instr = &instructions[ip];
+        unsigned int start = ip;
+
+        instr->opcode = bytecode->code[ip++];
+
+        // Operands are 16 bit (unaligned) little endian values, and are only present when the high bits are set
+        unsigned int *operands[3] = { &instr->oparg1, &instr->oparg2, &instr->oparg3 };
+        unsigned int operand_count = ((instr->opcode & 0xE0) == 0xE0) ? 3 : ((instr->opcode & 0xC0) == 0xC0) ? 2 : ((instr->opcode & 0x80) == 0x80) ? 1 : 0;
+        for (int i=0; i!=3; i++) {
+            *operands[i] = 0;
+            if (i >= operand_count) continue;
+
+            if (ip + 1 >= len) {
+                fatal_error(1, "VM: instruction at offset %d is missing its operands\n", start);     /* LCOV_EXCL_LINE */
+            }
+            *operands[i] = bytecode->code[ip] | (bytecode->code[ip + 1] << 8);
+            ip += sizeof(uint16_t);
+        }
+        instr->next_ip = ip;
+        instr->handler = dispatch_table ? dispatch_table[instr->opcode] : NULL;
+
+        // Attribute lookups get their own inline cache
+        instr->cache_idx = 0;
+        if (_has_inline_cache(instr->opcode)) {
+            instr->cache_idx = cache_len++;
+        }
+
+        // Make sure we never jump outside our instruction stream
+        switch (instr->opcode) {
+            case VM_JUMP_FORWARD :
+            case VM_JUMP_IF_TRUE :
+            case VM_JUMP_IF_FALSE :
+            case VM_JUMP_IF_FIRST_TRUE :
+            case VM_JUMP_IF_FIRST_FALSE :
+            case VM_SETUP_LOOP :
+                _check_jump_target(bytecode, start, ip + instr->oparg1);
+                break;
+            case VM_SETUP_ELSE_LOOP :
+                _check_jump_target(bytecode, start, ip + instr->oparg1);
+                _check_jump_target(bytecode, start, ip + instr->oparg2);
+                break;
+            case VM_SETUP_EXCEPT :
+                _check_jump_target(bytecode, start, ip + instr->oparg1);
+                _check_jump_target(bytecode, start, ip + instr->oparg2);
+                _check_jump_target(bytecode, start, ip + instr->oparg3);
+                break;
+            case VM_JUMP_ABSOLUTE :
+                _check_jump_target(bytecode, start, instr->oparg1);
+                break;
+        }
+
+        // Offsets pointing into the operands are never valid instructions
+        for (unsigned int i=start+1; i < ip; i++) {
+            instructions[i].opcode = VM_RESERVED;
+            instructions[i].oparg1 = instructions[i].oparg2 = instructions[i].oparg3 = 0;
+            instructions[i].next_ip = ip;
+            instructions[i].cache_idx = 0;
+            instructions[i].handler = dispatch_table ? dispatch_table[VM_RESERVED] : NULL;
+        }
+    }
+
+    // Sentinel: running past the end of the bytecode will stop the frame
+    instructions[len].opcode = VM_STOP;
+    instructions[len].oparg1 = instructions[len].oparg2 = instructions[len].oparg3 = 0;
+    instructions[len].next_ip = len;
+    instructions[len].cache_idx = 0;
+    instructions[len].handler = dispatch_table ? dispatch_table[VM_STOP] : NULL;
+
+    codeframe->instructions = instructions;
+
+    // Create (empty) inline caches
+    codeframe->inline_cache_len = cache_len;
+    codeframe->inline_caches = smm_malloc(cache_len * sizeof(t_vm_inline_cache));
+    bzero(codeframe->inline_caches, cache_len * sizeof(t_vm_inline_cache));
+    for (ip = 0; ip < len; ip = instructions[ip].next_ip) {
+        if (_has_inline_cache(instructions[ip].opcode)) {
+            codeframe->inline_caches[instructions[ip].cache_idx].ip = ip;
+        }
+    }
+}
+
+
 /**
  *
  */
@@ -43,6 +161,9 @@ static t_vm_codeframe *_vm_codeframe_new(t_bytecode *bytecode, t_vm_context *con
     codeframe->bytecode = bytecode;
     codeframe->context = context;
 
+    // Decode the bytecode up front
+    _vm_codeframe_predecode(codeframe);
+
     // Create constants that are located in the bytecode and store inside the codeframe
     codeframe->constants_objects = smm_malloc(bytecode->constants_len * sizeof(t_object *));
     for (int i=0; i!=bytecode->constants_len; i++) {
@@ -109,6 +230,17 @@ t_vm_codeframe *vm_codeframe_find(char *class_path) {
 }
 
 
+/**
+ * Returns the local variable slot for the given identifier name, or -1 when the codeframe does not use it.
+ */
+int vm_codeframe_get_local_slot(t_vm_codeframe *codeframe, const char *name) {
+    for (int i=0; i!=codeframe->bytecode->identifiers_len; i++) {
+        if (strcmp(codeframe->bytecode->identifiers[i]->s, name) == 0) return i;
+    }
+    return -1;
+}
+
+
 /**
  *
  */
@@ -125,6 +257,10 @@ void vm_codeframe_destroy(t_vm_codeframe *codeframe) {
         }
         smm_free(codeframe->constants_objects);
 
+        // Free predecoded instructions and their caches
+        smm_free(codeframe->instructions);
+        smm_free(codeframe->inline_caches);
+
         // Release bytecode
         bytecode_free(codeframe->bytecode);
     }
@@ -0,0 +1,90 @@
+/*
+ Copyright (c) 2012-2013, The Saffire Group
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+     * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+     * Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in the
+       documentation and/or other materials provided with the distribution.
+     * Neither the name of the Saffire Group the
+       names of its contributors may be used to endorse or promote products
+       derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "vm/inline_cache.h"
+#include "objects/attrib.h"
+
+
+/*
+ * Inline caches remember which attribute a LOAD_ATTRIB or STORE_ATTRIB instruction has resolved for a certain
+ * object layout. An object layout is defined by the attribute table of an object (which is shared between a class
+ * and its instances) and its parent, since that is everything object_attrib_find() looks at, together with the shape
+ * that tells where the instance keeps its own properties. Every mutation of any attribute table increases
+ * object_attrib_generation, which invalidates all cache entries at once.
+ */
+
+
+/**
+ * Returns the cache entry that matches the object, or NULL when nothing (valid) has been cached.
+ */
+t_vm_inline_cache_entry *vm_inline_cache_lookup(t_vm_inline_cache *cache, t_object *obj, int is_class) {
+    for (int i=0; i!=VM_INLINE_CACHE_WAYS; i++) {
+        t_vm_inline_cache_entry *entry = &cache->entries[i];
+
+        if (entry->attributes == obj->attributes &&
+            entry->parent == obj->parent &&
+            entry->shape == obj->shape &&
+            entry->is_class == is_class &&
+            entry->generation == object_attrib_generation &&
+            (entry->attrib != NULL || entry->slot != 0)) {
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+
+/**
+ * Stores a resolved attribute and/or property slot into the cache. Visible is set when the visibility check does not
+ * depend on the object that is actually loading the attribute, so it does not have to be checked again.
+ */
+void vm_inline_cache_store(t_vm_inline_cache *cache, t_object *obj, int is_class, t_attrib_object *attrib, int slot, int visible) {
+    t_vm_inline_cache_entry *entry = NULL;
+
+    // Reuse an empty or outdated entry if possible
+    for (int i=0; i!=VM_INLINE_CACHE_WAYS; i++) {
+        if ((cache->entries[i].attrib == NULL && cache->entries[i].slot == 0) || cache->entries[i].generation != object_attrib_generation) {
+            entry = &cache->entries[i];
+            break;
+        }
+    }
+
+    // Polymorphic call site with more layouts than we can hold, replace entries round robin
+    if (entry == NULL) {
+        entry = &cache->entries[cache->next_entry];
+        cache->next_entry = (cache->next_entry + 1) % VM_INLINE_CACHE_WAYS;
+    }
+
+    entry->attributes = obj->attributes;
+    entry->parent = obj->parent;
+    entry->shape = obj->shape;
+    entry->is_class = is_class;
+    entry->generation = object_attrib_generation;
+    entry->attrib = attrib;
+    entry->slot = slot;
+    entry->visible = visible;
+}
@@ -73,19 +73,9 @@ unsigned int vm_frame_get_operand(t_vm_stackframe *frame) {
 }
 
 /**
- * Pops an object from the stack. If the object is an attribute, fetch the actual data of that attribute.
- * Errors when the stack is empty
+ * Pops the raw value from the stack, which can be a tagged numerical. Errors when the stack is empty
  */
-t_object *vm_frame_stack_pop(t_vm_stackframe *frame) {
-    t_object *obj = vm_frame_stack_pop_attrib(frame);
-    if (OBJECT_IS_ATTRIBUTE(obj)) return ((t_attrib_object *)obj)->data.attribute;
-    return obj;
-}
-
-/**
- * Pops an object from the stack. Errors when the stack is empty
- */
-t_object *vm_frame_stack_pop_attrib(t_vm_stackframe *frame) {
+static t_object *_vm_frame_stack_pop(t_vm_stackframe *frame) {
     #if __DEBUG_STACK
     DEBUG_PRINT_CHAR(ANSI_BRIGHTYELLOW "STACK POP (%d): %08lX %s\n" ANSI_RESET, frame->sp, (unsigned long)frame->stack[frame->sp], object_debug(frame->stack[frame->sp]));
     #endif
@@ -102,6 +92,47 @@ t_object *vm_frame_stack_pop_attrib(t_vm_stackframe *frame) {
     return ret;
 }
 
+/**
+ * Boxes a tagged numerical on the stack into a real object. The stack keeps the reference to the boxed object.
+ */
+static t_object *_vm_frame_stack_box(t_vm_stackframe *frame, int idx) {
+    t_object *obj = frame->stack[idx];
+    if (OBJECT_IS_TAGGED(obj)) {
+        obj = object_numerical_box(obj);
+        frame->stack[idx] = obj;
+
+        // Same reference a push would have added, so popping the boxed object later doesn't free it
+        object_inc_ref(obj);
+    }
+    return obj;
+}
+
+/**
+ * Pops an object from the stack. If the object is an attribute, fetch the actual data of that attribute.
+ * Errors when the stack is empty
+ */
+t_object *vm_frame_stack_pop(t_vm_stackframe *frame) {
+    t_object *obj = vm_frame_stack_pop_attrib(frame);
+    if (OBJECT_IS_ATTRIBUTE(obj)) return ((t_attrib_object *)obj)->data.attribute;
+    return obj;
+}
+
+/**
+ * Pops an object from the stack. Errors when the stack is empty
+ */
+t_object *vm_frame_stack_pop_attrib(t_vm_stackframe *frame) {
+    return object_numerical_box(_vm_frame_stack_pop(frame));
+}
+
+/**
+ * Same as vm_frame_stack_pop(), but returns tagged numericals as-is. Only for opcodes that can deal with them.
+ */
+t_object *vm_frame_stack_pop_tagged(t_vm_stackframe *frame) {
+    t_object *obj = _vm_frame_stack_pop(frame);
+    if (! OBJECT_IS_TAGGED(obj) && OBJECT_IS_ATTRIBUTE(obj)) return ((t_attrib_object *)obj)->data.attribute;
+    return obj;
+}
+
 
 /**
  * Pushes an object onto the stack. Errors when the stack is full
@@ -114,7 +145,7 @@ void vm_frame_stack_push(t_vm_stackframe *frame, t_object *obj) {
     #endif
 
 
-    if (frame->sp < 0) {
+    if (frame->sp <= 0) {
         fatal_error(1, "Trying to push to a full stack");       /* LCOV_EXCL_LINE */
     }
     frame->sp--;
@@ -132,6 +163,14 @@ void vm_frame_stack_modify(t_vm_stackframe *frame, int idx, t_object *obj) {
  * Fetches the top of the stack. Does not pop anything.
  */
 t_object *vm_frame_stack_fetch_top(t_vm_stackframe *frame) {
+    return _vm_frame_stack_box(frame, frame->sp);
+}
+
+
+/**
+ * Same as vm_frame_stack_fetch_top(), but returns tagged numericals as-is. Only for opcodes that can deal with them.
+ */
+t_object *vm_frame_stack_fetch_top_tagged(t_vm_stackframe *frame) {
     return frame->stack[frame->sp];
 }
 
@@ -144,7 +183,7 @@ t_object *vm_frame_stack_fetch(t_vm_stackframe *frame, int idx) {
         fatal_error(1, "Trying to fetch from outside stack range");     /* LCOV_EXCL_LINE */
     }
 
-    return frame->stack[idx];
+    return _vm_frame_stack_box(frame, idx);
 }
 
 
@@ -173,6 +212,18 @@ t_object *vm_frame_get_constant(t_vm_stackframe *frame, int idx) {
 }
 
 
+/**
+ * Returns the interned string of a string constant from the constant table
+ */
+char *vm_frame_get_constant_name(t_vm_stackframe *frame, int idx) {
+    if (idx < 0 || idx >= frame->codeframe->bytecode->constants_len) {
+        fatal_error(1, "Trying to fetch from outside constant range");      /* LCOV_EXCL_LINE */
+    }
+
+    return frame->codeframe->bytecode->constants[idx]->data.s;
+}
+
+
 /**
  * Store object into the frame identifier table. When obj == NULL, it will remove the actual reference (plus object)
  */
@@ -228,11 +279,48 @@ t_object *vm_frame_get_global_identifier(t_vm_stackframe *frame, char *id) {
  * Store object into either the local or global identifier table
  */
 void vm_frame_set_identifier(t_vm_stackframe *frame, char *id, t_object *obj) {
+    if (! frame->local_identifiers) {
+        frame->local_identifiers = (t_hash_object *)object_alloc(Object_Hash, 0);
+    }
+
     t_object *old_obj = (t_object *)ht_replace_str(frame->local_identifiers->data.ht, id, obj);
     object_release(old_obj);
     object_inc_ref(obj);
 }
 
+/**
+ * Returns the object stored in the local variable slot, or NULL when nothing has been stored (yet). A tagged
+ * numerical is boxed into the slot.
+ */
+t_object *vm_frame_get_local(t_vm_stackframe *frame, int slot) {
+    if (slot < 0 || slot >= frame->codeframe->bytecode->identifiers_len) {
+        fatal_error(1, "Trying to fetch from outside local variable range");        /* LCOV_EXCL_LINE */
+    }
+
+    if (OBJECT_IS_TAGGED(frame->locals[slot])) {
+        frame->locals[slot] = object_numerical_box(frame->locals[slot]);
+
+        // Same reference vm_frame_set_local() would have added
+        object_inc_ref(frame->locals[slot]);
+    }
+    return frame->locals[slot];
+}
+
+
+/**
+ * Store object into a local variable slot
+ */
+void vm_frame_set_local(t_vm_stackframe *frame, int slot, t_object *obj) {
+    if (slot < 0 || slot >= frame->codeframe->bytecode->identifiers_len) {
+        fatal_error(1, "Trying to store outside local variable range");        /* LCOV_EXCL_LINE */
+    }
+
+    t_object *old_obj = frame->locals[slot];
+    frame->locals[slot] = obj;
+    object_inc_ref(obj);
+    if (old_obj) object_release(old_obj);
+}
+
 void vm_frame_set_builtin_identifier(t_vm_stackframe *frame, char *id, t_object *obj) {
     t_object *old_obj = ht_replace_str(frame->builtin_identifiers->data.ht, id, obj);
 
@@ -272,18 +360,24 @@ t_object *vm_frame_resolve_identifier(t_vm_stackframe *frame, char *id) {
 
 
 t_object *vm_frame_local_identifier_exists(t_vm_stackframe *frame, char *id) {
-    t_object *
+    t_object *obj;
+
+    // Hash the identifier only once for all tables
+    size_t len;
+    hash_t hash = ht_hash_str(id, &len);
 
     // Check local identifiers
-    obj = ht_find_str(frame->local_identifiers->data.ht, id);
-    if (obj) return obj;
+    if (frame->local_identifiers) {
+        obj = ht_find_hashed(frame->local_identifiers->data.ht, id, len, hash);
+        if (obj) return obj;
+    }
 
     // Check frames
-    obj = ht_find_str(frame->frame_identifiers->data.ht, id);
+    obj = ht_find_hashed(frame->frame_identifiers->data.ht, id, len, hash);
     if (obj) return obj;
 
     // Last, check builtins
-    obj = ht_find_str(frame->builtin_identifiers->data.ht, id);
+    obj = ht_find_hashed(frame->builtin_identifiers->data.ht, id, len, hash);
     if (obj) return obj;
 
     return NULL;
@@ -324,13 +418,70 @@ char *vm_frame_get_name(t_vm_stackframe *frame, int idx) {
 }
 
 
+/**
+ * Fetches a frame with room for at least the given number of slots. Released frames from the thread's pool are reused
+ * when possible, so we don't need to allocate memory on every call.
+ */
+static t_vm_stackframe *_vm_stackframe_alloc(unsigned int slot_count) {
+    t_thread *thread = thread_get_current();
+    t_vm_stackframe *frame = NULL;
+
+    // Find the first pooled frame that is large enough
+    if (thread) {
+        t_vm_stackframe **prev = &thread->frame_pool;
+        while (*prev) {
+            if ((*prev)->slot_count >= slot_count) {
+                frame = *prev;
+                *prev = frame->pool_next;
+                thread->frame_pool_len--;
+                break;
+            }
+            prev = &(*prev)->pool_next;
+        }
+    }
+
+    if (! frame) {
+        unsigned int aligned_count = (slot_count + VM_FRAME_SLOT_ALIGN - 1) & ~(VM_FRAME_SLOT_ALIGN - 1);
+        frame = smm_malloc(sizeof(t_vm_stackframe) + aligned_count * sizeof(t_object *));
+        frame->slot_count = aligned_count;
+    }
+
+    // Clear the frame header and the slots we are going to use
+    unsigned int allocated_count = frame->slot_count;
+    bzero(frame, sizeof(t_vm_stackframe) + slot_count * sizeof(t_object *));
+    frame->slot_count = allocated_count;
+
+    return frame;
+}
+
+
+/**
+ * Releases the frame memory back into the thread's pool, or frees it when the pool is full
+ */
+static void _vm_stackframe_release(t_vm_stackframe *frame) {
+    t_thread *thread = thread_get_current();
+
+    if (! thread || thread->frame_pool_len >= VM_FRAME_POOL_SIZE) {
+        smm_free(frame);
+        return;
+    }
+
+    frame->pool_next = thread->frame_pool;
+    thread->frame_pool = frame;
+    thread->frame_pool_len++;
+}
+
+
 /**
 * Creates and initializes a new frame
 */
 t_vm_stackframe *vm_stackframe_new(t_vm_stackframe *parent_frame, t_vm_codeframe *codeframe) {
     DEBUG_PRINT_CHAR("\n\n\n\n\n============================ VM frame new ('%s' -> parent: '%s') ============================\n", codeframe->context->class.full, parent_frame ? parent_frame->codeframe->context->class.full : "<root>");
-    t_vm_stackframe *frame = smm_malloc(sizeof(t_vm_stackframe));
-    bzero(frame, sizeof(t_vm_stackframe));
+
+    // The stack and the local variable slots (every identifier has one, even though only the method locals will
+    // actually use theirs) are stored directly behind the frame.
+    t_bytecode *bytecode = codeframe->bytecode;
+    t_vm_stackframe *frame = _vm_stackframe_alloc(bytecode->stack_size + bytecode->identifiers_len);
 
     frame->parent = parent_frame;
     frame->codeframe = codeframe;
@@ -338,20 +489,17 @@ t_vm_stackframe *vm_stackframe_new(t_vm_stackframe *parent_frame, t_vm_codeframe
     frame->trace_class = NULL;
     frame->trace_method = NULL;
 
-    frame->sp = codeframe->bytecode->stack_size;
-    frame->stack = smm_malloc(codeframe->bytecode->stack_size * sizeof(t_object *));
-    bzero(frame->stack, codeframe->bytecode->stack_size * sizeof(t_object *));
+    frame->sp = bytecode->stack_size;
+    frame->stack = frame->slots;
+    frame->locals = frame->slots + bytecode->stack_size;
 
-
-    frame->created_user_objects = dll_init();
+    // Created user objects are registered when the first object is created
+    frame->created_user_objects = NULL;
 
 //    DEBUG_PRINT_CHAR("Increasing builtin_identifiers refcount\n");
     frame->builtin_identifiers = builtin_identifiers;
     object_inc_ref((t_object *)builtin_identifiers);
 
-    // Create new empty local identifier hash
-    frame->local_identifiers = (t_hash_object *)object_alloc(Object_Hash, 0);
-
     // Copy all the parent identifiers into the new frame. This should take care of things like the imports
     if (frame->parent == NULL) {
         frame->frame_identifiers = (t_hash_object *)object_alloc(Object_Hash, 0);
@@ -363,9 +511,12 @@ t_vm_stackframe *vm_stackframe_new(t_vm_stackframe *parent_frame, t_vm_codeframe
     // Set the variable hashes
     if (frame->parent == NULL) {
         // global identifiers are the same as the local identifiers for the initial frame
+        frame->local_identifiers = (t_hash_object *)object_alloc(Object_Hash, 0);
         frame->global_identifiers = frame->local_identifiers;
     } else {
-        // if not the initial frame, link globals from the parent frame
+        // if not the initial frame, link globals from the parent frame. Most method frames only use their local
+        // slots, so the local identifier hash is created as soon as something is actually stored in it.
+        frame->local_identifiers = NULL;
         frame->global_identifiers = frame->parent->global_identifiers;
     }
     object_inc_ref((t_object *)frame->global_identifiers);
@@ -392,48 +543,51 @@ void vm_stackframe_destroy(t_vm_stackframe *frame) {
 #endif
 
 
+    // Release local variables
+    for (int i=0; i!=frame->codeframe->bytecode->identifiers_len; i++) {
+        if (frame->locals[i]) object_release(frame->locals[i]);
+    }
+
     // Remove codeframe reference (don't mind cleanup, since we still have it on the codeframe stack)
     frame->codeframe = NULL;
-    if (frame->trace_class) smm_free(frame->trace_class);
-    if (frame->trace_method) smm_free(frame->trace_method);
-
-    t_hash_iter iter;
-    ht_iter_init(&iter, frame->local_identifiers->data.ht);
-    while (ht_iter_valid(&iter)) {
-        char *key = ht_iter_key_str(&iter);
-        t_object *val = ht_iter_value(&iter);
-
-        // Because we MIGHT change the hash-table, we need to fetch the next
-        // element PRIOR to changing the table. Otherwise we might end up in
-        // the crapper.
-        ht_iter_next(&iter);
-
-        DEBUG_PRINT_STRING(char0_to_string("Frame destroy: Releasing => %s => %s [%08X]\n"), key, object_debug(val), (unsigned int)val);
 
-        // Release value, as it's no longer needed.
-        object_release(val);
-
-        ht_remove_str(frame->local_identifiers->data.ht, key);
+    // Trace class and method are interned, so they are not freed
+
+    if (frame->local_identifiers) {
+        // Release values, as they are no longer needed.
+        t_hash_iter iter;
+        ht_iter_init(&iter, frame->local_identifiers->data.ht);
+        while (ht_iter_valid(&iter)) {
+            DEBUG_PRINT_STRING(char0_to_string("Frame destroy: Releasing => %s => %s [%08X]\n"), ht_iter_key_str(&iter), object_debug(ht_iter_value(&iter)), (unsigned int)ht_iter_value(&iter));
+            object_release(ht_iter_value(&iter));
+            ht_iter_next(&iter);
+        }
+
+        // When nobody else references our local identifiers, the whole hash is freed at once. Otherwise (the initial
+        // frame shares them as global identifiers), start with a fresh hash so nobody will find the released values.
+        if (frame->local_identifiers->ref_count > 1) {
+            ht_destroy(frame->local_identifiers->data.ht);
+            frame->local_identifiers->data.ht = ht_create();
+        }
     }
 
     // Free created user objects
-    t_dll_element *e = DLL_HEAD(frame->created_user_objects);
-    while (e) {
-        object_release((t_object *)e->data);
-        e = DLL_NEXT(e);
+    if (frame->created_user_objects) {
+        t_dll_element *e = DLL_HEAD(frame->created_user_objects);
+        while (e) {
+            object_release((t_object *)e->data);
+            e = DLL_NEXT(e);
+        }
+        dll_free(frame->created_user_objects);
     }
-    dll_free(frame->created_user_objects);
 
     // Free identifiers
     object_release((t_object *)frame->global_identifiers);
     object_release((t_object *)frame->frame_identifiers);
-    object_release((t_object *)frame->local_identifiers);
+    if (frame->local_identifiers) object_release((t_object *)frame->local_identifiers);
     object_release((t_object *)frame->builtin_identifiers);
 
-
-    smm_free(frame->stack);
-
-    smm_free(frame);
+    _vm_stackframe_release(frame);
 }
 
 /**
@@ -459,6 +613,10 @@ void vm_stackframe_destroy(t_vm_stackframe *frame) {
  *
  */
 void vm_frame_register_userobject(t_vm_stackframe *frame, t_object *obj) {
+    if (! frame->created_user_objects) {
+        frame->created_user_objects = dll_init();
+    }
+
     // @TODO: shouldn't we increase the refcount? We don't, as we ASSUME that refcount is already initialized with 1.
     dll_append(frame->created_user_objects, obj);
 }
@@ -40,13 +40,16 @@ t_thread *thread_new(void) {
     t_thread *thread = smm_malloc(sizeof(t_thread));
     bzero(thread, sizeof(t_thread));
 
-    thread->locale = string_strdup0(config_get_string("intl.locale", "nl_NL"));
+    thread->locale = utf8_locale(config_get_string("intl.locale", "nl_NL"));
     return thread;
 }
 
 void thread_free(t_thread *thread) {
-    if (thread->locale) {
-        smm_free(thread->locale);
+    // Free all pooled frames
+    while (thread->frame_pool) {
+        t_vm_stackframe *frame = thread->frame_pool;
+        thread->frame_pool = frame->pool_next;
+        smm_free(frame);
     }
 
     smm_free(thread);
@@ -32,12 +32,15 @@
 #include "vm/context.h"
 #include "vm/vm_opcodes.h"
 #include "vm/block.h"
+#include "vm/inline_cache.h"
 #include "vm/thread.h"
 #include "vm/import.h"
 #include "general/dll.h"
 #include "general/smm.h"
+#include "general/intern.h"
 #include "objects/object.h"
 #include "objects/objects.h"
+#include "objects/shape.h"
 #include "modules/module_api.h"
 #include "debug.h"
 #include "general/output.h"
@@ -64,7 +67,67 @@ t_hash_object *builtin_identifiers;         // Builtin identifiers - hashobject
 extern char *objectOprMethods[];
 extern char *objectCmpMethods[];
 
+
+/*
+ * When threaded dispatch is enabled, every opcode handler jumps directly to the handler of the next instruction
+ * through a computed goto (a GCC extension), instead of going back to a central switch(). The handler addresses
+ * are stored in the predecoded instruction stream of each codeframe. Debug builds always use the switch() so
+ * opcode tracing keeps working.
+ */
+#if defined(__VM_THREADED_DISPATCH) && defined(__GNUC__) && ! defined(__DEBUG)
+    #define VM_THREADED_DISPATCH 1
+#endif
+
+// Fetch the next predecoded instruction
+#define VM_FETCH()                                                          \
+    instr = &frame->codeframe->instructions[frame->ip];                     \
+    frame->ip = instr->next_ip;                                             \
+    opcode = instr->opcode;                                                 \
+    oparg1 = instr->oparg1;                                                 \
+    oparg2 = instr->oparg2;                                                 \
+    oparg3 = instr->oparg3;
+
+#ifdef VM_THREADED_DISPATCH
+    // Label every opcode handler, so we can jump to it directly
+    #define VM_TARGET(op)       case op : vm_label_##op
+
+    // Fetch and jump to the next instruction
+    #define VM_DISPATCH()                                                   \
+        do {                                                                \
+            VM_DEBUGGER_HOOK();                                             \
+            VM_FETCH();                                                     \
+            goto *VM_HANDLER(instr);                                        \
+        } while (0)
+#else
+    #define VM_TARGET(op)       case op
+    #define VM_DISPATCH()       goto dispatch
+#endif
+
+// Rewrites the current instruction into another form (quickening or de-optimising). The instruction stream always
+// holds the handlers of the variant without debugger.
+#ifdef VM_THREADED_DISPATCH
+    #define VM_REWRITE(op)      do { instr->opcode = op; instr->handler = vm_dispatch_table[op]; } while (0)
+#else
+    #define VM_REWRITE(op)      instr->opcode = op
+#endif
+
+// Number of times an instruction may fall back from a quickened form, before it stays generic
+#define VM_MAX_DEOPTS       4
+
+#ifdef VM_THREADED_DISPATCH
+static void **vm_dispatch_table = NULL;     // Opcode handler addresses, as published by _vm_execute_fast()
+#endif
+
 t_object *_vm_execute(t_vm_stackframe *frame);
+static t_object *_vm_execute_fast(t_vm_stackframe *frame);
+static t_object *_vm_execute_debug(t_vm_stackframe *frame);
+
+// Interpreter loop that is used for executing frames
+static t_object *(*vm_execute_loop)(t_vm_stackframe *frame) = _vm_execute_fast;
+
+// Number of nested interpreter loops. Cycles are only collected from the outermost loop, as nested loops can be called
+// from native code that holds uncounted references.
+static int vm_execute_depth = 0;
 
 /**
  * This method is called when we need to call an operator method. Even though eventually
@@ -121,12 +184,12 @@ static t_object *vm_object_comparison(t_object *obj1, int cmp, t_object *obj2) {
  *
  * Returns 1 in success, 0 on failure/exception is thrown
  */
-static int _parse_calling_arguments(t_vm_stackframe *frame, t_callable_object *callable, t_dll *arg_list) {
+static int _parse_calling_arguments(t_vm_stackframe *frame, t_callable_object *callable, t_object **argv, int argc) {
     t_hash_table *ht = callable->data.arguments;
-    t_dll_element *e = DLL_HEAD(arg_list);
+    int idx = 0;
 
     int need_count = ht->element_count;
-    int given_count = arg_list->size;
+    int given_count = argc;
 
     // When set to null, no varargs are wanted
     t_list_object *vararg_obj = NULL;
@@ -151,7 +214,7 @@ static int _parse_calling_arguments(t_vm_stackframe *frame, t_callable_object *c
 
         // If we have values on the calling arg list, use the next value, overriding any default values set.
         if (given_count) {
-            obj = e ? e->data : NULL;
+            obj = idx < argc ? argv[idx] : NULL;
         }
 
         // No more arguments to pass found, so obj MUST be of a value, otherwise caller didn't specify enough arguments.
@@ -169,7 +232,8 @@ static int _parse_calling_arguments(t_vm_stackframe *frame, t_callable_object *c
 
                 // Add first argument
                 if (obj) {
-                    ht_add_num(vararg_obj->data.ht, vararg_obj->data.ht->element_count, obj);
+                    vector_append(vararg_obj->data.vector, obj);
+                    object_inc_ref(obj);
                 }
 
                 // Make sure we add our List[] to the local_identifiers below
@@ -183,16 +247,20 @@ static int _parse_calling_arguments(t_vm_stackframe *frame, t_callable_object *c
             }
         }
 
-        // Everything is ok, add the new value onto the local identifiers
-        ht_add_str(frame->local_identifiers->data.ht, name, obj);
-        object_inc_ref(obj);
+        // Everything is ok, add the new value into its local slot, or onto the local identifiers when the method
+        // does not use the argument directly.
+        if (arg->slot >= 0) {
+            vm_frame_set_local(frame, arg->slot, obj);
+        } else {
+            vm_frame_set_identifier(frame, name, obj);
+        }
 
         need_count--;
         given_count--;
 
         // Next needed element
         ht_iter_next(&iter);
-        if (e) e = DLL_NEXT(e);
+        if (idx < argc) idx++;
     }
 
 
@@ -204,9 +272,10 @@ static int _parse_calling_arguments(t_vm_stackframe *frame, t_callable_object *c
         }
 
         // Just add arguments to vararg list. No need to do any typehint checks here.
-        while (e) {
-            ht_add_num(vararg_obj->data.ht, vararg_obj->data.ht->element_count, e->data);
-            e = DLL_NEXT(e);
+        vector_append_all(vararg_obj->data.vector, (void **)(argv + idx), argc - idx);
+        while (idx < argc) {
+            object_inc_ref(argv[idx]);
+            idx++;
         }
     }
 
@@ -250,6 +319,10 @@ static t_object *vm_create_user_object(t_vm_stackframe *frame, char *name, int f
 
     // Set attributes
     user_obj->attributes = attributes;
+    object_attrib_generation++;
+
+    // Instances start with an empty shape, and add their properties when they are stored
+    user_obj->shape = object_shape_new();
 
     // Iterate attributes and duplicate them into the new user
     t_hash_iter iter;
@@ -263,8 +336,8 @@ static t_object *vm_create_user_object(t_vm_stackframe *frame, char *name, int f
         attrib->data.bound_class = (t_object *)user_obj;
         object_inc_ref((t_object *)user_obj);
 
-        smm_free(attrib->data.bound_name);
-        attrib->data.bound_name = string_strdup0(name);
+        // The key is only owned by the hashtable, unless it is interned
+        attrib->data.bound_name = string_intern(name);
 
         ht_iter_next(&iter);
     }
@@ -275,7 +348,7 @@ static t_object *vm_create_user_object(t_vm_stackframe *frame, char *name, int f
 /**
  * Call a callable with arguments
  */
-static t_object *_object_call_callable_with_args(t_object *self_obj, t_vm_stackframe *scope_frame, char *name, t_callable_object *callable_obj, t_dll *arg_list) {
+static t_object *_object_call_callable_with_args(t_object *self_obj, t_vm_stackframe *scope_frame, char *name, t_callable_object *callable_obj, t_object **argv, int argc) {
     t_object *ret;
 
     // Check if the object is actually a callable
@@ -290,7 +363,7 @@ static t_object *_object_call_callable_with_args(t_object *self_obj, t_vm_stackf
         // @TODO: should internal code not have a frame as well?
 
         // Internal function call
-        return callable_obj->data.code.internal.native_func(self_obj, arg_list);
+        return callable_obj->data.code.internal.native_func(self_obj, argv, argc);
     }
 
 
@@ -300,31 +373,27 @@ static t_object *_object_call_callable_with_args(t_object *self_obj, t_vm_stackf
     char context[1250];
     char args[1000];
     strcpy(args, "");
-    t_dll_element *e = DLL_HEAD(arg_list);
-    while (e) {
+    for (int i=0; i!=argc; i++) {
 #ifdef __DEBUG
-        strcat(args, object_debug(e->data));
+        strcat(args, object_debug(argv[i]));
 #else
         strcat(args, "an object");
 #endif
-        e = DLL_NEXT(e);
-        if (e) strcat(args, ", ");
+        if (i != argc - 1) strcat(args, ", ");
     }
-    snprintf(context, 1249, "%s.%s([%ld args: %s])", self_obj ? self_obj->name : "<anonymous>", callable_obj->name, arg_list->size, args);
+    snprintf(context, 1249, "%s.%s([%d args: %s])", self_obj ? self_obj->name : "<anonymous>", callable_obj->name, argc, args);
 
     // Create a new execution frame
     t_vm_stackframe *parent_frame = thread_get_current_frame();
     t_vm_stackframe *child_frame = vm_stackframe_new(parent_frame, callable_obj->data.code.external.codeframe);
-    child_frame->trace_class = self_obj ? string_strdup0(self_obj->name) : string_strdup0("<anonymous>");
-    child_frame->trace_method = string_strdup0(name);
+    child_frame->trace_class = string_intern(self_obj ? self_obj->name : "<anonymous>");
+    child_frame->trace_method = string_intern(name);
 
     // Create self inside the new frame
-    t_object *old_self_obj = ht_replace_str(child_frame->local_identifiers->data.ht, "self", self_obj);
-    if (old_self_obj) object_release(old_self_obj);
-    object_inc_ref(self_obj);
+    vm_frame_set_local(child_frame, VM_SLOT_SELF, self_obj);
 
     // Parse calling arguments to see if they match our signatures
-    if (! _parse_calling_arguments(child_frame, callable_obj, arg_list)) {
+    if (! _parse_calling_arguments(child_frame, callable_obj, argv, argc)) {
         vm_stackframe_destroy(child_frame);
 
         // Exception thrown in the argument parsing
@@ -412,8 +481,138 @@ static int _check_attrib_visibility(t_object *self, t_attrib_object *attrib) {
 /**
  * Check an attribute and if ok, chck
  */
-static t_object *_object_call_attrib_with_args(t_object *self, t_attrib_object *attrib_obj, t_dll *arg_list) {
-    return _object_call_callable_with_args(self, thread_get_current_frame(), attrib_obj->data.bound_name, (t_callable_object *)attrib_obj->data.attribute, arg_list);
+static t_object *_object_call_attrib_with_args(t_object *self, t_attrib_object *attrib_obj, t_object **argv, int argc) {
+    return _object_call_callable_with_args(self, thread_get_current_frame(), attrib_obj->data.bound_name, (t_callable_object *)attrib_obj->data.attribute, argv, argc);
+}
+
+/**
+ * Returns the arguments of a call as an array. The stack must point to the varargs object (or null_object when no
+ * varargs are needed), with the given number of arguments below it. The arguments stay on the stack until the call
+ * has been made, so in most cases the returned array points directly into the stack. Only when varargs are passed,
+ * a new array will be allocated, which must be freed with _free_calling_arguments().
+ */
+static t_object **_fetch_calling_arguments(t_object **stack, int arg_count, int *argc) {
+    // Attributes are passed by value, so unwrap them on the stack itself. Tagged numericals are boxed, as the
+    // callee can store them anywhere.
+    for (int i=0; i<=arg_count; i++) {
+        if (OBJECT_IS_TAGGED(stack[i])) {
+            stack[i] = object_numerical_box(stack[i]);
+        } else if (OBJECT_IS_ATTRIBUTE(stack[i])) {
+            t_object *value = ((t_attrib_object *)stack[i])->data.attribute;
+            object_inc_ref(value);
+            object_dec_ref(stack[i]);
+            stack[i] = value;
+        }
+    }
+
+    t_list_object *varargs = (t_list_object *)stack[0];
+    t_object **args = stack + 1;
+
+    // Arguments are pushed in order, so they are reversed on the stack. Swap them in-place.
+    for (int i=0, j=arg_count-1; i<j; i++, j--) {
+        t_object *tmp = args[i];
+        args[i] = args[j];
+        args[j] = tmp;
+    }
+
+    if (OBJECT_IS_NULL(varargs)) {
+        *argc = arg_count;
+        return args;
+    }
+
+    // Varargs are added after the normal arguments
+    *argc = arg_count + varargs->data.vector->size;
+    t_object **argv = smm_malloc((*argc + 1) * sizeof(t_object *));
+    memcpy(argv, args, arg_count * sizeof(t_object *));
+    memcpy(argv + arg_count, varargs->data.vector->elements, varargs->data.vector->size * sizeof(t_object *));
+
+    return argv;
+}
+
+/**
+ * Frees the argument array when it was allocated by _fetch_calling_arguments()
+ */
+static void _free_calling_arguments(t_object **stack, t_object **argv) {
+    if (argv != stack + 1) {
+        smm_free(argv);
+    }
+}
+
+/**
+ * Pops the given number of items from the stack, but keeps the return value of a call alive, as it could be one of
+ * the objects that are popped.
+ */
+static void _pop_call_items(t_vm_stackframe *frame, int count, t_object *ret_obj) {
+    object_inc_ref(ret_obj);
+    for (int i=0; i!=count; i++) {
+        vm_frame_stack_pop_attrib(frame);
+    }
+    object_dec_ref(ret_obj);
+}
+
+
+/**
+ * Returns the quickened opcode for an operator on two objects, or 0 when there is no quickened form. Builtin
+ * operator methods are read-only, and subclasses of builtins are user objects, so objects of a builtin type
+ * always use the builtin implementation.
+ */
+static int _quicken_operator(t_object *left_obj, int opr, t_object *right_obj) {
+    if (! OBJECT_IS_NUMERICAL(left_obj) || ! OBJECT_IS_NUMERICAL(right_obj)) return 0;
+
+    switch (opr) {
+        case OPERATOR_ADD : return VM_NUM_ADD;
+        case OPERATOR_SUB : return VM_NUM_SUB;
+        case OPERATOR_MUL : return VM_NUM_MUL;
+    }
+    return 0;
+}
+
+/**
+ * Returns the quickened opcode for a comparison of two objects, or 0 when there is no quickened form.
+ */
+static int _quicken_comparison(t_object *left_obj, int cmp, t_object *right_obj) {
+    if (OBJECT_IS_NUMERICAL(left_obj) && OBJECT_IS_NUMERICAL(right_obj)) {
+        switch (cmp) {
+            case COMPARISON_EQ : return VM_NUM_EQ;
+            case COMPARISON_NE : return VM_NUM_NE;
+            case COMPARISON_LT : return VM_NUM_LT;
+            case COMPARISON_GT : return VM_NUM_GT;
+            case COMPARISON_LE : return VM_NUM_LE;
+            case COMPARISON_GE : return VM_NUM_GE;
+        }
+    }
+
+    if (OBJECT_IS_STRING(left_obj) && OBJECT_IS_STRING(right_obj)) {
+        switch (cmp) {
+            case COMPARISON_EQ : return VM_STR_EQ;
+            case COMPARISON_NE : return VM_STR_NE;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Returns 1 when both strings are equal
+ */
+static int _string_equals(t_string_object *left_obj, t_string_object *right_obj) {
+    if (left_obj->data.value->len != right_obj->data.value->len) return 0;
+    return object_string_compare(left_obj, right_obj) == 0;
+}
+
+/**
+ * Returns the object inside a local variable slot. When nothing is stored (yet) inside the slot, the identifier
+ * could still be a frame or builtin identifier. Returns NULL and creates an exception when not found.
+ */
+static t_object *_load_local(t_vm_stackframe *frame, int slot) {
+    t_object *obj = frame->locals[slot];
+    if (obj) return obj;
+
+    char *s = vm_frame_get_name(frame, slot);
+    obj = vm_frame_find_identifier(frame, s);
+    if (obj == NULL) {
+        thread_create_exception_printf((t_exception_object *)Object_AttributeException, 1, "Identifier '%s' is not found", s);
+    }
+    return obj;
 }
 
 
@@ -477,6 +676,8 @@ void vm_init(SaffireParser *sp, int runmode) {
     if ((runmode & VM_RUNMODE_DEBUG) == VM_RUNMODE_DEBUG) {
         debug_info = dbgp_init();
     }
+
+    vm_select_execute_loop();
 }
 
 void vm_fini(void) {
@@ -485,6 +686,9 @@ void vm_fini(void) {
         dbgp_fini(debug_info);
     }
 
+    // Collect the cycles that are left, while everything they reference still exists
+    gc_collect();
+
     // Free all imported codeframes
     vm_import_cache_fini();
 
@@ -501,7 +705,12 @@ void vm_fini(void) {
 
     module_fini();
     object_fini();
+
+    // Recycle queue statistics are gone after gc_fini()
+    gc_debug_stats();
     gc_fini();
+
+    utf8_locale_fini();
 }
 
 int getlineno(t_vm_stackframe *frame) {
@@ -538,1200 +747,79 @@ int getlineno(t_vm_stackframe *frame) {
 t_vm_frameblock *unwind_blocks(t_vm_stackframe *frame, long *reason, t_object *ret);
 
 /**
- *
+ * Returns the opcode handler addresses that are used by the threaded dispatcher, or NULL when the
+ * VM uses switch() dispatching.
  */
-t_object *_vm_execute(t_vm_stackframe *frame) {
-    t_object *obj1, *obj2, *obj3, *obj4;
-    t_object *left_obj, *right_obj;
-    t_attrib_object *attr_obj;
-    unsigned int opcode, oparg1, oparg2, oparg3;
-    long reason = REASON_NONE;
-    t_object *dst;
-    char *s;
-
-
-#ifdef __DEBUG
-    if (frame->local_identifiers) print_debug_table(frame->local_identifiers->data.ht, "Locals");
-    if (frame->frame_identifiers) print_debug_table(frame->frame_identifiers->data.ht, "Frame");
-    if (frame->global_identifiers) print_debug_table(frame->global_identifiers->data.ht, "Globals");
-#endif
-
-
-#ifdef __DEBUG
-    DEBUG_PRINT_CHAR(ANSI_BRIGHTRED "------------ NEW FRAME ------------\n" ANSI_RESET);
-    t_vm_stackframe *tb_frame = frame;
-    int tb_depth = 0;
-    while (tb_frame) {
-        DEBUG_PRINT_CHAR(ANSI_BRIGHTBLUE "#%d "
-                ANSI_BRIGHTYELLOW "%s:%d "
-                ANSI_BRIGHTGREEN "[%s] %s::%s"
-                ANSI_BRIGHTGREEN "(<args>)"
-                ANSI_RESET "\n",
-                tb_depth,
-                tb_frame->codeframe->context->file.full ? tb_frame->codeframe->context->file.full : "<none>",
-                getlineno(tb_frame),
-                tb_frame->codeframe->context->class.full ? tb_frame->codeframe->context->class.full : "",
-                tb_frame->trace_class ? tb_frame->trace_class : "",
-                tb_frame->trace_method ? tb_frame->trace_method : ""
-            );
-        tb_frame = tb_frame->parent;
-        tb_depth++;
+void **vm_get_dispatch_table(void) {
+#ifdef VM_THREADED_DISPATCH
+    if (! vm_dispatch_table) {
+        _vm_execute_fast(NULL);
     }
-    DEBUG_PRINT_CHAR(ANSI_BRIGHTRED "-----------------------------------\n" ANSI_RESET);
-#endif
-
-    // Set the correct current frame
-    t_vm_stackframe *parent_frame = thread_get_current_frame();
-    thread_set_current_frame(frame);
-
-    // Default return value;
-    t_object *ret = NULL;
-
-    for (;;) {
-
-
-        // Room for some other stuff
-dispatch:
-        // Increase number of executions done
-        frame->executions++;
-
-
-#ifdef __DEBUG
-    #if __DEBUG_VM_OPCODES
-        int ln = getlineno(frame);
-        unsigned long cip = frame->ip;
-        //vm_frame_stack_debug(frame);
-    #endif
-#endif
-
-
-
-        // Only do this when we are debugging and the debugger is attached
-        if ((vm_runmode & VM_RUNMODE_DEBUG) == VM_RUNMODE_DEBUG && debug_info->attached) {
-            dbgp_debug(debug_info, frame);
-        }
-
-
-
-        // Get opcode and additional argument
-        opcode = vm_frame_get_next_opcode(frame);
-
-        // If high bit is set, get operand
-        oparg1 = ((opcode & 0x80) == 0x80) ? vm_frame_get_operand(frame) : 0;
-        oparg2 = ((opcode & 0xC0) == 0xC0) ? vm_frame_get_operand(frame) : 0;
-        oparg3 = ((opcode & 0xE0) == 0xE0) ? vm_frame_get_operand(frame) : 0;
-
-#ifdef __DEBUG
-    #if __DEBUG_VM_OPCODES
-        if ((opcode & 0xE0) == 0xE0) {
-            DEBUG_PRINT_CHAR(ANSI_BRIGHTBLUE "%08lX "
-                        ANSI_BRIGHTGREEN "%-20s (0x%02X, 0x%02X, 0x%02X)     "
-                        ANSI_BRIGHTYELLOW "[%s:%d] "
-                        "\n" ANSI_RESET,
-                        cip,
-                        vm_code_names[vm_codes_offset[opcode]],
-                        oparg1, oparg2, oparg3,
-                        frame->codeframe->bytecode->source_filename,
-                        ln
-                    );
-            } else if ((opcode & 0xC0) == 0xC0) {
-            DEBUG_PRINT_CHAR(ANSI_BRIGHTBLUE "%08lX "
-                        ANSI_BRIGHTGREEN "%-20s (0x%02X, 0x%02X)           "
-                        ANSI_BRIGHTYELLOW "[%s:%d] "
-                        "\n" ANSI_RESET,
-                        cip,
-                        vm_code_names[vm_codes_offset[opcode]],
-                        oparg1, oparg2,
-                        frame->codeframe->bytecode->source_filename,
-                        ln
-                    );
-        } else if ((opcode & 0x80) == 0x80) {
-            DEBUG_PRINT_CHAR(ANSI_BRIGHTBLUE "%08lX "
-                        ANSI_BRIGHTGREEN "%-20s (0x%02X)                 "
-                        ANSI_BRIGHTYELLOW "[%s:%d] "
-                        "\n" ANSI_RESET,
-                        cip,
-                        vm_code_names[vm_codes_offset[opcode]],
-                        oparg1,
-                        frame->codeframe->bytecode->source_filename,
-                        ln
-                    );
-        } else {
-            DEBUG_PRINT_CHAR(ANSI_BRIGHTBLUE "%08lX "
-                        ANSI_BRIGHTGREEN "%-20s                        "
-                        ANSI_BRIGHTYELLOW "[%s:%d] "
-                        "\n" ANSI_RESET,
-                        cip,
-                        vm_code_names[vm_codes_offset[opcode]],
-                        frame->codeframe->bytecode->source_filename,
-                        ln
-                    );
-        }
-    #endif
+    return vm_dispatch_table;
+#else
+    return NULL;
 #endif
+}
 
 
-
-
-
-        if (opcode == VM_STOP) break;
-        if (opcode == VM_RESERVED) {
-            fatal_error(1, "VM: Reached reserved (0xFF) opcode. Halting.\n");       /* LCOV_EXCL_LINE */
-        }
-
-
-        switch (opcode) {
-            // Removes SP-0
-            case VM_POP_TOP :
-                obj1 = vm_frame_stack_pop(frame);
-                goto dispatch;
-                break;
-
-            // Rotate / swap SP-0 and SP-1
-            case VM_ROT_TWO :
-                obj1 = vm_frame_stack_pop(frame);
-                obj2 = vm_frame_stack_pop(frame);
-                vm_frame_stack_push(frame, obj1);
-                vm_frame_stack_push(frame, obj2);
-                goto dispatch;
-                break;
-
-            // Rotate SP-0 to SP-2
-            case VM_ROT_THREE :
-                obj1 = vm_frame_stack_pop(frame);
-                obj2 = vm_frame_stack_pop(frame);
-                obj3 = vm_frame_stack_pop(frame);
-                vm_frame_stack_push(frame, obj1);
-                vm_frame_stack_push(frame, obj2);
-                vm_frame_stack_push(frame, obj3);
-                goto dispatch;
-                break;
-
-            // Duplicate SP-0
-            case VM_DUP_TOP :
-                obj1 = vm_frame_stack_fetch_top(frame);
-                // increasing refcount because we now have 2 references onto the stack
-                object_inc_ref(obj1);
-                vm_frame_stack_push(frame, obj1);
-                goto dispatch;
-                break;
-
-            // Rotate SP-0 to SP-3
-            case VM_ROT_FOUR :
-                obj1 = vm_frame_stack_pop(frame);
-                obj2 = vm_frame_stack_pop(frame);
-                obj3 = vm_frame_stack_pop(frame);
-                obj4 = vm_frame_stack_pop(frame);
-                vm_frame_stack_push(frame, obj1);
-                vm_frame_stack_push(frame, obj2);
-                vm_frame_stack_push(frame, obj3);
-                vm_frame_stack_push(frame, obj4);
-                goto dispatch;
-                break;
-
-            // No operation
-            case VM_NOP :
-                // Do nothing..
-                goto dispatch;
-                break;
-
-            // Load an attribute from an object
-            case VM_LOAD_ATTRIB :
-                {
-                    // The object to load the attribute from.
-                    t_object *self_obj = vm_frame_stack_pop(frame);
-
-                    // Name of attribute to load
-                    t_object *name_obj = vm_frame_get_constant(frame, oparg1);
-                    char *name = string_to_char(OBJ2STR(name_obj));
-
-                    // Scope of the loading (start from self. or parent.)
-                    int scope = oparg2;
-
-                    DEBUG_PRINT_CHAR("Loading attribute: '%s' from '%s' (scope: %s')\n", name, self_obj->name, scope == OBJECT_SCOPE_SELF ? "self" : "parent");
-
-                    // The object where we start looking for attributes (either self or parent)
-                    t_object *offset_obj = self_obj;
-
-                    // If we need the parent scope (parent.whatever), just move directly to the parent class before looking
-                    if (scope == OBJECT_SCOPE_PARENT) {
-                        if (self_obj->parent == NULL) {
-                            // @TODO: We should throw an exception, as we don't have a parent class. Can only happen
-                            // when we are inside the base-class, and we do: parent.whatever
-                            return NULL;
-                        }
-                        // We should start in parent object
-                        offset_obj = self_obj->parent;
-                    }
-
-                    t_attrib_object *attrib_obj = object_attrib_find(offset_obj, name);
-                    if (attrib_obj == NULL) {
-                        reason = REASON_EXCEPTION;
-                        thread_create_exception_printf((t_exception_object *)Object_AttributeException, 1, "Attribute '%s' in class '%s' not found", name, self_obj->name);
-                        smm_free(name);
-                        goto block_end;
-                        break;
-                    }
-
-                    // Make sure we are not loading a non-static attribute from a static context
-                    if (! _check_attribute_for_static_call(self_obj, attrib_obj)) {
-                        thread_create_exception_printf((t_exception_object *)Object_CallableException, 1, "Cannot call dynamic method '%s' from class '%s'\n", attrib_obj->data.bound_name, self_obj->name);
-                        smm_free(name);
-                        reason = REASON_EXCEPTION;
-                        goto block_end;
-                    }
-
-                    // Check visibility of attribute
-                    if (! _check_attrib_visibility(self_obj, attrib_obj)) {
-                        thread_create_exception_printf((t_exception_object *)Object_VisibilityException, 1, "Visibility does not allow to fetch attribute '%s'\n", OBJ2STR(name));
-                        smm_free(name);
-                        reason = REASON_EXCEPTION;
-                        goto block_end;
-                    }
-
-                    smm_free(name);
-
-                    // We don't actually use the original attribute, but a duplicated one. Here we add our reference to the
-                    // current object so we can do correct calls to the attributes method.
-                    attrib_obj = object_attrib_duplicate(attrib_obj, self_obj);
-                    DEBUG_PRINT_CHAR("Loaded attribute: %s.%s\n", self_obj->name, attrib_obj->data.bound_name);
-
-                    vm_frame_stack_push(frame, (t_object *)attrib_obj);
-                }
-                goto dispatch;
-                break;
-
-            // Store an attribute into an object
-            case VM_STORE_ATTRIB :
-                {
-                    t_object *name_obj = vm_frame_get_constant(frame, oparg1);
-                    t_object *search_obj = vm_frame_stack_pop(frame);
-
-                    s = string_to_char(OBJ2STR(name_obj));
-                    t_attrib_object *attrib_obj = object_attrib_find(search_obj, s);
-                    smm_free(s);
-
-                    if (attrib_obj && ATTRIB_IS_READONLY(attrib_obj)) {
-                        thread_create_exception_printf((t_exception_object *)Object_VisibilityException, 1, "Cannot write to readonly attribute '%s'\n", OBJ2STR(name_obj));
-                        reason = REASON_EXCEPTION;
-                        goto block_end;
-                    }
-                    if (attrib_obj && ! _check_attrib_visibility(search_obj, attrib_obj)) {
-                        thread_create_exception_printf((t_exception_object *)Object_VisibilityException, 1, "Visibility does not allow to access attribute '%s'\n", OBJ2STR(name_obj));
-                        reason = REASON_EXCEPTION;
-                        goto block_end;
-                    }
-
-                    // @TODO: if we don't have a attrib_obj, we just add a new attribute to the object (RW/PUBLIC)
-                    // @TODO: Not everything is a property by default. Check value to make sure it's a property or a method
-                    t_object *value = vm_frame_stack_pop(frame);
-                    s = string_to_char(OBJ2STR(name_obj));
-                    object_add_property(search_obj, s, ATTRIB_TYPE_PROPERTY | ATTRIB_ACCESS_RW | ATTRIB_VISIBILITY_PUBLIC, value);
-                    smm_free(s);
-                }
-                goto dispatch;
-                break;
-
-            // store SP+0 as a frame identifier
-            case VM_STORE_FRAME_ID :
-                // Refcount stays equal. So no inc/dec ref needed
-                dst = vm_frame_stack_pop(frame);
-                s = vm_frame_get_name(frame, oparg1);
-                vm_frame_set_frame_identifier(frame, s, dst);
-                goto dispatch;
-                break;
-
-
-//            // Load a global identifier
-//            case VM_LOAD_GLOBAL :
-//                dst = vm_frame_get_global_identifier(frame, oparg1);
-//                vm_frame_stack_push(frame, dst);
-//                goto dispatch;
-//                break;
-//
-//            // store SP+0 as a global identifier
-//            case VM_STORE_GLOBAL :
-//                // Refcount stays equal. So no inc/dec ref needed
-//                dst = vm_frame_stack_pop(frame);
-//                name = vm_frame_get_name(frame, oparg1);
-//                vm_frame_set_global_identifier(frame, name, dst);
-//                goto dispatch;
-//                break;
-//
-//            // Remove global identifier
-//            case VM_DELETE_GLOBAL :
-//                dst = vm_frame_get_global_identifier(frame, oparg1);
-//                name = vm_frame_get_name(frame, oparg1);
-//                vm_frame_set_global_identifier(frame, name, NULL);
-//                goto dispatch;
-//                break;
-
-            // Load and push constant onto stack
-            case VM_LOAD_CONST :
-                dst = vm_frame_get_constant(frame, oparg1);
-                vm_frame_stack_push(frame, dst);
-                goto dispatch;
-                break;
-
-            // Store SP+0 into identifier (either local or global)
-            case VM_STORE_ID :
-                // Refcount stays equal. So no inc/dec ref needed
-                dst = vm_frame_stack_pop(frame);
-                s = vm_frame_get_name(frame, oparg1);
-                vm_frame_set_identifier(frame, s, dst);
-                goto dispatch;
-                break;
-
-            // Load and push identifier onto stack (either local or global)
-            case VM_LOAD_ID :
-                s = vm_frame_get_name(frame, oparg1);
-                dst = vm_frame_find_identifier(frame, s);
-                if (dst == NULL) {
-                    reason = REASON_EXCEPTION;
-                    thread_create_exception_printf((t_exception_object *)Object_AttributeException, 1, "Identifier '%s' is not found", s, dst);
-                    goto block_end;
-                    break;
-                }
-
-                vm_frame_stack_push(frame, dst);
-                goto dispatch;
-                break;
-
-            //
-            case VM_OPERATOR :
-                right_obj = vm_frame_stack_pop(frame);
-                left_obj = vm_frame_stack_pop(frame);
-
-                if (left_obj->type != right_obj->type) {
-                    fatal_error(1, "Types are not equal. Coersing needed, but not yet implemented\n");      /* LCOV_EXCL_LINE */
-                }
-                dst = vm_object_operator(left_obj, oparg1, right_obj);
-                if (! dst) {
-                    reason = REASON_EXCEPTION;
-                    goto block_end;
-                    break;
-                }
-
-                vm_frame_stack_push(frame, dst);
-                goto dispatch;
-                break;
-
-            // Unconditional relative jump forward
-            case VM_JUMP_FORWARD :
-                frame->ip += oparg1;
-                goto dispatch;
-                break;
-
-            // Conditional jump on SP-0 is true
-            case VM_JUMP_IF_TRUE :
-                dst = vm_frame_stack_fetch_top(frame);
-                if (! OBJECT_IS_BOOLEAN(dst)) {
-                    // Cast to boolean
-                    t_attrib_object *bool_method = object_attrib_find(dst, "__boolean");
-                    dst = vm_object_call(dst, bool_method, 0);
-                }
-
-                if (IS_BOOLEAN_TRUE(dst)) {
-                    frame->ip += oparg1;
-                }
-
-                goto dispatch;
-                break;
-
-            // Conditional jump on SP-0 is false
-            case VM_JUMP_IF_FALSE :
-                dst = vm_frame_stack_fetch_top(frame);
-                if (! OBJECT_IS_BOOLEAN(dst)) {
-                    // Cast to boolean
-                    t_attrib_object *bool_method = object_attrib_find(dst, "__boolean");
-                    dst = vm_object_call(dst, bool_method, 0);
-                }
-
-                if (IS_BOOLEAN_FALSE(dst)) {
-                    frame->ip += oparg1;
-                }
-                goto dispatch;
-                break;
-
-            case VM_JUMP_IF_FIRST_TRUE :
-                dst = vm_frame_stack_fetch_top(frame);
-                if (! OBJECT_IS_BOOLEAN(dst)) {
-                    // Cast to boolean
-                    t_attrib_object *bool_method = object_attrib_find(dst, "__boolean");
-                    dst = vm_object_call(dst, bool_method, 0);
-                }
-
-                // @TODO: We assume that this opcode has at least 1 block!
-                if (IS_BOOLEAN_TRUE(dst) && frame->blocks[frame->block_cnt-1].visited == 0) {
-                    frame->ip += oparg1;
-                }
-
-                // We have visited this frame
-                frame->blocks[frame->block_cnt-1].visited = 1;
-                goto dispatch;
-                break;
-
-            case VM_JUMP_IF_FIRST_FALSE :
-                dst = vm_frame_stack_fetch_top(frame);
-                if (! OBJECT_IS_BOOLEAN(dst)) {
-                    // Cast to boolean
-                    t_attrib_object *bool_method = object_attrib_find(dst, "__boolean");
-                    dst = vm_object_call(dst, bool_method, 0);
-                }
-
-                // @TODO: We assume that this opcode has at least 1 block!
-                if (IS_BOOLEAN_FALSE(dst) && frame->blocks[frame->block_cnt-1].visited == 0) {
-                    frame->ip += oparg1;
-                }
-
-                // We have visited this frame
-                frame->blocks[frame->block_cnt-1].visited = 1;
-                goto dispatch;
-                break;
-
-            // Unconditional absolute jump
-            case VM_JUMP_ABSOLUTE :
-                frame->ip = oparg1;
-                goto dispatch;
-                break;
-
-            // Duplicates the SP+0 a number of times
-            case VM_DUP_TOPX :
-                dst = vm_frame_stack_fetch_top(frame);
-                for (int i=0; i!=oparg1; i++) {
-                    vm_frame_stack_push(frame, dst);
-                }
-                goto dispatch;
-                break;
-
-            // Calls an callable attribute from SP-0 with OP+0 args starting from SP-1
-            case VM_CALL :
-                {
-                    // Fetch methods to call
-                    obj1 = vm_frame_stack_pop_attrib(frame);
-                    if (
-                         ! (OBJECT_IS_ATTRIBUTE(obj1) && ATTRIB_IS_METHOD(obj1)) &&
-                         ! (OBJECT_TYPE_IS_CLASS(obj1))
-                       ) {
-                        reason = REASON_EXCEPTION;
-                        thread_create_exception_printf((t_exception_object *)Object_AttributeException, 1, "'%s' is must be a class or callable", OBJ2STR(obj1));
-                        goto block_end;
-                        break;
-                    }
-
-                    t_object *self;
-
-                    // Check if we are a calling a class, if so, we are actually instantiating it
-                    if (OBJECT_TYPE_IS_CLASS(obj1)) {
-                        // Do actual instantiation (pass nothing)
-                        t_attrib_object *new_method = object_attrib_find(obj1, "__new");
-                        self = vm_object_call(obj1, new_method, 0);
-
-                        // We continue the function, but using the constructor as our attribute
-                        obj1 = (t_object *)object_attrib_find(self, "__ctor");
-                    } else {
-                        // Otherwise, we are just calling an attribute from an instance.
-                        self = ((t_attrib_object *)obj1)->data.bound_instance;
-                    }
-
 /*
-WE NEED TO CALL AN OBJECT FROM THEIR OWN CONTEXT. FOR INSTANCE, WHEN WE CALL A METHOD THAT USES "IO", WE MUST
-MAKE SURE THAT THIS IO CLASS IS INSIDE THE CURRENT FRAME. PROBABLY THE BEST WAY TO DEAL WITH THIS IS TO STORE
-A REFERENCE TO THE FRAME INSIDE AN OBJECT (DO WE?), OR SOMEWAY TO FIGURE OUT NOT ONLY WHAT WE MEAN WITH "IO", BUT
-ALSO IN WHICH FRAME THIS IO CLASS RESIDES.
-
-So:
-    Frame 1:
-        import io;
-        io.print("foobar");
-    Frame 2:
-        import foobar;
-        class io {
-            public method print(s) {
-                foobar.print(s);
-            }
-        }
-        a = 1;
-
-        * uses io-object as located in the io class. We resolve io from the current frame (frame 1).
-        * when we call the print-method, we must make sure we call this from a new stack-frame. However, this stack-frame must
-        * contain the "foobar" reference, the actual io-class, and the variable "a". "a" in this case is a variable known in the
-        * current namespace only. We can reference it as "a", but we cannot reference this from another frame.
-
-*/
-
-
-
-                    // Create argument list inside a DLL
-                    t_dll *arg_list = dll_init();
-
-                    // Fetch varargs object (or null_object when no varargs are needed)
-                    t_list_object *varargs = (t_list_object *)vm_frame_stack_pop(frame);
-
-                    // Add items
-                    for (int i=0; i!=oparg1; i++) {
-                        // We pop arguments, but we add it to a dll, don't decrease refcount, but we must do so
-                        // when we finish with our dll
-                        dll_prepend(arg_list, vm_frame_stack_pop(frame));
-                    }
-
-                    if (! OBJECT_IS_NULL(varargs)) {
-                        // iterate hash (this is the correct order), and prepend values to the arg_list DLL
-                        t_hash_iter iter;
-                        ht_iter_init(&iter, varargs->data.ht);
-                        while (ht_iter_valid(&iter)) {
-                            t_object *obj = ht_iter_value(&iter);
-                            dll_append(arg_list, obj);
-                            ht_iter_next(&iter);
-                        }
-                    }
-
-                    t_object *ret_obj = _object_call_attrib_with_args(self, (t_attrib_object *)obj1, arg_list);
-
-                    // @TODO: decref our arguments here
-                    dll_free(arg_list);
-
-                    if (ret_obj == NULL) {
-                        // NULL returned means exception occurred.
-                        reason = REASON_EXCEPTION;
-                        goto block_end;
-                        break;
-                    }
-
-                    vm_frame_stack_push(frame, ret_obj);
-                }
-
-                goto dispatch;
-                break;
-
-            // Import X as Y from Z
-            case VM_IMPORT :
-                {
-                    // Fetch the module to import
-                    t_object *module_obj = vm_frame_stack_pop(frame);
-                    char *module_name = string_to_char(OBJ2STR(module_obj));
-
-                    // Fetch class
-                    t_object *class_obj = vm_frame_stack_pop(frame);
-                    char *class_name = string_to_char(OBJ2STR(class_obj));
-                    char *orig_class_name = class_name;
-
-                    // Check for namespace separator, and use only the class name, not the modules.
-                    char *separator_pos = strrchr(class_name, ':');
-                    if (separator_pos != NULL) {
-                        class_name = separator_pos + 1;
-                    }
-
-                    dst = vm_import(frame->codeframe, module_name, class_name);
-
-                    smm_free(module_name);
-                    smm_free(orig_class_name);
-
-
-                    if (!dst) {
-                        reason = REASON_EXCEPTION;
-                        goto block_end;
-                    }
-
-                    vm_frame_stack_push(frame, dst);
-                }
-                goto dispatch;
-                break;
-
-            // Sets up loop block
-            case VM_SETUP_LOOP :
-                vm_push_block_loop(frame, BLOCK_TYPE_LOOP, frame->sp, frame->ip + oparg1, 0);
-                goto dispatch;
-                break;
-
-            // Sets up loop block with else clause
-            case VM_SETUP_ELSE_LOOP :
-                vm_push_block_loop(frame, BLOCK_TYPE_LOOP, frame->sp, frame->ip + oparg1, frame->ip + oparg2);
-                goto dispatch;
-                break;
-
-            // Pops the most inner loop-block
-            case VM_POP_BLOCK :
-                vm_pop_block(frame);
-                goto dispatch;
-                break;
-
-            // Continue the most inner loop-block
-            case VM_CONTINUE_LOOP :
-                ret = object_alloc(Object_Numerical, 1, oparg1);
-                reason = REASON_CONTINUE;
-                goto block_end;
-                break;
-
-            // Breaks out a loop-block
-            case VM_BREAK_LOOP :
-                reason = REASON_BREAK;
-                goto block_end;
-                break;
-
-            // Breaks out a loop-block, and continue with the else clause
-            case VM_BREAKELSE_LOOP :
-                reason = REASON_BREAKELSE;
-                goto block_end;
-                break;
-
-            // Compare 2 objects and push a boolean(true) or boolean(false) object back onto the stack
-            case VM_COMPARE_OP :
-                left_obj = vm_frame_stack_pop(frame);
-                    right_obj = vm_frame_stack_pop(frame);
-
-                // @TODO: EQ and NE can be checked here as well. Or could we "override" them anyway? Store them inside
-                // the base class!
-
-                if (oparg1 == COMPARISON_RE || oparg1 == COMPARISON_NRE) {
-
-                    if (! OBJECT_IS_REGEX(right_obj)) {
-                        reason = REASON_EXCEPTION;
-                        thread_create_exception_printf((t_exception_object *)Object_TypeException, 1, "Can only regmatch against a regular expression");
-                        goto block_end;
-                    }
-
-                    if (! OBJECT_IS_STRING(left_obj)) {
-                        reason = REASON_EXCEPTION;
-                        thread_create_exception_printf((t_exception_object *)Object_TypeException, 1, "Can only regmatch a string");
-                        goto block_end;
-                    }
-
-
-                    t_object *ret_obj = _do_regex_match((t_regex_object *)right_obj, (t_string_object *)left_obj);
-                    if (! ret_obj) {
-                        reason = REASON_EXCEPTION;
-                        goto block_end;
-                    }
-
-                    if (oparg1 == COMPARISON_NRE) {
-                        // Inverse the result, as we are NOT matching.
-                        ret_obj = (ret_obj == Object_True) ? Object_False : Object_True;
-                    }
-
-                    vm_frame_stack_push(frame, ret_obj);
-                    goto dispatch;
-                }
-
-
-                // Exception compare is special case. We don't let classes handle that themselves, but we
-                // need to do it here.
-                if (oparg1 == COMPARISON_EX) {
-                    if (object_instance_of(right_obj, left_obj->name)) {
-                        vm_frame_stack_push(frame, Object_True);
-                    } else {
-                        vm_frame_stack_push(frame, Object_False);
-                    }
-                    goto dispatch;
-                    break;
-                }
-
-                DEBUG_PRINT_CHAR("Compare '%s (%d)' against '%s (%d)'\n", left_obj->name, left_obj->type, right_obj->name, right_obj->type);
-
-                // Compare types do not match
-                if (left_obj->type != right_obj->type && !(OBJECT_IS_NULL(left_obj) || OBJECT_IS_NULL(right_obj))) {
-
-                    // Try an implicit cast if possible
-                    DEBUG_PRINT_CHAR("Explicit casting '%s' to '%s'\n", right_obj->name, left_obj->name);
-                    t_attrib_object *cast_method = object_attrib_find(right_obj, left_obj->name);
-                    if (! cast_method) {
-                        reason = REASON_EXCEPTION;
-                        thread_create_exception_printf((t_exception_object *)Object_TypeException, 1, "Cannot compare '%s' against '%s'", left_obj->name, right_obj->name);
-                        goto block_end;
-                    }
-                    right_obj = vm_object_call(right_obj, cast_method, 0);
-                    if (! right_obj) {
-                        reason = REASON_EXCEPTION;
-                        goto block_end;
-                    }
-                }
-
-                dst = vm_object_comparison(left_obj, oparg1, right_obj);
-                if (! dst) {
-                    reason = REASON_EXCEPTION;
-                    goto block_end;
-                    break;
-                }
-
-                vm_frame_stack_push(frame, dst);
-                goto dispatch;
-                break;
-
-            // Build an attribute object from the values of the stack, and push attribute object back onto the stack
-            case VM_BUILD_ATTRIB :
-                {
-                    // pop access object
-                    t_object *access = vm_frame_stack_pop(frame);
-
-                    // pop visibility object
-                    t_object *visibility = vm_frame_stack_pop(frame);
-
-                    // pop value object
-                    t_object *value_obj = vm_frame_stack_pop(frame);
-
-                    int method_flags = 0;
-
-                    if (oparg1 == ATTRIB_TYPE_METHOD) {
-                        // Pop method flags (not used yet)
-                        t_object *method_flag_obj = vm_frame_stack_pop(frame);
-                        method_flags = OBJ2NUM(method_flag_obj);
-
-                        // Generate hash object from arguments
-                        t_hash_table *arg_list = ht_create();
-                        for (int i=0; i!=oparg2; i++) {
-                            t_method_arg *arg = smm_malloc(sizeof(t_method_arg));
-                            arg->value = vm_frame_stack_pop(frame);
-                            t_object *name_obj = vm_frame_stack_pop(frame);
-                            arg->typehint = (t_string_object *)vm_frame_stack_pop(frame);
-
-                            object_inc_ref((t_object *)arg->value);
-                            object_inc_ref((t_object *)arg->typehint);
-
-                            s = string_to_char(OBJ2STR(name_obj));
-                            ht_add_str(arg_list, s, arg);
-                            smm_free(s);
-                        }
-
-                        // Value object is already a callable, but has no arguments (or binding). Here we add the arglist
-                        // @TODO: this means we cannot re-use the same codeblock with different args (which makes sense). Make sure
-                        // this works.
-                        ((t_callable_object *)value_obj)->data.arguments = arg_list;
-                    }
-                    if (oparg1 == ATTRIB_TYPE_CONSTANT) {
-                        // Nothing additional to do for constants
-                    }
-                    if (oparg1 == ATTRIB_TYPE_PROPERTY) {
-                        // Nothing additional to do for regular properties
-                    }
-
-                    // Create new attribute object
-                    dst = object_alloc(Object_Attrib, 7, NULL, "", oparg1, OBJ2NUM(visibility), OBJ2NUM(access), value_obj, method_flags);
-
-                    // Push method object
-                    vm_frame_stack_push(frame, dst);
-
-                    vm_frame_register_userobject(frame, (t_object *)dst);
-                }
-                goto dispatch;
-                break;
-
-            // Build interface or class from the values on the stack and push the object back onto the stack
-            case VM_BUILD_INTERFACE :
-            case VM_BUILD_CLASS :
-                {
-                    // pop class flags (abstract,
-                    // @TODO: Do we need to mask certain flags, as they should not be set directly through opcodes?
-                    obj1 = vm_frame_stack_pop(frame);
-                    int flags = OBJ2NUM(obj1);
-
-                    // Depending on the opcode, we are building a class or an interface
-                    if (opcode == VM_BUILD_CLASS) {
-                        flags |= OBJECT_TYPE_CLASS;
-                    } else {
-                        flags |= OBJECT_TYPE_INTERFACE;
-                    }
-
-
-                    // Pop the number of interfaces
-                    t_dll *interfaces = dll_init();
-                    t_object *interface_cnt_obj = vm_frame_stack_pop(frame);
-                    long interface_cnt = OBJ2NUM(interface_cnt_obj);
-                    DEBUG_PRINT_CHAR("Number of interfaces we need to implement: %ld\n", interface_cnt);
-
-                    // Fetch all interface objects
-                    for (int i=0; i!=interface_cnt; i++) {
-                        t_object *interface_name_obj = vm_frame_stack_pop(frame);
-                        DEBUG_PRINT_STRING(char0_to_string("Implementing interface: %s\n"), object_debug(interface_name_obj));
-
-                        // Check if the interface actually exists
-                        s = string_to_char(OBJ2STR(interface_name_obj));
-                        t_object *interface_obj = vm_frame_find_identifier(thread_get_current_frame(), s);
-                        smm_free(s);
-                        if (! interface_obj) {
-                            dll_free(interfaces);
-
-                            reason = REASON_EXCEPTION;
-                            thread_create_exception_printf((t_exception_object *)Object_TypeException, 1, "Interface '%s' is not found", OBJ2STR(interface_name_obj));
-                            goto block_end;
-                        }
-                        if (! OBJECT_TYPE_IS_INTERFACE(interface_obj)) {
-                            dll_free(interfaces);
-
-                            reason = REASON_EXCEPTION;
-                            thread_create_exception_printf((t_exception_object *)Object_TypeException, 1, "'%s' is not an interface", OBJ2STR(interface_name_obj));
-                            goto block_end;
-                        }
-
-                        dll_append(interfaces, interface_obj);
-                    }
-
-
-                    // pop parent code object (as string)
-                    t_object *parent_class = vm_frame_stack_pop(frame);
-                    if (OBJECT_IS_NULL(parent_class)) {
-                        parent_class = Object_Base;
-                        object_inc_ref(parent_class);
-                    } else {
-                        // Find the object of this string
-                        s = string_to_char(OBJ2STR(parent_class));
-                        parent_class = vm_frame_find_identifier(frame, s);
-                        smm_free(s);
-                        if (parent_class == NULL) {
-                            reason = REASON_EXCEPTION;
-                            thread_create_exception_printf((t_exception_object *)Object_AttributeException, 1, "Class '%s' not found", parent_class);
-                            goto block_end;
-                            break;
-                        }
-
-                    }
-
-
-                    // pop class name
-                    t_object *name_obj = vm_frame_stack_pop(frame);
-                    char *name = string_to_char(OBJ2STR(name_obj));
-
-                    // Fetch all attributes
-                    t_hash_table *attributes = ht_create();
-                    for (int i=0; i!=oparg1; i++) {
-                        t_object *name = vm_frame_stack_pop(frame);
-                        t_attrib_object *attrib_obj = (t_attrib_object *)vm_frame_stack_pop_attrib(frame);
-
-                        object_inc_ref((t_object *)attrib_obj);
-
-                        // Add method attribute to class
-                        s = string_to_char(OBJ2STR(name));
-                        ht_add_str(attributes, s, attrib_obj);
-                        smm_free(s);
-                    }
-
-                    // Actually create the object
-                    t_object *new_obj = vm_create_user_object(frame, name, flags, interfaces, parent_class, attributes);
-
-                    smm_free(name);
-
-                    // Check if the build class actually got all interfaces implemented
-                    if (opcode == VM_BUILD_CLASS && ! object_check_interface_implementations((t_object *)new_obj)) {
-                        reason = REASON_EXCEPTION;
-                        goto block_end;
-                    }
-
-                    // All done
-                    vm_frame_stack_push(frame, (t_object *)new_obj);
-
-                    vm_frame_register_userobject(frame, (t_object *)new_obj);
-                }
-
-                goto dispatch;
-                break;
-
-            // Return / end the current frame
-            case VM_RETURN :
-                // Pop "ret" from the stack
-                ret = vm_frame_stack_pop(frame);
-
-                reason = REASON_RETURN;
-                goto block_end;
-                break;
-
-            // Setup an exception try/catch block
-            case VM_SETUP_EXCEPT :
-                vm_push_block_exception(frame, BLOCK_TYPE_EXCEPTION, frame->sp, frame->ip + oparg1, frame->ip + oparg2, frame->ip + oparg3);
-                vm_frame_stack_push(frame, object_alloc(Object_Numerical, 1, REASON_FINALLY));
-
-                goto dispatch;
-                break;
-
-            // Setup an exception try/catch block with finally clause
-            case VM_END_FINALLY :
-                ret = vm_frame_stack_pop(frame);
-
-                if (OBJECT_IS_NUMERICAL(ret)) {
-                    reason = OBJ2NUM(ret);
-
-                    if (reason == REASON_RETURN || reason == REASON_CONTINUE) {
-                        ret = vm_frame_stack_pop(frame);
-                    }
-                    goto block_end;
-                    break;
-                } else if (OBJECT_IS_EXCEPTION(ret)) {
-                    reason = REASON_RERAISE;
-                    ret = NULL;
-                    goto block_end;
-                    break;
-
-                } else {
-                    // This should not happen (oreally?)
-                    thread_create_exception((t_exception_object *)Object_SystemException, 1, "Unknown value on the stack during finally cleanup (probably a saffire-bug)");
-                    reason = REASON_EXCEPTION;
-                    goto block_end;
-                    break;
-                }
-
-            // Throw an exception
-            case VM_THROW :
-                {
-                    // Fetch exception object
-                    t_object *obj = (t_object *)vm_frame_stack_pop(frame);
-
-                    // Check if object extends exception
-                    if (! object_instance_of(obj, "exception")) {
-                        thread_create_exception((t_exception_object *)Object_ExtendException, 1, "Object must extend the 'exception' class");
-                        reason = REASON_EXCEPTION;
-                        goto block_end;
-                    }
-
-                    thread_set_exception((t_exception_object *)obj);
-                    reason = REASON_EXCEPTION;
-                    goto block_end;
-
-                }
-                break;
-
-            // Pack a tuple object with values from the stack
-            case VM_PACK_TUPLE :
-                {
-                    // Create an empty tuple
-                    t_tuple_object *obj = (t_tuple_object *)object_alloc(Object_Tuple, 0);
-
-                    // Add elements from the stack into the tuple, sort in reverse order!
-                    for (int i=0; i!=oparg1; i++) {
-                        t_object *val = vm_frame_stack_pop(frame);
-
-                        ht_add_num(obj->data.ht, oparg1 - i - 1, val);
-                        object_inc_ref(val);
-                    }
-
-                    // Push tuple on the stack
-                    vm_frame_stack_push(frame, (t_object *)obj);
-                }
-
-                goto dispatch;
-                break;
-
-            // Unpack a tuple object
-            case VM_UNPACK_TUPLE :
-                {
-                    // Check if we are are unpacking a tuple
-                    t_tuple_object *obj = (t_tuple_object *)vm_frame_stack_pop(frame);
-
-                    if (! OBJECT_IS_TUPLE(obj)) {
-                        thread_create_exception((t_exception_object *)Object_TypeException, 1, "Argument is not a tuple");
-                        reason = REASON_EXCEPTION;
-                        goto block_end;
-                    }
-
-                    // Push the tuple vars. Make sure we start from the correct position
-                    int offset = oparg1 < obj->data.ht->element_count ? oparg1 : obj->data.ht->element_count;
-                    for (int i=0; i < offset; i++) {
-                        t_object *val = ht_find_num(obj->data.ht, i);
-                        vm_frame_stack_push(frame, val);
-                    }
-
-                    // If we haven't got enough elements in our tuple, pad the result with NULLs first
-                    while (oparg1-- > obj->data.ht->element_count) {
-                        vm_frame_stack_push(frame, Object_Null);
-                    }
-                }
-
-                goto dispatch;
-                break;
-
-            // Reset an iteration
-            case VM_ITER_RESET :
-                {
-                    obj1 = vm_frame_stack_pop(frame);
-
-                    // check if we have the iterator interface implemented
-                    if (! object_has_interface(obj1, "iterator")) {
-                        thread_create_exception((t_exception_object *)Object_InterfaceException, 1, "Object must inherit the 'iterator' interface");
-                        reason = REASON_EXCEPTION;
-                        goto block_end;
-                    }
-
-                    // Fetch the actual iterator and push it to the stack
-                    attr_obj = object_attrib_find(obj1, "__iterator");
-                    obj3 = vm_object_call(obj1, attr_obj, 0);
-                    vm_frame_stack_push(frame, obj3);
-
-                    // Call rewind
-                    attr_obj = object_attrib_find(obj3, "__rewind");
-                    vm_object_call(obj3, attr_obj, 0);
-
-                }
-                goto dispatch;
-                break;
-
-            // Fetch iteration values (key, val, meta)
-            case VM_ITER_FETCH :
-                {
-                    obj1 = vm_frame_stack_pop(frame);
-
-                    // If we need 3 values, create and push metadata
-                    if (oparg1 == 3) {
-                        vm_frame_stack_push(frame, Object_Null);
-                    }
-                    // Always push value
-                    attr_obj = object_attrib_find(obj1, "__value");
-                    obj3 = vm_object_call(obj1, attr_obj, 0);
-                    vm_frame_stack_push(frame, obj3);
-
-                    if (oparg1 >= 2) {
-                        // Push value of key
-                        attr_obj = object_attrib_find(obj1, "__key");
-                        obj3 = vm_object_call(obj1, attr_obj, 0);
-                        vm_frame_stack_push(frame, obj3);
-                    }
-
-                    // Push value of hasNext
-                    attr_obj = object_attrib_find(obj1, "__hasNext");
-                    obj3 = vm_object_call(obj1, attr_obj, 0);
-                    vm_frame_stack_push(frame, obj3);
-
-                    if (IS_BOOLEAN_TRUE(obj3)) {
-                        attr_obj = object_attrib_find(obj1, "__next");
-                        obj3 = vm_object_call(obj1, attr_obj, 0);
-                    }
-                }
-                goto dispatch;
-                break;
-
-
-            // Build a datastructure from the values on the stack and place the datastructure object back onto the stack
-            case VM_BUILD_DATASTRUCT   :
-                {
-                    // Fetch methods to call
-                    t_object *obj = (t_object *)vm_frame_stack_pop(frame);
-
-                    // We can only call a class, as we are instantiating a data structure
-                    if (! OBJECT_TYPE_IS_CLASS(obj)) {
-                        // We can only instantiate here through a class!
-                        thread_create_exception((t_exception_object *)Object_CallException, 1, "Datastructure must be a class, not an instance");
-                        reason = REASON_EXCEPTION;
-                        goto block_end;
-                    }
-
-                    // Check if object has interface datastructure
-                    if (! object_has_interface(obj, "datastructure")) {
-                        thread_create_exception((t_exception_object *)Object_InterfaceException, 1, "Class must inherit the 'datastructure' interface");
-                        reason = REASON_EXCEPTION;
-                        goto block_end;
-                    }
-
-                    // Create argument list.
-                    t_dll *dll = dll_init();
-                    for (int i=0; i!=oparg1; i++) {
-                        t_object *tmp = vm_frame_stack_pop(frame);
-                        dll_append(dll, (void *)tmp);
-                    }
-
-                    // Create new object, because we know it's a data-structure, just add them to the list
-                    t_object *ret_obj = (t_object *)object_alloc(obj, 2, NULL, dll);  // arg 1 is hashtable, arg2 is dll
-                    vm_frame_stack_push(frame, ret_obj);
-
-                }
-                goto dispatch;
-                break;
-
-            // Load a subscription [] value out of a datastructure onto the stack
-            case VM_LOAD_SUBSCRIPT :
-                {
-                    // Fetch actual data structure
-                    obj1 = vm_frame_stack_pop(frame);
-                    if (! object_has_interface(obj1, "iterator")) {
-                        thread_create_exception((t_exception_object *)Object_InterfaceException, 1, "Class must inherit the 'iterator' interface");
-                        reason = REASON_EXCEPTION;
-                        goto block_end;
-                    }
-
-                    t_object *ret_obj = NULL;
-
-                    switch (oparg1) {
-                        case 0 :
-                            // foo[]
-                            thread_create_exception((t_exception_object *)Object_InterfaceException, 1, "not supporting [] yet");
-                            reason = REASON_EXCEPTION;
-                            goto block_end;
-
-                            break;
-                        case 1 :
-                            // foo[n]
-                            obj2 = vm_frame_stack_pop(frame);       // first key
-
-                            attr_obj = object_attrib_find(obj1, "__get");
-
-                            ret_obj = vm_object_call(obj1, attr_obj, 1, obj2);
-                            break;
-                        case 2 :
-                            // foo[n..m]
-                            obj3 = vm_frame_stack_pop(frame);       // max
-                            obj2 = vm_frame_stack_pop(frame);       // min
-
-                            attr_obj = object_attrib_find(obj1, "__splice");
-                            if (! attr_obj) {
-                                thread_create_exception((t_exception_object *)Object_AttributeException, 1, "__splice() not found");
-                                reason = REASON_EXCEPTION;
-                                goto block_end;
-                            }
-                            ret_obj = vm_object_call(obj1, attr_obj, 2, obj2, obj3);
-                            break;
-                    }
-
-                    if (! ret_obj) {
-                        reason = REASON_EXCEPTION;
-                        goto block_end;
-                    }
-
-                    vm_frame_stack_push(frame, ret_obj);
-                }
-                goto dispatch;
-                break;
-
-            // Store a value into a datastructure
-            case VM_STORE_SUBSCRIPT :
-                {
-                    obj1 = vm_frame_stack_pop(frame);       // datastructure
-                    obj2 = vm_frame_stack_pop(frame);       // key
-
-                    //
-                    attr_obj = object_attrib_find(obj1, "__set");
-                    t_object *ret_obj = vm_object_call(obj1, attr_obj, 1, obj2);
-                    vm_frame_stack_push(frame, ret_obj);
-                }
-                goto dispatch;
-                break;
-
-        } // switch(opcode) {
-
-
-        /*
-         * Block_end is only reached when we need to change something in our block flow. Normally, it means that we
-         * returned from our method, but it could also be a that we have an exception, or simply that we break, or
-         * continue from a (while,for,etc) loop. The unwind_blocks() function will make sure that we jump to the correct
-         * block and that everything according to the stack will be handled. The reason variable holds the current
-         * reason of ending the block, and it will return what has happened.
-         */
-block_end:
-        // This loop will unwind the blockstack and act accordingly on each block (if needed)
-        unwind_blocks(frame, &reason, ret);
-
-        // Still not handled, break from this frame
-        if (reason != REASON_NONE) {
-            break;
-        }
-
-    } // for (;;)
+ * The interpreter loop is built twice from the same source. The debugger variant counts the executed opcodes and
+ * calls the debugger before every opcode. The fast variant leaves all this out, so runs that can never have a
+ * debugger attached don't pay for it. With threaded dispatch, the debugger variant cannot use the handlers from
+ * the instruction stream (these belong to the fast variant), so it looks them up in its own dispatch table.
+ */
+#define VM_EXECUTE_FUNC             _vm_execute_fast
+#define VM_EXECUTE_DEBUGGER         0
+#define VM_DEBUGGER_HOOK()
+#define VM_HANDLER(instr)           (instr)->handler
+#include "vm_execute.inc"
+#undef VM_EXECUTE_FUNC
+#undef VM_EXECUTE_DEBUGGER
+#undef VM_DEBUGGER_HOOK
+#undef VM_HANDLER
+
+#define VM_EXECUTE_FUNC             _vm_execute_debug
+#define VM_EXECUTE_DEBUGGER         1
+#define VM_DEBUGGER_HOOK()                                                                          \
+    do {                                                                                            \
+        frame->executions++;                                                                        \
+        if ((vm_runmode & VM_RUNMODE_DEBUG) == VM_RUNMODE_DEBUG && debug_info->attached) {          \
+            dbgp_debug(debug_info, frame);                                                          \
+        }                                                                                           \
+    } while (0)
+#define VM_HANDLER(instr)           dispatch_table[(instr)->opcode]
+#include "vm_execute.inc"
+#undef VM_EXECUTE_FUNC
+#undef VM_EXECUTE_DEBUGGER
+#undef VM_DEBUGGER_HOOK
+#undef VM_HANDLER
 
 
-    // Restore current frame
-    thread_set_current_frame(parent_frame);
+/**
+ * Selects the interpreter loop. The debugger variant is only used when running in debug mode with a debugger
+ * attached.
+ */
+void vm_select_execute_loop(void) {
+    if ((vm_runmode & VM_RUNMODE_DEBUG) == VM_RUNMODE_DEBUG && debug_info && debug_info->attached) {
+        vm_execute_loop = _vm_execute_debug;
+    } else {
+        vm_execute_loop = _vm_execute_fast;
+    }
+}
 
-    //printf("RETURNING FROM _VM_EXEC(): %s {%d}\n", object_debug(ret), ret->ref_count);
 
-    // Increase reference count. Otherwise we might not be able to return objects from one frame to another
-    if (ret) object_inc_ref(ret);
+/**
+ * Executes a frame with the currently selected interpreter loop
+ */
+t_object *_vm_execute(t_vm_stackframe *frame) {
+    vm_execute_depth++;
+    t_object *ret = vm_execute_loop(frame);
+    vm_execute_depth--;
     return ret;
 }
 
+
+
 /**
  * Unwind blocks. There are two types of blocks: LOOP and EXCEPTION. When this function is called
  * we will by default unwind everything down EXCEPT when certain conditions are met.
@@ -1816,7 +904,7 @@ t_vm_frameblock *unwind_blocks(t_vm_stackframe *frame, long *reason, t_object *r
             // Clean up any remaining items on the variable stack, but keep the last "REASON_FINALLY"
             while (frame->sp < block->sp - 1) {
                 DEBUG_PRINT_CHAR("Current SP: %d -> Needed SP: %d\n", frame->sp, block->sp);
-                vm_frame_stack_pop(frame);
+                vm_frame_stack_pop_tagged(frame);
             }
 
             // We throw the current exception onto the stack. The catch-blocks will expect this.
@@ -1841,7 +929,7 @@ t_vm_frameblock *unwind_blocks(t_vm_stackframe *frame, long *reason, t_object *r
 
         // Unwind the variable stack. This will remove all variables used in the current (unwound) block.
         while (frame->sp < block->sp) {
-            vm_frame_stack_pop(frame);
+            vm_frame_stack_pop_tagged(frame);
         }
 
 
@@ -1897,8 +985,8 @@ t_vm_stackframe *vm_execute_import(t_vm_codeframe *codeframe, t_object **result)
 
     t_vm_stackframe *current_frame = thread_get_current_frame();
     t_vm_stackframe *import_frame = vm_stackframe_new(current_frame, codeframe);
-    import_frame->trace_class = string_strdup0(current_frame->trace_class);
-    import_frame->trace_method = string_strdup0("#import");
+    import_frame->trace_class = current_frame->trace_class;
+    import_frame->trace_method = string_intern("#import");
 
 
     if (result) {
@@ -2019,20 +1107,14 @@ void vm_populate_builtins(const char *name, t_object *obj) {
 t_object *vm_object_call(t_object *self, t_attrib_object *attrib_obj, int arg_count, ...) {
     if (! self || ! attrib_obj) return NULL;
 
-    // Create DLL with all arguments
+    // Create argument array
     va_list args;
     va_start(args, arg_count);
-    t_dll *arg_list = dll_init();
+    t_object *argv[arg_count + 1];
     for (int i=0; i!=arg_count; i++) {
-        t_object *obj = va_arg(args, t_object *);
-        dll_append(arg_list, obj);
+        argv[i] = va_arg(args, t_object *);
     }
     va_end(args);
 
-    t_object *ret_obj = _object_call_attrib_with_args(self, attrib_obj, arg_list);
-
-    // Free dll
-    dll_free(arg_list);
-
-    return ret_obj;
+    return _object_call_attrib_with_args(self, attrib_obj, argv, arg_count);
 }
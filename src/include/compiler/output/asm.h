@@ -43,6 +43,12 @@
     #define ASM_LINE_TYPE_LABEL         1
     #define ASM_LINE_TYPE_CODE          2
 
+    #define ASM_OPTIMIZE_NONE           0       // Assemble lines as-is
+    #define ASM_OPTIMIZE_BASIC          1       // Thread jumps, remove unreachable code and no-ops
+    #define ASM_OPTIMIZE_FULL           2       // Remove dead stores and emit superinstructions as well
+
+    extern int asm_optimize_level;
+
     typedef struct _asm_opr {
         int type;
         struct {            // Not a union, but a struct. This way we can always figure out easily if "s" or "r" has to be freed.
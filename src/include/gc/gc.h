@@ -27,9 +27,20 @@
 #ifndef __CG_H__
 #define __GC_H__
 
+    #include "objects/object.h"
+
+    // Only allocated objects that can hold references to other objects can be part of a cycle
+    #define GC_IS_CONTAINER(obj)    (OBJECT_IS_ALLOCATED(obj) && (OBJECT_IS_USER(obj) || ((obj)->funcs && (obj)->funcs->traverse)))
+
+    extern __thread int gc_collect_requested;
+
     void gc_collect(void);
+    void gc_collect_step(void);
+    void gc_possible_root(t_object *obj);
+    void gc_forget_root(t_object *obj);
     t_object *gc_queue_recycle(int type);
     int gc_queue_add(t_object *obj);
+    void gc_debug_stats(void);
     void gc_init(void);
     void gc_fini(void);
 
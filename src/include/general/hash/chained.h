@@ -27,7 +27,9 @@
 #ifndef __HASH_CHAINED_H__
 #define __HASH_CHAINED_H__
 
+    #include "general/hashtable.h"
 
+    extern t_hashfuncs chained_hf;
 
 #endif
 
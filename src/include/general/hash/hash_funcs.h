@@ -33,6 +33,7 @@
      * Different hashing methods. Just add them to a hashfunc structure to use
      */
     hash_t hash_native(t_hash_table *ht, const char *key);
+    hash_t hash_native_len(const char *key, size_t len);
     hash_t hash_djbx33a(t_hash_table *ht, const char *key);
 
 #endif
@@ -27,6 +27,8 @@
 #ifndef __HASHTABLE_H__
 #define __HASHTABLE_H__
 
+    #include <stddef.h>
+
     // Hashd value
     typedef unsigned long hash_t;
 
@@ -38,8 +40,9 @@
 
     typedef struct _hash_key {
         char type;                          // One of the HASH_KEY_* defines
+        unsigned int len;                   // Length of a string key
         union {
-            char *s;                        // String value
+            char *s;                        // String value (owned by the key, unless it is interned)
             int n;                          // Numerical value
             t_object *o;                    // Objects
         } val;
@@ -75,19 +78,29 @@
         t_hash_table_bucket *tail;              // DLL head (for appending elements)
 
         t_hash_table_bucket **bucket_list;      // Actual bucket list array
+
+        void *data;                             // Private data of hash functions that do not use buckets
     } t_hash_table;
 
+    struct _hash_iter;
+
 
     // Actual hash functions
     typedef struct _hashfuncs {
         hash_t (*hash)(t_hash_table *ht, const char *);                  // Returns hash of string (0..bucket_count)
         void *(*find)(t_hash_table *ht, t_hash_key *);                   // Find value for key in hashtable
         int (*exists)(t_hash_table *ht, t_hash_key *);                   // Find if a key exists in a hashtable
+        void *(*find_hashed)(t_hash_table *ht, t_hash_key *, hash_t);    // Find value for key with a precomputed hash
+        int (*exists_hashed)(t_hash_table *ht, t_hash_key *, hash_t);    // Find if a key with a precomputed hash exists
         int (*add)(t_hash_table *ht, t_hash_key *, void *value);         // Add value to key
         void *(*replace)(t_hash_table *ht, t_hash_key *, void *value);   // Replace value to key
         void *(*remove)(t_hash_table *ht, t_hash_key *);                 // Remove key
         void (*resize)(t_hash_table *ht, int new_bucket_count);        // Resize (and rehash) hashtable to new size
         void (*deep_copy)(t_hash_table *ht);                           // Makes a deep copy of the buckets
+        void (*destroy)(t_hash_table *ht);                             // Frees all elements and storage
+        void (*iter_rewind)(struct _hash_iter *iter);                  // Moves iterator to the first element
+        void (*iter_next)(struct _hash_iter *iter);                    // Moves iterator to the next element
+        int (*iter_fetch)(struct _hash_iter *iter, t_hash_key **key, void **value);  // Fetches current element (0 when done)
     } t_hashfuncs;
 
 
@@ -105,6 +118,9 @@
     void *ht_find_str(t_hash_table *ht, char *key);
     void *ht_find_num(t_hash_table *ht, unsigned long key);
     void *ht_find_obj(t_hash_table *ht, t_object *key);
+    void *ht_find_hashed(t_hash_table *ht, const char *key, size_t len, hash_t hash);
+    int ht_exists_hashed(t_hash_table *ht, const char *key, size_t len, hash_t hash);
+    hash_t ht_hash_str(const char *key, size_t *len);
 
     int ht_add(t_hash_table *ht, t_hash_key *key, void *value);
     int ht_add_str(t_hash_table *ht, char *key, void *value);
@@ -129,8 +145,8 @@
     // Functionality for iterating a hash table (forward only)
     typedef struct _hash_iter {
         t_hash_table *ht;
-        unsigned long bucket_idx;
-        t_hash_table_bucket *bucket;
+        unsigned long bucket_idx;               // Current entry (for hash functions that do not use buckets)
+        t_hash_table_bucket *bucket;            // Current bucket
     } t_hash_iter;
 
     int ht_iter_init(t_hash_iter *iter, t_hash_table *ht);
@@ -146,6 +162,9 @@
     t_hash_key *ht_key_create(int type, void *val);
     t_hash_key *ht_key_copy(t_hash_key *org);
     void ht_key_free(t_hash_key *hk);
+    void ht_key_free_value(t_hash_key *hk);
+    hash_t ht_key_hash(t_hash_table *ht, t_hash_key *key);
+    int ht_key_equals(t_hash_key *key1, t_hash_key *key2);
 
 
 #endif
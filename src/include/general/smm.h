@@ -35,6 +35,7 @@
     void *smm_zalloc(size_t size);
     void *smm_realloc(void *ptr, size_t size);
     void smm_free(void *ptr);
+    void smm_debug_stats(void);
 
     int smm_asprintf_char(char **ret, const char *format, ...);
     int smm_vasprintf_char(char **ret, const char *format, va_list args);
@@ -33,11 +33,18 @@
 
     // Forward defined in general/unicode.h
 
+    #define STRING_FLAG_ASCII       1   // String only holds 7-bit ASCII characters
+    #define STRING_FLAG_UTF8        2   // String is valid UTF-8 (always set when the string is ASCII)
+
+    #define STRING_IS_ASCII(s)      ((s)->flags & STRING_FLAG_ASCII)
+    #define STRING_IS_UTF8(s)       ((s)->flags & STRING_FLAG_UTF8)
+
     // t_string are compatible with 0-terminated char strings.
     struct _string {
         char            *val;           // Pointer to char data
         size_t          len;            // Length of the string
         UChar           *unicode;       // Unicode string. May or may not be filled.
+        int             flags;          // STRING_FLAG_* encoding flags, computed when the string is created
     };
 
     t_string *char0_to_string(const char *s);
@@ -46,6 +53,8 @@
 
     t_string *string_new(void);
 
+    int string_scan_flags(const char *s, size_t len);
+
     int string_strcmp(t_string *s1, t_string *s2);
     int string_strcmp0(t_string *s1, const char *c_str);
 
@@ -54,6 +63,7 @@
 
     t_string *string_strcat0(t_string *dst, const char *src);
     t_string *string_strcat(t_string *dst, const t_string *src);
+    t_string *string_join(const t_string *sep, t_string **parts, size_t count);
 
     t_string *string_copy_partial(t_string *src, int offset, int count);
 
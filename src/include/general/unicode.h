@@ -32,9 +32,22 @@
     #include "unicode/uchar.h"
     #include "unicode/ucnv.h"
     #include "unicode/ustring.h"
+    #include "unicode/ucasemap.h"
 
     typedef struct _string t_string;
 
+    // Shared locale handle. There is only one handle per locale name.
+    typedef struct _locale {
+        char *name;                 // Locale name (interned)
+        UCaseMap *casemap;          // ICU case mapping, created on first use
+        struct _locale *next;       // Next locale in the registry
+    } t_locale;
+
+    t_locale *utf8_locale(const char *name);
+    char *utf8_locale_name(t_locale *locale);
+    UCaseMap *utf8_locale_casemap(t_locale *locale);
+    void utf8_locale_fini(void);
+
 //    typedef struct {
 //        UChar   *val;       // Binary safe UTF8 string
 //    } t_unicode_string;
@@ -63,8 +76,8 @@
 
     int utf8_strstr(t_string *haystack, t_string *needle);
 
-    t_string *utf8_toupper(t_string *src, char *locale);
-    t_string *utf8_tolower(t_string *src, char *locale);
+    t_string *utf8_toupper(t_string *src, t_locale *locale);
+    t_string *utf8_tolower(t_string *src, t_locale *locale);
 
 //    int utf8_strstr(t_string *haystack, t_string *needle);
 
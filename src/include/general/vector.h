@@ -0,0 +1,51 @@
+/*
+ Copyright (c) 2012-2013, The Saffire Group
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+     * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+     * Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in the
+       documentation and/or other materials provided with the distribution.
+     * Neither the name of the Saffire Group the
+       names of its contributors may be used to endorse or promote products
+       derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef __VECTOR_H__
+#define __VECTOR_H__
+
+    // Growable array of pointers with O(1) indexing and amortised O(1) appends
+    typedef struct _vector {
+        long size;                  // Number of elements in the vector
+        long capacity;              // Number of allocated element slots
+        void **elements;            // Elements, stored contiguously
+    } t_vector;
+
+    #define VECTOR_SIZE(v)          v->size
+    #define VECTOR_ELEMENTS(v)      v->elements
+
+    t_vector *vector_init(void);
+    t_vector *vector_init_size(long size);
+    void vector_free(t_vector *v);
+    void vector_reserve(t_vector *v, long capacity);
+    void vector_append(t_vector *v, void *data);
+    void vector_append_all(t_vector *v, void **data, long count);
+    void *vector_get(t_vector *v, long idx);
+    void *vector_set(t_vector *v, long idx, void *data);
+    void vector_swap(t_vector *v, long idx1, long idx2);
+    t_vector *vector_copy(t_vector *v);
+
+#endif
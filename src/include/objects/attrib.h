@@ -103,5 +103,6 @@
 
     t_attrib_object *object_attrib_duplicate(t_attrib_object *attrib, t_object *bound_obj);
     t_attrib_object *object_attrib_find(t_object *self, char *name);
+    void object_attrib_set_value(t_attrib_object *attrib, t_object *value);
 
 #endif
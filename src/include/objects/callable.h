@@ -36,6 +36,7 @@
     typedef struct _method_arg {
         t_object *value;
         t_string_object *typehint;
+        int slot;                           // Local variable slot inside the method frame (-1 when not used)
     } t_method_arg;
 
     /* Callable code types */
@@ -53,7 +54,7 @@
                 struct _vm_codeframe *codeframe;                    // Internal codeframe
             } external;
             struct {
-                t_object *(*native_func)(t_object *, t_dll *);      // internal function
+                t_object *(*native_func)(t_object *, t_object **, int);      // internal function (self, argv, argc)
             } internal;
         } code;
 
@@ -28,12 +28,12 @@
 #define __OBJECT_LIST_H__
 
     #include "objects/object.h"
-    #include "general/hashtable.h"
+    #include "general/vector.h"
 
-    #define RETURN_LIST(h)   RETURN_OBJECT(object_alloc(Object_List, 1, h));
+    #define RETURN_LIST(v)   RETURN_OBJECT(object_alloc(Object_List, 1, v));
 
     typedef struct {
-        t_hash_table *ht;
+        t_vector *vector;
         struct {
             long idx;
         } iter;
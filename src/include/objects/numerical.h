@@ -50,4 +50,6 @@
     void object_numerical_init(void);
     void object_numerical_fini(void);
 
+    t_object *object_numerical_box(t_object *obj);
+
 #endif
@@ -29,6 +29,7 @@
 
     #include <stdlib.h>
     #include <stdarg.h>
+    #include <stdint.h>
     #include "general/hashtable.h"
     #include "general/dll.h"
     #include "compiler/ast_nodes.h"
@@ -42,7 +43,9 @@
         void (*destroy)(t_object *);                // Destroys object. Don't use object after this call!
         t_object *(*clone)(t_object *);             // Clone this object to a new object
         t_object *(*cache)(t_object *, t_dll *);    // Returns a cached object or NULL when no cached object is found
-        char *(*hash)(t_object *);                  // Returns a string hash (prob md5) of the object
+        hash_t (*hash)(t_object *);                 // Returns a (cached) 64-bit hash of the object
+        int (*equals)(t_object *, t_object *);      // Returns 1 when both objects are equal as a hash key
+        void (*traverse)(t_object *, void (*)(t_object *)); // Visits every object this object holds a reference to
 #ifdef __DEBUG
         char *(*debug)(t_object *);                 // Return debug string (value and info)
 #endif
@@ -103,10 +106,29 @@
     #define OBJECT_TYPE_IS_FINAL(obj)       ((obj->flags & OBJECT_TYPE_FINAL) == OBJECT_TYPE_FINAL)
     #define OBJECT_IS_ALLOCATED(obj)        ((obj->flags & OBJECT_FLAG_ALLOCATED) == OBJECT_FLAG_ALLOCATED)
 
+    // Instances of user classes hold a reference to their class. User classes themselves are instances of their parent.
+    #define OBJECT_TYPE_IS_USER_INSTANCE(obj)   (OBJECT_IS_USER(obj) && (obj->flags & OBJECT_TYPE_MASK) == OBJECT_TYPE_INSTANCE)
+    #define OBJECT_HAS_COUNTED_CLASS(obj)       (OBJECT_IS_USER(obj) && obj->class && OBJECT_IS_USER(obj->class) && OBJECT_IS_ALLOCATED(obj->class))
+
+
+    /*
+     * Small integers can be stored directly inside an object pointer, with the lowest bit set. Real objects are always
+     * aligned, so they never have this bit set. Tagged numericals have no memory and no reference count, and only
+     * live on the VM stack and inside local variable slots. They are boxed into a real numerical object as soon as
+     * they are handed to anything else.
+     */
+    #define OBJECT_TAG_NUMERICAL        1
+    #define OBJECT_IS_TAGGED(obj)       (((intptr_t)(obj) & OBJECT_TAG_NUMERICAL) == OBJECT_TAG_NUMERICAL)
+    #define OBJECT_TAGGED_MIN           (INTPTR_MIN >> 1)
+    #define OBJECT_TAGGED_MAX           (INTPTR_MAX >> 1)
+    #define OBJECT_TAGGED_FITS(n)       ((n) >= OBJECT_TAGGED_MIN && (n) <= OBJECT_TAGGED_MAX)
+    #define NUM2TAGGED(n)               ((t_object *)(((intptr_t)(n) << 1) | OBJECT_TAG_NUMERICAL))
+    #define TAGGED2NUM(obj)             ((long)((intptr_t)(obj) >> 1))
+
 
     // Simple macro's for object type checks
     #define OBJECT_IS_NULL(obj)         (obj->type == objectTypeNull)
-    #define OBJECT_IS_NUMERICAL(obj)    (obj->type == objectTypeNumerical)
+    #define OBJECT_IS_NUMERICAL(obj)    (OBJECT_IS_TAGGED(obj) || (obj)->type == objectTypeNumerical)
     #define OBJECT_IS_STRING(obj)       (obj->type == objectTypeString)
     #define OBJECT_IS_REGEX(obj)        (obj->type == objectTypeRegex)
     #define OBJECT_IS_BOOLEAN(obj)      (obj->type == objectTypeBoolean)
@@ -118,6 +140,7 @@
     #define OBJECT_IS_LIST(obj)         (obj->type == objectTypeList)
     #define OBJECT_IS_HASH(obj)         (obj->type == objectTypeHash)
     #define OBJECT_IS_BASE(obj)         (obj->type == objectTypeBase)
+    #define OBJECT_IS_STRINGBUILDER(obj) (obj->type == objectTypeStringBuilder)
 
 
     // fetch (string) value from a string object
@@ -125,11 +148,11 @@
     #define OBJ2STR0(_obj_) (((t_string_object *)_obj_)->data.value->val)
 
     // fetch (long) value from a numerical object
-    #define OBJ2NUM(_obj_) (((t_numerical_object *)_obj_)->data.value)
+    #define OBJ2NUM(_obj_) (OBJECT_IS_TAGGED(_obj_) ? TAGGED2NUM(_obj_) : ((t_numerical_object *)(_obj_))->data.value)
 
 
     // Number of different object types (also needed for GC queues)
-    #define OBJECT_TYPE_LEN     14
+    #define OBJECT_TYPE_LEN     15
 
     // Object types, the objectTypeAny is a wildcard type. Matches any other type.
     const char *objectTypeNames[OBJECT_TYPE_LEN];
@@ -137,10 +160,30 @@
                    objectTypeAny, objectTypeCallable, objectTypeAttribute, objectTypeBase, objectTypeBoolean,
                    objectTypeNull, objectTypeNumerical, objectTypeRegex, objectTypeString, objectTypeHash,
                    objectTypeTuple, objectTypeUser, objectTypeList, objectTypeException,
+                   objectTypeStringBuilder,
                  } t_objectype_enum;
 
 
 
+    // Debug builds link every allocated object into a list, so leaked objects can be reported when finishing
+    #ifdef __DEBUG
+        #define SAFFIRE_OBJECT_REGISTRY \
+            t_object *registry_prev;        /* Previous allocated object */ \
+            t_object *registry_next;        /* Next allocated object */ \
+
+        #define OBJECT_REGISTRY_INIT    , NULL, NULL
+
+        // Objects that are copied from another object must not share its links
+        #define OBJECT_REGISTRY_CLEAR(obj)  ((obj)->registry_prev = (obj)->registry_next = NULL)
+    #else
+        #define SAFFIRE_OBJECT_REGISTRY
+        #define OBJECT_REGISTRY_INIT
+        #define OBJECT_REGISTRY_CLEAR(obj)
+    #endif
+
+    // Objects that are copied from another object must not inherit its cycle collector state
+    #define OBJECT_GC_CLEAR(obj)    ((obj)->gc_color = 0, (obj)->gc_prev = (obj)->gc_next = NULL)
+
     // Actual header that needs to be present in each object (as the first entry)
     #define SAFFIRE_OBJECT_HEADER \
         int ref_count;                  /* Reference count. When 0, it is targeted for garbage collection */ \
@@ -156,10 +199,18 @@
         t_dll *interfaces;              /* Actual interfaces */ \
         \
         t_hash_table *attributes;       /* Object attributes, properties or constants */ \
+        struct _object_shape *shape;    /* Names of the property slots (user objects only) */ \
+        t_object **slots;               /* Property values of an instance, indexed through its shape */ \
         \
         t_object_funcs *funcs;          /* Functions for internal maintenance (new, free, clone etc) */ \
         \
         int data_size;                  /* Additional data size. If 0, no additional data is used in this object */ \
+        \
+        int gc_color;                   /* Cycle collector color and flags */ \
+        t_object *gc_prev;              /* Previous possible cycle root */ \
+        t_object *gc_next;              /* Next possible cycle root */ \
+        \
+        SAFFIRE_OBJECT_REGISTRY
 
 
     // Actual "global" object. Every object is typed on this object.
@@ -178,8 +229,14 @@
                 base,           /* parent */               \
                 interfaces,     /* implements */           \
                 NULL,           /* attribute */            \
+                NULL,           /* shape */                \
+                NULL,           /* slots */                \
                 funcs,          /* functions */            \
-                data_size       /* data lenght */          \
+                data_size,      /* data lenght */          \
+                0,              /* gc color */             \
+                NULL,           /* gc prev */              \
+                NULL            /* gc next */              \
+                OBJECT_REGISTRY_INIT                       \
 
     // Object header initialization without any functions or base
     #define OBJECT_HEAD_INIT(name, type, flags, funcs, data_size) \
@@ -188,14 +245,24 @@
     /*
      * Header macros
      */
-    #define SAFFIRE_METHOD(obj, method) static t_object *object_##obj##_method_##method(t_##obj##_object *self, t_dll *arguments)
-    #define SAFFIRE_OPERATOR_METHOD(obj, method) static t_object *object_##obj##_method_opr_##method(t_##obj##_object *self, t_dll *arguments)
-    #define SAFFIRE_COMPARISON_METHOD(obj, method) static t_object *object_##obj##_method_cmp_##method(t_##obj##_object *self, t_dll *arguments)
+    // Builtin methods receive their arguments as an array, which normally points directly into the callers stack
+    #define SAFFIRE_METHOD(obj, method) static t_object *object_##obj##_method_##method(t_##obj##_object *self, t_object **argv, int argc)
+    #define SAFFIRE_OPERATOR_METHOD(obj, method) static t_object *object_##obj##_method_opr_##method(t_##obj##_object *self, t_object **argv, int argc)
+    #define SAFFIRE_COMPARISON_METHOD(obj, method) static t_object *object_##obj##_method_cmp_##method(t_##obj##_object *self, t_object **argv, int argc)
+
+    #define SAFFIRE_METHOD_ARGV argv, argc
+
+    // Module methods still receive their arguments as a DLL. The module method is wrapped by a function with the
+    // native calling convention, which creates this DLL.
+    #define SAFFIRE_MODULE_METHOD(mod, method) \
+        static t_object *module_##mod##_method_##method##_dll(t_object *self, t_dll *arguments); \
+        static t_object *module_##mod##_method_##method(t_object *self, t_object **argv, int argc) { \
+            return object_call_dll_method(self, argv, argc, module_##mod##_method_##method##_dll); \
+        } \
+        static t_object *module_##mod##_method_##method##_dll(t_object *self, t_dll *arguments)
 
     #define SAFFIRE_METHOD_ARGS arguments
 
-    #define SAFFIRE_MODULE_METHOD(mod, method) static t_object *module_##mod##_method_##method(t_object *self, t_dll *arguments)
-
 
     // Returns custom object 'obj'
     #define RETURN_OBJECT(obj) return (t_object*)obj
@@ -204,15 +271,21 @@
     #define RETURN_SELF { return (t_object *)self; }
 
 
+    // Increased whenever any attribute table changes (used for invalidating the VM inline caches)
+    extern unsigned long object_attrib_generation;
+
     void object_init(void);
     void object_fini(void);
 
     char *object_debug(t_object *obj);
     int object_parse_arguments(t_dll *arguments, const char *speclist, ...);
+    int object_parse_argv(t_object **argv, int argc, const char *speclist, ...);
+    t_object *object_call_dll_method(t_object *self, t_object **argv, int argc, t_object *(*func)(t_object *, t_dll *));
     t_object *object_new(t_object *obj, int arg_count, ...);
     t_object *object_new_with_dll_args(t_object *obj, t_dll *arguments);
     t_object *object_clone(t_object *obj);
-    char *object_get_hash(t_object *obj);
+    hash_t object_get_hash(t_object *obj);
+    int object_hash_equals(t_object *obj1, t_object *obj2);
     t_object *object_alloca(t_object *obj, t_dll *arguments);
     t_object *object_alloc(t_object *obj, int arg_count, ...);
     void object_inc_ref(t_object *obj);
@@ -225,6 +298,8 @@
     void object_add_property(t_object *obj, char *name, int visibility, t_object *property);
     void object_add_internal_method(t_object *obj, char *name, int flags, int visibility, void *func);
     void object_free_internal_object(t_object *obj);
+    void object_free_values(t_object *obj);
+    void object_destroy(t_object *obj);
 
     int object_instance_of(t_object *obj, const char *instance);
     int object_check_interface_implementations(t_object *obj);
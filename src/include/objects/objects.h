@@ -43,5 +43,6 @@
     #include "tuple.h"
     #include "interfaces.h"
     #include "exception.h"
+    #include "stringbuilder.h"
 
 #endif
@@ -0,0 +1,50 @@
+/*
+ Copyright (c) 2012-2013, The Saffire Group
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+     * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+     * Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in the
+       documentation and/or other materials provided with the distribution.
+     * Neither the name of the Saffire Group the
+       names of its contributors may be used to endorse or promote products
+       derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef __OBJECT_SHAPE_H__
+#define __OBJECT_SHAPE_H__
+
+    #include "objects/object.h"
+    #include "general/hashtable.h"
+
+    /*
+     * A shape describes which properties are stored inside an instance, and at which slot. Instances of the same class
+     * that get the same properties in the same order share the same shape, so the names only have to be stored once.
+     */
+    typedef struct _object_shape {
+        struct _object_shape *parent;       // Shape this shape was derived from (NULL for the root shape of a class)
+        int slot_count;                     // Number of slots in an instance with this shape
+        t_hash_table *slots;                // Property name -> slot index + 1
+        t_hash_table *transitions;          // Property name -> shape with that property added
+    } t_object_shape;
+
+    t_object_shape *object_shape_new(void);
+    void object_shape_free(t_object_shape *shape);
+    int object_shape_find_slot(t_object_shape *shape, char *name);
+    int object_shape_add_slot(t_object *obj, char *name);
+    void object_shape_set_slot(t_object *obj, int slot, t_object *value);
+
+#endif
@@ -46,11 +46,12 @@
 
     typedef struct {
         t_string *value;            // string value
-        md5_byte_t hash[16];        // (MD5) hash of the actual string
+        hash_t hash;                // Hash of the actual string
         int needs_hashing;          // 1 : string needs hashing, 0 : hash done
 
         int iter;                   // Simple iteration index on the characters
-        char *locale;               // Locale
+        t_locale *locale;           // Locale (shared handle)
+        t_object *owner;            // String object owning the buffer when this string is a slice, or NULL
     } t_string_object_data;
 
     typedef struct {
@@ -66,7 +67,6 @@
     void object_string_fini(void);
 
 
-    int object_string_hash_compare(t_string_object *s1, t_string_object *s2);
     int object_string_compare(t_string_object *s1, t_string_object *s2);
 
 #endif
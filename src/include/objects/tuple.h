@@ -28,12 +28,12 @@
 #define __OBJECT_TUPLE_H__
 
     #include "objects/object.h"
-    #include "general/hashtable.h"
+    #include "general/vector.h"
 
-    #define RETURN_TUPLE(t)   RETURN_OBJECT(object_alloc(Object_Tuple, 1, t));
+    #define RETURN_TUPLE(v)   RETURN_OBJECT(object_alloc(Object_Tuple, 1, v));
 
     typedef struct {
-        t_hash_table *ht;
+        t_vector *vector;
     } t_tuple_object_data;
 
     typedef struct {
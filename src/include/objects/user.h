@@ -43,5 +43,7 @@
 
     void object_user_init(void);
     void object_user_fini(void);
+    void object_user_free(t_object *obj);
+    void object_user_traverse(t_object *obj, void (*visit)(t_object *));
 
 #endif
@@ -34,6 +34,8 @@
     t_vm_codeframe *vm_codeframe_addchild(t_vm_codeframe *parent, t_bytecode *bytecode);
     void vm_codeframe_destroy(t_vm_codeframe *codeframe);
 
+    int vm_codeframe_get_local_slot(t_vm_codeframe *codeframe, const char *name);
+
     void vm_codeframe_init(void);
     void vm_codeframe_fini(void);
 
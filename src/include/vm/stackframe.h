@@ -34,6 +34,11 @@
     #include "vm/codeframe.h"
     #include "vm/context.h"
 
+    #define VM_SLOT_SELF        0       // Method frames always store "self" in the first local variable slot
+
+    #define VM_FRAME_POOL_SIZE  32      // Maximum number of released frames kept for reuse per thread
+    #define VM_FRAME_SLOT_ALIGN 16      // Frame slots are allocated in multiples of this, so pooled frames fit more often
+
 
     t_vm_stackframe *vm_stackframe_new_scoped(t_vm_stackframe *scope_frame, t_vm_stackframe *parent_frame, t_vm_context *context, t_bytecode *bytecode);
     t_vm_stackframe *vm_stackframe_new(t_vm_stackframe *parent_frame, t_vm_codeframe *codeframe);
@@ -44,12 +49,15 @@
 
     t_object *vm_frame_stack_pop_attrib(t_vm_stackframe *frame);
     t_object *vm_frame_stack_pop(t_vm_stackframe *frame);
+    t_object *vm_frame_stack_pop_tagged(t_vm_stackframe *frame);
     void vm_frame_stack_push(t_vm_stackframe *frame, t_object *obj);
     void vm_frame_stack_modify(t_vm_stackframe *frame, int idx, t_object *obj);
     t_object *vm_frame_stack_fetch_top(t_vm_stackframe *frame);
+    t_object *vm_frame_stack_fetch_top_tagged(t_vm_stackframe *frame);
     t_object *vm_frame_stack_fetch(t_vm_stackframe *frame, int idx);
 
     t_object *vm_frame_get_constant(t_vm_stackframe *frame, int idx);
+    char *vm_frame_get_constant_name(t_vm_stackframe *frame, int idx);
     t_object *vm_frame_get_identifier(t_vm_stackframe *frame, char *id);
     t_object *vm_frame_find_identifier(t_vm_stackframe *frame, char *id);
     t_object *vm_frame_get_global_identifier(t_vm_stackframe *frame, char *id);
@@ -60,6 +68,9 @@
     void vm_frame_set_frame_identifier(t_vm_stackframe *frame, char *id, t_object *obj);
     void vm_frame_set_identifier(t_vm_stackframe *frame, char *id, t_object *obj);
 
+    t_object *vm_frame_get_local(t_vm_stackframe *frame, int slot);
+    void vm_frame_set_local(t_vm_stackframe *frame, int slot, t_object *obj);
+
     void vm_frame_set_builtin_identifier(t_vm_stackframe *frame, char *id, t_object *obj);
 
     void *vm_frame_get_constant_literal(t_vm_stackframe *frame, int idx);
@@ -37,7 +37,10 @@
         t_vm_stackframe *frame;                  // Current frame
         t_exception_object *exception;      // Current thrown exception
 
-        char *locale;                       // Current global locale
+        t_locale *locale;                   // Current global locale
+
+        t_vm_stackframe *frame_pool;        // Released frames that can be reused by new frames
+        int frame_pool_len;                 // Number of frames inside the pool
     } t_thread;
 
     t_thread *current_thread;
@@ -53,6 +53,9 @@
     t_vm_stackframe *vm_execute_import(t_vm_codeframe *codeframe, t_object **result);
     t_object *vm_object_call(t_object *self, t_attrib_object *attrib_obj, int arg_count, ...);
 
+    void **vm_get_dispatch_table(void);
+    void vm_select_execute_loop(void);
+
 #endif
 
 
@@ -50,11 +50,54 @@
     } t_vm_context;
 
 
+    /*
+     * A predecoded instruction. The bytecode of a codeframe is decoded once into an array of these, indexed by the
+     * bytecode offset of the instruction, so the VM does not need to decode opcodes and operands on every execution.
+     * Entries that fall inside the operands of an instruction are filled with VM_RESERVED. The entry at code_len
+     * is always a VM_STOP sentinel.
+     */
+    typedef struct _vm_instruction {
+        void *handler;                  // Address of the opcode handler (threaded dispatch only, NULL otherwise)
+        unsigned int next_ip;           // Bytecode offset of the next instruction
+        unsigned int opcode;            // Opcode
+        unsigned int oparg1;            // Operands (0 when not present)
+        unsigned int oparg2;
+        unsigned int oparg3;
+        unsigned int cache_idx;         // Index of the inline cache of this instruction (if any)
+        unsigned int deopts;            // Number of times a quickened form of this instruction has been de-optimised
+    } t_vm_instruction;
+
+
+    #define VM_INLINE_CACHE_WAYS        4           // Number of object layouts a single inline cache can hold
+
+    typedef struct _vm_inline_cache_entry {
+        t_hash_table *attributes;       // Attribute table of the object (shared by a class and its instances)
+        t_object *parent;               // Parent of the object
+        struct _object_shape *shape;    // Shape of the object
+        int is_class;                   // Object is a class instead of an instance
+        unsigned long generation;       // Attribute generation this entry is valid for
+        t_attrib_object *attrib;        // Resolved attribute (NULL when the property only exists on the instance)
+        int slot;                       // Property slot + 1 inside the instance, or 0 when not stored in a slot
+        int visible;                    // 1 when the attribute is always visible for this object layout
+    } t_vm_inline_cache_entry;
+
+    typedef struct _vm_inline_cache {
+        unsigned int ip;                // Bytecode offset of the instruction using this cache
+        int next_entry;                 // Next entry to replace when all entries are in use
+        t_vm_inline_cache_entry entries[VM_INLINE_CACHE_WAYS];
+    } t_vm_inline_cache;
+
+
     typedef struct _vm_codeframe {
         t_vm_context *context;          // Context of this codeframe
 
         t_bytecode *bytecode;           // Frame's bytecode
         t_object **constants_objects;   // Constants taken from bytecode, converted to actual objects
+
+        t_vm_instruction *instructions; // Predecoded bytecode (code_len + 1 entries)
+
+        unsigned int inline_cache_len;  // Number of inline caches
+        t_vm_inline_cache *inline_caches;   // Inline caches for attribute loads and stores
     } t_vm_codeframe;
 
 
@@ -93,6 +136,7 @@
         t_object **stack;                           // Local variable stack
         unsigned int sp;                            // Stack pointer
 
+        t_object **locals;                          // Slot based local variables (indexed by identifier offset)
         t_hash_object *local_identifiers;           // Local identifiers (local variables, method arguments etc)
         t_hash_object *frame_identifiers;           // Frame identifiers (imports, classes etc)
         t_hash_object *global_identifiers;          // Global identifiers
@@ -103,13 +147,17 @@
         int block_cnt;                              // Last used block number (0 = no blocks on the stack)
         t_vm_frameblock blocks[BLOCK_MAX_DEPTH];    // Frame blocks
 
-        char *trace_class;                          // Class that is currently executed
-        char *trace_method;                         // Method that is currently executed
+        char *trace_class;                          // Class that is currently executed (interned)
+        char *trace_method;                         // Method that is currently executed (interned)
         int param_count;                            // Number of arguments
         t_object **params;                          // The arguments list (start offset on stack)
 
         //unsigned int time;                        // Total time spend in this bytecode block
         unsigned int executions;                    // Number of total executions (opcodes processed)
+
+        t_vm_stackframe *pool_next;                 // Next released frame in the thread's frame pool
+        unsigned int slot_count;                    // Number of slots allocated for this frame
+        t_object *slots[];                          // Stack and local variable slots, allocated together with the frame
     };
 
 #endif
@@ -89,12 +89,6 @@ static int _compile_file(const char *source_file, int sign, char *gpg_key) {
         goto cleanup;
     }
 
-    // Write assembly output file if needed
-    if (write_sfa) {
-        char *sfa_dest_file = replace_extension(source_file, ".sf", ".sfa");
-        assembler_output(asm_code, sfa_dest_file);
-    }
-
     // Convert the assembler lines to bytecode
     t_bytecode *bc = assembler(asm_code, source_file);
     if (! bc) {
@@ -102,6 +96,12 @@ static int _compile_file(const char *source_file, int sign, char *gpg_key) {
         goto cleanup;
     }
 
+    // Write assembly output file if needed. This is done after assembling, so it shows the optimised lines.
+    if (write_sfa) {
+        char *sfa_dest_file = replace_extension(source_file, ".sf", ".sfa");
+        assembler_output(asm_code, sfa_dest_file);
+    }
+
     // Save bytecode structure to disk
     sfc_dest_file = replace_extension(source_file, ".sf", ".sfc");
     output_char("Compiling %s into %s%s\n", source_file, sign ? "signed " : "", sfc_dest_file);
@@ -256,6 +256,20 @@ static int do_unsign(void) {
     return 0;
 }
 
+/**
+ * Display the sizes of a bytecode frame and all the code frames inside it
+ */
+static void _display_bytecode_info(t_bytecode *bc, int level) {
+    output_char("%*sframe: %d bytes code, %d constants, %d identifiers, stack size %d\n", level * 4, "",
+                bc->code_len, bc->constants_len, bc->identifiers_len, bc->stack_size);
+
+    for (int i=0; i!=bc->constants_len; i++) {
+        if (bc->constants[i]->type == BYTECODE_CONST_CODE) {
+            _display_bytecode_info(bc->constants[i]->data.code, level + 1);
+        }
+    }
+}
+
 /**
  *
  */
@@ -268,11 +282,21 @@ static int do_info(void) {
         return 1;
     }
 
-    // sign file
-    if (S_ISREG(st.st_mode)) {
-        warning("Displaying information for bytecode files is not supported yet.");
+    if (! S_ISREG(st.st_mode) || ! bytecode_is_valid_file(source_path)) {
+        warning("This is not a valid saffire bytecode file.\n");
+        return 1;
     }
 
+    t_bytecode *bc = bytecode_load(source_path, 0);
+    if (! bc) {
+        warning("Cannot load bytecode file %s\n", source_path);
+        return 1;
+    }
+
+    output_char("Bytecode file %s%s\n", source_path, bytecode_is_signed(source_path) ? " (signed)" : "");
+    _display_bytecode_info(bc, 0);
+    bytecode_free(bc);
+
     return 0;
 }
 
@@ -324,6 +348,7 @@ static const char help[] = "Compiles a Saffire script or scripts without running
     "       --sign           Sign the bytecode\n"
     "       --no-sign        Don't sign the bytecode\n"
     "       --key <key>      Use this key for signing the code\n"
+    "       --optimize=<n>   Optimisation level: 0 = none, 1 = basic, 2 = full (default)\n"
     "   sign                 Sign bytecode file or directory\n"
     "       --key <key>      Use this key for signing the code\n"
     "   unsign               Remove signature from bytecode file or directory\n"
@@ -338,6 +363,14 @@ static void opt_text(void *data) {
 static void opt_dot(void *data) {
     write_dot = 1;
 }
+static void opt_optimize(void *data) {
+    char *end;
+    long level = strtol((char *)data, &end, 10);
+    if (*(char *)data == '\0' || *end != '\0' || level < ASM_OPTIMIZE_NONE || level > ASM_OPTIMIZE_FULL) {
+        fatal_error(1, "Optimisation level must be between %d and %d", ASM_OPTIMIZE_NONE, ASM_OPTIMIZE_FULL);    /* LCOV_EXCL_LINE */
+    }
+    asm_optimize_level = level;
+}
 
 
 static void opt_key(void *data) {
@@ -365,6 +398,7 @@ static struct saffire_option compile_options[] = {
     { "key", "", required_argument, opt_key},
     { "text", "", no_argument, opt_text},
     { "dot", "", no_argument, opt_dot},
+    { "optimize", "", required_argument, opt_optimize},
     { 0, 0, 0, 0}
 };
 
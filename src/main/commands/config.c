@@ -119,6 +119,19 @@ static const char *default_ini[] = {
     "# Display the saffire logo upon start of the repl",
     "logo = false",
     "",
+    "[gc]",
+    "# Number of freed objects per type that are kept for reuse. Use 0 to disable recycling for a type",
+    "queue.string = 100",
+    "queue.numerical = 100",
+    "queue.regex = 100",
+    "queue.hash = 100",
+    "queue.tuple = 100",
+    "queue.list = 100",
+    "# Number of possible cycle roots that triggers the cycle collector. Use 0 to only collect after each request",
+    "threshold = 10000",
+    "# Maximum number of possible cycle roots handled in one collector step, to keep pauses short",
+    "slice = 1000",
+    "",
     "[debug]",
     "# Saffire only supports the dbgp protocol",
     "protocol = dbgp",
@@ -35,6 +35,7 @@
 #include "modules/module_api.h"
 #include "compiler/ast_nodes.h"
 #include "general/smm.h"
+#include "general/intern.h"
 #include "commands/command.h"
 #include "general/parse_options.h"
 #include "general/path_handling.h"
@@ -92,8 +93,8 @@ static int do_exec(void) {
     t_vm_context *ctx = vm_context_new("::", full_source_path);
     t_vm_codeframe *codeframe = vm_codeframe_new(bc, ctx);
     t_vm_stackframe *initial_frame = vm_stackframe_new(NULL, codeframe);
-    initial_frame->trace_class = string_strdup0("#main");
-    initial_frame->trace_method = string_strdup0("#main");
+    initial_frame->trace_class = string_intern("#main");
+    initial_frame->trace_method = string_intern("#main");
 
     // Run the frame
     int exitcode = vm_execute(initial_frame);
@@ -103,6 +104,7 @@ static int do_exec(void) {
     smm_free(bytecode_filepath);
 
     DEBUG_PRINT_CHAR("VM ended with exitcode: %d\n", exitcode);
+    smm_debug_stats();
 
     return exitcode;
 }
@@ -73,7 +73,7 @@ fwrite($fp, $header);
 
 // Do defines
 foreach ($opcodes as $hex => $str) {
-    fwrite($fp, sprintf("    #define VM_%-20s%s\n", strtoupper($str), $hex));
+    fwrite($fp, sprintf("    #define VM_%-20s %s\n", strtoupper($str), $hex));
 }
 fwrite($fp, "\n\n");
 
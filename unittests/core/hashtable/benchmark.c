@@ -0,0 +1,84 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "../../src/include/general/hashtable.h"
+#include "../../src/include/general/hash/chained.h"
+#include "../../src/include/general/hash/open_addressing.h"
+#include "../../src/include/general/intern.h"
+
+/*
+ * Compares the timings of the hashtable backends. This is not part of the testsuite, build and run it with:
+ *
+ *    # make htbench && ./htbench
+ */
+
+#define BENCH_KEYS  50000
+
+static t_hashfuncs *backends[] = { &chained_hf, &open_addressing_hf, NULL };
+static const char *backend_names[] = { "chained", "open addressing" };
+
+static t_hash_table *_create(t_hashfuncs *hf) {
+    return ht_create_custom(16, hf == &chained_hf ? 1.25 : 0.875, 1.75, hf);
+}
+
+static double _elapsed(struct timespec *start) {
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (end.tv_sec - start->tv_sec) * 1000.0 + (end.tv_nsec - start->tv_nsec) / 1000000.0;
+}
+
+int main(int argc, char *argv[]) {
+    char key[32];
+    char **keys = malloc(sizeof(char *) * BENCH_KEYS);
+    for (int i=0; i!=BENCH_KEYS; i++) {
+        snprintf(key, 32, "bench_%d", i);
+        keys[i] = string_intern(key);
+    }
+
+    for (int b=0; backends[b]; b++) {
+        struct timespec start;
+        double add, find, miss, num, iter;
+        long found = 0;
+
+        t_hash_table *ht = _create(backends[b]);
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (int i=0; i!=BENCH_KEYS; i++) ht_add_str(ht, keys[i], keys[i]);
+        add = _elapsed(&start);
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (int r=0; r!=10; r++) {
+            for (int i=0; i!=BENCH_KEYS; i++) found += ht_find_str(ht, keys[i]) != NULL;
+        }
+        find = _elapsed(&start);
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (int i=0; i!=BENCH_KEYS; i++) {
+            snprintf(key, 32, "miss_%d", i);
+            found += ht_find_str(ht, key) != NULL;
+        }
+        miss = _elapsed(&start);
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (int i=0; i!=BENCH_KEYS; i+=2) ht_remove_str(ht, keys[i]);
+        for (int r=0; r!=10; r++) {
+            t_hash_iter it;
+            for (ht_iter_init(&it, ht); ht_iter_valid(&it); ht_iter_next(&it)) found += ht_iter_value(&it) != NULL;
+        }
+        iter = _elapsed(&start);
+        ht_destroy(ht);
+
+        ht = _create(backends[b]);
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (int i=0; i!=BENCH_KEYS; i++) ht_add_num(ht, i, keys[i]);
+        for (int r=0; r!=10; r++) {
+            for (int i=0; i!=BENCH_KEYS; i++) found += ht_find_num(ht, i) != NULL;
+        }
+        num = _elapsed(&start);
+        ht_destroy(ht);
+
+        printf("%-16s add %.2fms, find %.2fms, miss %.2fms, remove+iterate %.2fms, num %.2fms (%ld)\n", backend_names[b], add, find, miss, iter, num, found);
+    }
+
+    free(keys);
+    return 0;
+}
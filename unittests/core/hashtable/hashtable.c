@@ -1,10 +1,21 @@
 #include <CUnit/CUnit.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include "hashtable.h"
 #include "../../src/include/general/hashtable.h"
+#include "../../src/include/general/hash/chained.h"
+#include "../../src/include/general/hash/open_addressing.h"
+#include "../../src/include/general/intern.h"
 
-void test_hashtable_replace_does_not_affect_original_after_shallow_copy() {
-    t_hash_table *original = ht_create();
+static t_hashfuncs *backends[] = { &chained_hf, &open_addressing_hf, NULL };
+
+static t_hash_table *_create(t_hashfuncs *hf) {
+    return ht_create_custom(16, hf == &chained_hf ? 1.25 : 0.875, 1.75, hf);
+}
+
+static void _test_copy(t_hashfuncs *hf) {
+    t_hash_table *original = _create(hf);
     ht_add_str(original, "key", "original_value");
 
     t_hash_table *copy = ht_copy(original, 1);
@@ -23,9 +34,143 @@ void test_hashtable_replace_does_not_affect_original_after_shallow_copy() {
     ht_destroy(copy);
 }
 
+void test_hashtable_replace_does_not_affect_original_after_shallow_copy() {
+    for (int i=0; backends[i]; i++) _test_copy(backends[i]);
+}
+
+void test_hashtable_find_hashed() {
+    t_hash_table *ht = ht_create();
+    ht_add_str(ht, "hashed_key", "value");
+    ht_add_num(ht, 42, "number");
+
+    // Not interned, not \0-terminated
+    char buf[16];
+    memcpy(buf, "hashed_keyXX", 12);
+
+    size_t len;
+    hash_t hash = ht_hash_str("hashed_key", &len);
+    CU_ASSERT(len == 10);
+    CU_ASSERT(strcmp(ht_find_hashed(ht, buf, 10, hash), "value") == 0);
+    CU_ASSERT(ht_exists_hashed(ht, buf, 10, hash));
+    CU_ASSERT_PTR_NULL(ht_find_hashed(ht, buf, 11, hash));
+
+    char *interned = string_intern("hashed_key");
+    CU_ASSERT(ht_hash_str(interned, &len) == hash);
+    CU_ASSERT(strcmp(ht_find_hashed(ht, interned, len, hash), "value") == 0);
+
+    CU_ASSERT(strcmp(ht_find_num(ht, 42), "number") == 0);
+    CU_ASSERT(strcmp(ht_remove_str(ht, "hashed_key"), "value") == 0);
+    CU_ASSERT(! ht_exists_str(ht, "hashed_key"));
+
+    ht_destroy(ht);
+}
+
+static void _test_owned_keys(t_hashfuncs *hf) {
+    char key[16];
+    t_hash_table *ht = _create(hf);
+
+    // The table keeps its own copy of keys that are not interned
+    strcpy(key, "owned_key");
+    ht_add_str(ht, key, "value");
+    strcpy(key, "changed");
+    CU_ASSERT(strcmp(ht_find_str(ht, "owned_key"), "value") == 0);
+    CU_ASSERT(! ht_exists_str(ht, "changed"));
+
+    t_hash_table *copy = ht_copy(ht, 0);
+    CU_ASSERT(strcmp(ht_remove_str(ht, "owned_key"), "value") == 0);
+    CU_ASSERT(strcmp(ht_find_str(copy, "owned_key"), "value") == 0);
+
+    ht_destroy(ht);
+    ht_destroy(copy);
+}
+
+void test_hashtable_owns_keys() {
+    for (int i=0; backends[i]; i++) _test_owned_keys(backends[i]);
+}
+
+static void _test_grow_and_remove(t_hashfuncs *hf) {
+    t_hash_table *ht = _create(hf);
+
+    // Grows the table several times, and leaves removed entries behind
+    for (long i=0; i!=1000; i++) ht_add_num(ht, i, (void *)(i + 1));
+    for (long i=1; i<1000; i+=2) CU_ASSERT(ht_remove_num(ht, i) == (void *)(i + 1));
+    CU_ASSERT(ht->element_count == 500);
+
+    for (long i=0; i!=1000; i++) {
+        CU_ASSERT(ht_exists_num(ht, i) == !(i & 1));
+    }
+
+    // Removed keys can be added again
+    for (long i=1; i<1000; i+=2) ht_add_num(ht, i, (void *)(i + 2));
+    CU_ASSERT(ht->element_count == 1000);
+    for (long i=0; i!=1000; i++) {
+        CU_ASSERT(ht_find_num(ht, i) == (void *)(i + ((i & 1) ? 2 : 1)));
+    }
+
+    ht_destroy(ht);
+}
+
+void test_hashtable_grow_and_remove() {
+    for (int i=0; backends[i]; i++) _test_grow_and_remove(backends[i]);
+}
+
+/**
+ * Runs the same operations on both backends, and checks they give the same results
+ */
+void test_hashtable_backends_are_equal() {
+    char key[32];
+    t_hash_table *ht[2];
+    for (int b=0; b!=2; b++) ht[b] = _create(backends[b]);
+
+    srand(1234);
+    for (int i=0; i!=20000; i++) {
+        int n = rand() % 2000;
+        snprintf(key, 32, "key_%d", n);
+        int op = rand() % 4;
+
+        void *ret[2];
+        for (int b=0; b!=2; b++) {
+            switch (op) {
+                case 0 :
+                    ret[b] = ht_exists_str(ht[b], key) ? NULL : (void *)(long)ht_add_str(ht[b], key, (void *)(long)(n + 1));
+                    break;
+                case 1 :
+                    ret[b] = ht_remove_str(ht[b], key);
+                    break;
+                case 2 :
+                    ret[b] = ht_replace_num(ht[b], n, (void *)(long)(i + 1));
+                    break;
+                case 3 :
+                    ret[b] = ht_find_str(ht[b], key);
+                    break;
+            }
+        }
+        CU_ASSERT(ret[0] == ret[1]);
+    }
+    CU_ASSERT(ht[0]->element_count == ht[1]->element_count);
+
+    // Both keep their elements in insertion order
+    t_hash_iter iter[2];
+    ht_iter_init(&iter[0], ht[0]);
+    ht_iter_init(&iter[1], ht[1]);
+    while (ht_iter_valid(&iter[0])) {
+        CU_ASSERT(ht_iter_valid(&iter[1]));
+        CU_ASSERT(ht_key_equals(ht_iter_key(&iter[0]), ht_iter_key(&iter[1])));
+        CU_ASSERT(ht_iter_value(&iter[0]) == ht_iter_value(&iter[1]));
+        ht_iter_next(&iter[0]);
+        ht_iter_next(&iter[1]);
+    }
+    CU_ASSERT(! ht_iter_valid(&iter[1]));
+
+    for (int b=0; b!=2; b++) ht_destroy(ht[b]);
+}
 
 void test_hashtable_init() {
     CU_pSuite suite = CU_add_suite("hashtable", NULL, NULL);
     CU_add_test(suite, "hashtable_copy", test_hashtable_replace_does_not_affect_original_after_shallow_copy);
+    CU_add_test(suite, "hashtable_find_hashed", test_hashtable_find_hashed);
+    CU_add_test(suite, "hashtable_owns_keys", test_hashtable_owns_keys);
+    CU_add_test(suite, "hashtable_grow_and_remove", test_hashtable_grow_and_remove);
+    CU_add_test(suite, "hashtable_backends", test_hashtable_backends_are_equal);
 }
 
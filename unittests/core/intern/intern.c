@@ -0,0 +1,87 @@
+#include <CUnit/CUnit.h>
+#include <stdio.h>
+#include <string.h>
+#include "intern.h"
+#include "../../src/include/general/intern.h"
+#include "../../src/include/general/hashtable.h"
+#include "../../src/include/general/hash/hash_funcs.h"
+
+void test_intern_returns_same_address_for_equal_strings() {
+    char buf[16];
+    strcpy(buf, "intern_foo");
+
+    char *s1 = string_intern("intern_foo");
+    char *s2 = string_intern(buf);
+
+    CU_ASSERT(s1 == s2);
+    CU_ASSERT(s1 != buf);
+    CU_ASSERT(strcmp(s1, "intern_foo") == 0);
+    CU_ASSERT(string_intern("intern_bar") != s1);
+}
+
+void test_intern_find_does_not_intern() {
+    CU_ASSERT_PTR_NULL(string_intern_find("intern_never_added"));
+    CU_ASSERT_PTR_NULL(string_intern_find("intern_never_added"));
+
+    char *s = string_intern("intern_added");
+    CU_ASSERT(string_intern_find("intern_added") == s);
+}
+
+void test_intern_is_interned() {
+    char *s = string_intern("intern_check");
+
+    CU_ASSERT(string_is_interned(s));
+    CU_ASSERT(string_intern(s) == s);
+    CU_ASSERT(! string_is_interned("intern_check"));
+    CU_ASSERT(! string_is_interned(s + 1));
+}
+
+void test_intern_hash_and_length() {
+    char *s = string_intern("intern_hash");
+    CU_ASSERT(string_intern_hash(s) == hash_native(NULL, "intern_hash"));
+    CU_ASSERT(string_intern_strlen(s) == strlen("intern_hash"));
+
+    // Binary safe strings are \0-terminated as well
+    char *b = string_intern_len("intern\0binary", 13);
+    CU_ASSERT(string_intern_strlen(b) == 13);
+    CU_ASSERT(b[13] == '\0');
+    CU_ASSERT(b != string_intern("intern"));
+}
+
+void test_intern_survives_table_growth() {
+    char buf[32];
+    char *first = string_intern("intern_growth_0");
+
+    for (int i=0; i!=5000; i++) {
+        snprintf(buf, 32, "intern_growth_%d", i);
+        string_intern(buf);
+    }
+
+    CU_ASSERT(string_intern("intern_growth_0") == first);
+    CU_ASSERT(string_is_interned(first));
+}
+
+void test_intern_hashtable_keys() {
+    t_hash_table *ht = ht_create();
+    char buf[16];
+    strcpy(buf, "intern_key");
+
+    ht_add_str(ht, "intern_key", "value");
+    CU_ASSERT(strcmp(ht_find_str(ht, buf), "value") == 0);
+    CU_ASSERT(ht_exists_str(ht, string_intern("intern_key")));
+    CU_ASSERT_PTR_NULL(ht_find_str(ht, "intern_missing_key"));
+    CU_ASSERT_PTR_NULL(string_intern_find("intern_missing_key"));
+
+    ht_destroy(ht);
+}
+
+
+void test_intern_init() {
+    CU_pSuite suite = CU_add_suite("intern", NULL, NULL);
+    CU_add_test(suite, "intern_same_address", test_intern_returns_same_address_for_equal_strings);
+    CU_add_test(suite, "intern_find", test_intern_find_does_not_intern);
+    CU_add_test(suite, "intern_is_interned", test_intern_is_interned);
+    CU_add_test(suite, "intern_hash_and_length", test_intern_hash_and_length);
+    CU_add_test(suite, "intern_growth", test_intern_survives_table_growth);
+    CU_add_test(suite, "intern_hashtable_keys", test_intern_hashtable_keys);
+}
@@ -0,0 +1,6 @@
+#ifndef __TEST_INTERN_H
+#define __TEST_INTERN_H
+
+void test_intern_init();
+
+#endif
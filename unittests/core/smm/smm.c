@@ -0,0 +1,104 @@
+#include <string.h>
+#include <stdint.h>
+#include <CUnit/CUnit.h>
+#include "smm.h"
+#include "../../src/include/general/smm.h"
+
+
+static void test_smm_zalloc_clears_memory() {
+    unsigned char *p = smm_zalloc(100);
+
+    CU_ASSERT_PTR_NOT_NULL(p);
+    for (int i = 0; i != 100; i++) {
+        CU_ASSERT_EQUAL(p[i], 0);
+    }
+
+    smm_free(p);
+}
+
+static void test_smm_realloc_keeps_contents() {
+    // Grows through several size classes, and past the largest one
+    char *p = smm_malloc(10);
+    strcpy(p, "saffire");
+
+    for (int size = 20; size < 2000; size *= 2) {
+        p = smm_realloc(p, size);
+        CU_ASSERT_STRING_EQUAL(p, "saffire");
+    }
+
+    p = smm_realloc(p, 8);
+    CU_ASSERT_STRING_EQUAL(p, "saffire");
+
+    smm_free(p);
+}
+
+static void test_smm_free_reuses_blocks() {
+    void *ptrs[1000];
+
+    for (int i = 0; i != 1000; i++) {
+        ptrs[i] = smm_malloc(i % 300);
+        memset(ptrs[i], i & 0xFF, i % 300);
+    }
+
+    // Free half, and allocate them again so they overlap with the blocks still in use if something is wrong
+    for (int i = 0; i < 1000; i += 2) {
+        smm_free(ptrs[i]);
+    }
+    for (int i = 0; i < 1000; i += 2) {
+        ptrs[i] = smm_malloc(i % 300);
+        memset(ptrs[i], 0, i % 300);
+    }
+
+    int ok = 1;
+    for (int i = 1; i < 1000; i += 2) {
+        for (int j = 0; j != i % 300; j++) {
+            if (((unsigned char *)ptrs[i])[j] != (i & 0xFF)) ok = 0;
+        }
+    }
+    CU_ASSERT_TRUE(ok);
+
+    for (int i = 0; i != 1000; i++) {
+        smm_free(ptrs[i]);
+    }
+}
+
+static void test_smm_aligns_blocks() {
+    // Same 16 byte alignment as malloc(), for small, large and reallocated blocks
+    void *ptrs[600];
+    int aligned = 1;
+
+    for (int i = 0; i != 600; i++) {
+        ptrs[i] = smm_malloc(i + 1);
+        if ((uintptr_t)ptrs[i] & 15) aligned = 0;
+    }
+    for (int i = 0; i < 600; i += 3) {
+        ptrs[i] = smm_realloc(ptrs[i], (i * 7) % 700 + 1);
+        if ((uintptr_t)ptrs[i] & 15) aligned = 0;
+    }
+    CU_ASSERT_TRUE(aligned);
+
+    for (int i = 0; i != 600; i++) {
+        smm_free(ptrs[i]);
+    }
+}
+
+static void test_smm_frees_system_memory() {
+    // Memory returned by libc (strdup, realpath etc) can be handed to smm_free as well
+    char *p = strdup("saffire");
+    p = smm_realloc(p, 100);
+    CU_ASSERT_STRING_EQUAL(p, "saffire");
+    smm_free(p);
+
+    smm_free(NULL);
+}
+
+
+void test_smm_init() {
+     CU_pSuite suite = CU_add_suite("smm", NULL, NULL);
+
+     CU_add_test(suite, "smm_zalloc clears memory", test_smm_zalloc_clears_memory);
+     CU_add_test(suite, "smm_realloc keeps contents", test_smm_realloc_keeps_contents);
+     CU_add_test(suite, "smm_free reuses blocks", test_smm_free_reuses_blocks);
+     CU_add_test(suite, "smm_malloc aligns blocks to 16 bytes", test_smm_aligns_blocks);
+     CU_add_test(suite, "smm_free frees system memory", test_smm_frees_system_memory);
+}
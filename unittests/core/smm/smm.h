@@ -0,0 +1,6 @@
+#ifndef __TEST_SMM_H
+#define __TEST_SMM_H
+
+void test_smm_init();
+
+#endif
@@ -0,0 +1,218 @@
+#include <CUnit/CUnit.h>
+#include "string.h"
+#include "../../src/include/general/string.h"
+
+
+static void test_string_scan_flags() {
+    CU_ASSERT_EQUAL(string_scan_flags("", 0), STRING_FLAG_ASCII | STRING_FLAG_UTF8);
+    CU_ASSERT_EQUAL(string_scan_flags("hello world, this is longer than 16 bytes", 41), STRING_FLAG_ASCII | STRING_FLAG_UTF8);
+
+    // Non-ASCII characters before, on and after a 16 byte boundary
+    CU_ASSERT_EQUAL(string_scan_flags("caf\xc3\xa9", 5), STRING_FLAG_UTF8);
+    CU_ASSERT_EQUAL(string_scan_flags("0123456789abcde\xc3\xa9", 17), STRING_FLAG_UTF8);
+    CU_ASSERT_EQUAL(string_scan_flags("0123456789abcdef0123\xe2\x82\xac", 23), STRING_FLAG_UTF8);
+    CU_ASSERT_EQUAL(string_scan_flags("\xf0\x9f\x98\x80", 4), STRING_FLAG_UTF8);
+
+    // Malformed UTF-8: truncated, overlong, surrogate, stray continuation byte and beyond U+10FFFF
+    CU_ASSERT_EQUAL(string_scan_flags("caf\xc3", 4), 0);
+    CU_ASSERT_EQUAL(string_scan_flags("\xc0\xaf", 2), 0);
+    CU_ASSERT_EQUAL(string_scan_flags("\xed\xa0\x80", 3), 0);
+    CU_ASSERT_EQUAL(string_scan_flags("a\x80z", 3), 0);
+    CU_ASSERT_EQUAL(string_scan_flags("\xf4\x90\x80\x80", 4), 0);
+}
+
+static void test_string_flags_follow_operations() {
+    t_string *ascii = char0_to_string("abc");
+    t_string *utf8 = char0_to_string("\xc3\xa9t\xc3\xa9");
+    t_string *half = char_to_string("\xc3", 1);
+
+    CU_ASSERT_TRUE(STRING_IS_ASCII(ascii));
+    CU_ASSERT_FALSE(STRING_IS_ASCII(utf8));
+    CU_ASSERT_TRUE(STRING_IS_UTF8(utf8));
+    CU_ASSERT_FALSE(STRING_IS_UTF8(half));
+
+    t_string *copy = string_strdup(utf8);
+    CU_ASSERT_EQUAL(copy->flags, utf8->flags);
+
+    // Copying only the ASCII part of a string
+    t_string *part = string_copy_partial(utf8, 2, 1);
+    CU_ASSERT_TRUE(STRING_IS_ASCII(part));
+
+    // Splitting a multibyte character
+    t_string *split = string_copy_partial(utf8, 0, 1);
+    CU_ASSERT_FALSE(STRING_IS_UTF8(split));
+
+    string_strcat(ascii, utf8);
+    CU_ASSERT_FALSE(STRING_IS_ASCII(ascii));
+    CU_ASSERT_TRUE(STRING_IS_UTF8(ascii));
+
+    // Joining two halves of a multibyte character makes the string valid
+    t_string *joined = char_to_string("\xc3", 1);
+    t_string *tail = char_to_string("\xa9", 1);
+    string_strcat(joined, tail);
+    CU_ASSERT_TRUE(STRING_IS_UTF8(joined));
+
+    string_free(ascii);
+    string_free(utf8);
+    string_free(half);
+    string_free(copy);
+    string_free(part);
+    string_free(split);
+    string_free(joined);
+    string_free(tail);
+}
+
+static void test_string_join() {
+    t_string *sep = char0_to_string(", ");
+    t_string *parts[3] = { char0_to_string("foo"), char0_to_string("b\xc3\xa4r"), char0_to_string("") };
+
+    t_string *joined = string_join(sep, parts, 3);
+    CU_ASSERT_EQUAL(joined->len, 11);
+    CU_ASSERT_STRING_EQUAL(joined->val, "foo, b\xc3\xa4r, ");
+    CU_ASSERT_FALSE(STRING_IS_ASCII(joined));
+    CU_ASSERT_TRUE(STRING_IS_UTF8(joined));
+
+    t_string *single = string_join(sep, parts, 1);
+    CU_ASSERT_STRING_EQUAL(single->val, "foo");
+    CU_ASSERT_TRUE(STRING_IS_ASCII(single));
+
+    t_string *empty = string_join(sep, parts, 0);
+    CU_ASSERT_EQUAL(empty->len, 0);
+    CU_ASSERT_STRING_EQUAL(empty->val, "");
+
+    // Joining two halves of a multibyte character without a separator makes the string valid
+    t_string *halves[2] = { char_to_string("\xc3", 1), char_to_string("\xa9", 1) };
+    t_string *cat = string_join(NULL, halves, 2);
+    CU_ASSERT_EQUAL(cat->len, 2);
+    CU_ASSERT_TRUE(STRING_IS_UTF8(cat));
+
+    for (int i=0; i!=3; i++) string_free(parts[i]);
+    string_free(halves[0]);
+    string_free(halves[1]);
+    string_free(sep);
+    string_free(joined);
+    string_free(single);
+    string_free(empty);
+    string_free(cat);
+}
+
+static void test_string_strcmp() {
+    t_string *s1 = char0_to_string("abc");
+    t_string *s2 = char0_to_string("abd");
+    t_string *s3 = char0_to_string("ab");
+    t_string *s4 = char0_to_string("abc");
+
+    CU_ASSERT_EQUAL(string_strcmp(s1, s4), 0);
+    CU_ASSERT_TRUE(string_strcmp(s1, s2) < 0);
+    CU_ASSERT_TRUE(string_strcmp(s2, s1) > 0);
+    CU_ASSERT_TRUE(string_strcmp(s1, s3) > 0);
+    CU_ASSERT_TRUE(string_strcmp(s3, s1) < 0);
+    CU_ASSERT_EQUAL(string_strcmp0(s1, "abc"), 0);
+    CU_ASSERT_NOT_EQUAL(string_strcmp0(s1, "a"), 0);
+
+    string_free(s1);
+    string_free(s2);
+    string_free(s3);
+    string_free(s4);
+}
+
+static void test_string_utf8_strcmp() {
+    t_string *s1 = char0_to_string("caf\xc3\xa9");
+    t_string *s2 = char0_to_string("caf\xc3\xa9");
+    t_string *s3 = char0_to_string("cafe");
+    t_string *s4 = char0_to_string("\xef\xbf\xbd");         // U+FFFD
+    t_string *s5 = char0_to_string("\xf0\x9f\x98\x80");     // U+1F600
+
+    CU_ASSERT_EQUAL(utf8_strcmp(s1, s2), 0);
+    CU_ASSERT_TRUE(utf8_strcmp(s1, s3) > 0);
+    CU_ASSERT_TRUE(utf8_strcmp(s3, s1) < 0);
+
+    // Compared in code point order
+    CU_ASSERT_TRUE(utf8_strcmp(s4, s5) < 0);
+
+    // Malformed strings are compared through unicode
+    t_string *s6 = char_to_string("a\x80", 2);
+    t_string *s7 = char_to_string("a\x80", 2);
+    CU_ASSERT_EQUAL(utf8_strcmp(s6, s7), 0);
+    string_free(s6);
+    string_free(s7);
+
+    string_free(s1);
+    string_free(s2);
+    string_free(s3);
+    string_free(s4);
+    string_free(s5);
+}
+
+static void test_string_utf8_strstr() {
+    t_string *haystack = char0_to_string("the caf\xc3\xa9 is on the corner of the street");
+    t_string *needle1 = char0_to_string("caf\xc3\xa9");
+    t_string *needle2 = char0_to_string("street");
+    t_string *needle3 = char0_to_string("streets");
+    t_string *needle4 = char0_to_string("");
+    t_string *needle5 = char0_to_string("thx");
+
+    CU_ASSERT_TRUE(utf8_strstr(haystack, needle1));
+    CU_ASSERT_TRUE(utf8_strstr(haystack, needle2));
+    CU_ASSERT_FALSE(utf8_strstr(haystack, needle3));
+    CU_ASSERT_TRUE(utf8_strstr(haystack, needle4));
+    CU_ASSERT_FALSE(utf8_strstr(haystack, needle5));
+    CU_ASSERT_FALSE(utf8_strstr(needle5, haystack));
+
+    string_free(haystack);
+    string_free(needle1);
+    string_free(needle2);
+    string_free(needle3);
+    string_free(needle4);
+    string_free(needle5);
+}
+
+static void test_string_utf8_locale() {
+    t_locale *l1 = utf8_locale("nl_NL");
+    t_locale *l2 = utf8_locale("nl_NL");
+    t_locale *l3 = utf8_locale("tr_TR");
+
+    CU_ASSERT_PTR_NOT_NULL(l1);
+    CU_ASSERT_PTR_EQUAL(l1, l2);
+    CU_ASSERT_NOT_EQUAL(l1, l3);
+    CU_ASSERT_STRING_EQUAL(utf8_locale_name(l1), "nl_NL");
+    CU_ASSERT_PTR_NULL(utf8_locale(NULL));
+    CU_ASSERT_PTR_NULL(utf8_locale_name(NULL));
+
+    // The case mapping is created once per locale
+    CU_ASSERT_PTR_NOT_NULL(utf8_locale_casemap(l1));
+    CU_ASSERT_PTR_EQUAL(utf8_locale_casemap(l1), utf8_locale_casemap(l2));
+}
+
+static void test_string_utf8_change_case() {
+    t_string *src = char0_to_string("Stra\xc3\x9f" "e caf\xc3\xa9 i");
+
+    t_string *upper = utf8_toupper(src, utf8_locale("nl_NL"));
+    CU_ASSERT_STRING_EQUAL(upper->val, "STRASSE CAF\xc3\x89 I");
+    CU_ASSERT_EQUAL(upper->len, 15);
+
+    t_string *lower = utf8_tolower(upper, NULL);
+    CU_ASSERT_STRING_EQUAL(lower->val, "strasse caf\xc3\xa9 i");
+
+    // Turkish has a dotted capital i
+    t_string *turkish = utf8_toupper(src, utf8_locale("tr_TR"));
+    CU_ASSERT_STRING_EQUAL(turkish->val, "STRASSE CAF\xc3\x89 \xc4\xb0");
+
+    string_free(src);
+    string_free(upper);
+    string_free(lower);
+    string_free(turkish);
+}
+
+void test_string_init() {
+     CU_pSuite suite = CU_add_suite("string", NULL, NULL);
+
+     CU_add_test(suite, "string_scan_flags detects ASCII and UTF-8", test_string_scan_flags);
+     CU_add_test(suite, "string flags follow string operations", test_string_flags_follow_operations);
+     CU_add_test(suite, "string_join allocates the result once", test_string_join);
+     CU_add_test(suite, "string_strcmp compares bytes", test_string_strcmp);
+     CU_add_test(suite, "utf8_strcmp compares in code point order", test_string_utf8_strcmp);
+     CU_add_test(suite, "utf8_strstr finds substrings", test_string_utf8_strstr);
+     CU_add_test(suite, "utf8_locale returns shared handles", test_string_utf8_locale);
+     CU_add_test(suite, "utf8_toupper and utf8_tolower use the locale", test_string_utf8_change_case);
+}
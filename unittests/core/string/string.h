@@ -0,0 +1,6 @@
+#ifndef __TEST_STRING_H
+#define __TEST_STRING_H
+
+void test_string_init();
+
+#endif
@@ -4,7 +4,11 @@
 #include "hashtable/hashtable.h"
 #include "ini/ini.h"
 #include "dll/dll.h"
+#include "vector/vector.h"
+#include "string/string.h"
 #include "bz2/bz2.h"
+#include "smm/smm.h"
+#include "intern/intern.h"
 
 int main(int argc, char *argv[]) {
 
@@ -12,8 +16,12 @@ int main(int argc, char *argv[]) {
 
     test_hashtable_init();
     test_dll_init();
+    test_vector_init();
+    test_string_init();
     test_bz2_init();
     test_ini_init();
+    test_smm_init();
+    test_intern_init();
 
     CU_basic_set_mode(CU_BRM_VERBOSE);
     CU_basic_run_tests();
@@ -0,0 +1,109 @@
+#include <CUnit/CUnit.h>
+#include "vector.h"
+#include "../../src/include/general/vector.h"
+
+
+static void test_vector_vector_init() {
+    t_vector *v = vector_init();
+
+    CU_ASSERT_PTR_NOT_NULL(v);
+    CU_ASSERT_EQUAL(VECTOR_SIZE(v), 0);
+    CU_ASSERT_PTR_NULL(vector_get(v, 0));
+
+    vector_free(v);
+}
+
+static void test_vector_vector_init_size() {
+    t_vector *v = vector_init_size(5);
+
+    CU_ASSERT_EQUAL(VECTOR_SIZE(v), 5);
+    for (int i=0; i!=5; i++) {
+        CU_ASSERT_PTR_NULL(vector_get(v, i));
+    }
+    CU_ASSERT_PTR_NULL(vector_get(v, 5));
+
+    vector_free(v);
+}
+
+static void test_vector_vector_append_grows() {
+    t_vector *v = vector_init();
+    long values[1000];
+
+    for (int i=0; i!=1000; i++) {
+        values[i] = i;
+        vector_append(v, &values[i]);
+    }
+
+    CU_ASSERT_EQUAL(VECTOR_SIZE(v), 1000);
+    CU_ASSERT(v->capacity >= 1000);
+    for (int i=0; i!=1000; i++) {
+        CU_ASSERT_PTR_EQUAL(vector_get(v, i), &values[i]);
+    }
+    CU_ASSERT_PTR_NULL(vector_get(v, -1));
+    CU_ASSERT_PTR_NULL(vector_get(v, 1000));
+
+    vector_free(v);
+}
+
+static void test_vector_vector_append_all() {
+    t_vector *v = vector_init();
+    char *data[] = { "test1", "test2", "test3" };
+
+    vector_append(v, "test0");
+    vector_append_all(v, (void **)data, 3);
+    vector_append_all(v, (void **)data, 0);
+
+    CU_ASSERT_EQUAL(VECTOR_SIZE(v), 4);
+    CU_ASSERT_STRING_EQUAL(vector_get(v, 0), "test0");
+    CU_ASSERT_STRING_EQUAL(vector_get(v, 1), "test1");
+    CU_ASSERT_STRING_EQUAL(vector_get(v, 3), "test3");
+
+    vector_free(v);
+}
+
+static void test_vector_vector_set_and_swap() {
+    t_vector *v = vector_init();
+
+    vector_append(v, "test1");
+    vector_append(v, "test2");
+
+    char *old = vector_set(v, 1, "test3");
+    CU_ASSERT_STRING_EQUAL(old, "test2");
+    CU_ASSERT_STRING_EQUAL(vector_get(v, 1), "test3");
+    CU_ASSERT_PTR_NULL(vector_set(v, 2, "test4"));
+    CU_ASSERT_EQUAL(VECTOR_SIZE(v), 2);
+
+    vector_swap(v, 0, 1);
+    CU_ASSERT_STRING_EQUAL(vector_get(v, 0), "test3");
+    CU_ASSERT_STRING_EQUAL(vector_get(v, 1), "test1");
+
+    vector_free(v);
+}
+
+static void test_vector_vector_copy() {
+    t_vector *v = vector_init();
+
+    vector_append(v, "test1");
+    vector_append(v, "test2");
+
+    t_vector *copy = vector_copy(v);
+    vector_set(v, 0, "changed");
+
+    CU_ASSERT_EQUAL(VECTOR_SIZE(copy), 2);
+    CU_ASSERT_STRING_EQUAL(vector_get(copy, 0), "test1");
+    CU_ASSERT_STRING_EQUAL(vector_get(copy, 1), "test2");
+
+    vector_free(copy);
+    vector_free(v);
+}
+
+void test_vector_init() {
+     CU_pSuite suite = CU_add_suite("vector", NULL, NULL);
+
+     CU_add_test(suite, "vector_init creates empty vector", test_vector_vector_init);
+     CU_add_test(suite, "vector_init_size creates NULL elements", test_vector_vector_init_size);
+     CU_add_test(suite, "vector_append grows vector", test_vector_vector_append_grows);
+     CU_add_test(suite, "vector_append_all appends elements", test_vector_vector_append_all);
+     CU_add_test(suite, "vector_set and vector_swap replace elements", test_vector_vector_set_and_swap);
+     CU_add_test(suite, "vector_copy copies elements", test_vector_vector_copy);
+}
@@ -0,0 +1,6 @@
+#ifndef __TEST_VECTOR_H
+#define __TEST_VECTOR_H
+
+void test_vector_init();
+
+#endif